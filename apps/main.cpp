@@ -10,18 +10,23 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <iterator>
 #include <memory>
 #include <boost/filesystem.hpp>
 #include <iridium/calendar.hpp>
 #include "../strategy/include/simulate.hpp"
 #include <iridium/account.hpp>
 #include <iridium/csv.hpp>
+#include <iridium/prefetch.hpp>
 
 int main() {
   using iridium::SimulationAccount;
   using iridium::instrument_list;
   using iridium::data::data_freq_list;
   using iridium::data::TradeData;
+  using iridium::data::TradeDataOptions;
+  using iridium::data::WindowPrefetcher;
   using iridium::data::StringToDataFreq;
 
   // settings
@@ -64,7 +69,17 @@ int main() {
 //    "USD_CAD", "USD_JPY", "USD_SGD"});
   auto instruments = instrument_list({"EUR_USD"});
   auto freqs = data_freq_list({kShortTermTimeFrame, kIntermediateTermTimeFrame, kLongTermTimeFrame, kSimulateTickTimeFrame});
-  auto hdf5data = std::make_unique<TradeData>(hdf5_file_path.string(), *instruments, *freqs);
+  TradeDataOptions data_options;
+  data_options.load_mode = iridium::data::LoadMode::kInMemory;
+  data_options.resample_region = kRegion;
+  // only the backtest period and the history windows leading into it are loaded
+  auto long_term_ticks = iridium::calendar::all_ticks_ptr(
+      kBeginYear, kBeginMonth, kBeginDay, kEndYear, kEndMonth, kEndDay, kRegion, StringToDataFreq(kLongTermTimeFrame));
+  data_options.range = iridium::data::TimeRange{
+      long_term_ticks->front(), long_term_ticks->back() + StringToDataFreq(kLongTermTimeFrame)};
+  data_options.warm_up_bars = kHistDataCount;
+  auto hdf5data = std::make_unique<TradeData>(hdf5_file_path.string(), *instruments, *freqs, data_options);
+  auto snapshot = hdf5data->market_snapshot();
 
   // clock
   iridium::calendar::Clock clock(
@@ -76,50 +91,82 @@ int main() {
       kEndDay,
       kRegion,
       StringToDataFreq(kLongTermTimeFrame));
+
+  // ticks without a bar for every instrument, e.g. weekends, are skipped with a bit test
+  auto has_bars = [&](std::time_t tick, const std::string &freq) {
+    return std::all_of(instruments->begin(), instruments->end(), [&](const auto &instrument) {
+      return hdf5data->has_bar(instrument->name(), tick, StringToDataFreq(freq));
+    });
+  };
+
+  // history windows read ahead on background threads
+  auto schedule = [&](const std::string &freq) {
+    auto ticks = iridium::calendar::all_ticks_ptr(
+        kBeginYear, kBeginMonth, kBeginDay, kEndYear, kEndMonth, kEndDay, kRegion, StringToDataFreq(freq));
+    std::vector<std::time_t> schedule;
+    std::copy_if(ticks->begin(), ticks->end(), std::back_inserter(schedule), [&](auto tick) {
+      return has_bars(tick, freq);
+    });
+    return schedule;
+  };
+  WindowPrefetcher long_prefetcher(
+      *hdf5data, *instruments, schedule(kLongTermTimeFrame), kHistDataCount, StringToDataFreq(kLongTermTimeFrame));
+  WindowPrefetcher intermediate_prefetcher(
+      *hdf5data, *instruments, schedule(kIntermediateTermTimeFrame), kHistDataCount,
+      StringToDataFreq(kIntermediateTermTimeFrame));
+  WindowPrefetcher short_prefetcher(
+      *hdf5data, *instruments, schedule(kShortTermTimeFrame), kHistDataCount, StringToDataFreq(kShortTermTimeFrame));
+
   for (auto it = clock.begin(); it != clock.end(); ++it) {
+    if (!has_bars(*it, kLongTermTimeFrame)) {
+      continue;
+    }
     try {
       // long term history data
-      auto long_hist_data_map = hdf5data->history_data(
-          *instruments, *it, kHistDataCount, StringToDataFreq(kLongTermTimeFrame));
+      auto long_hist_windows = long_prefetcher.windows(*it);
       for (int i = 0; i < StringToDataFreq(kLongTermTimeFrame) / StringToDataFreq(kIntermediateTermTimeFrame); ++i) {
         // intermediate term history data
         auto intermediate_tick = *it + i * StringToDataFreq(kIntermediateTermTimeFrame);
-        auto intermediate_hist_data_map = hdf5data->history_data(
-            *instruments, intermediate_tick, kHistDataCount, StringToDataFreq(kIntermediateTermTimeFrame));
+        if (!has_bars(intermediate_tick, kIntermediateTermTimeFrame)) {
+          continue;
+        }
+        auto intermediate_hist_windows = intermediate_prefetcher.windows(intermediate_tick);
         for (int j = 0; j < StringToDataFreq(kIntermediateTermTimeFrame) / StringToDataFreq(kShortTermTimeFrame); ++j) {
           // short term history data
           auto short_tick = intermediate_tick + j * StringToDataFreq(kShortTermTimeFrame);
-          auto short_hist_data_map = hdf5data->history_data(
-              *instruments, short_tick, kHistDataCount, StringToDataFreq(kShortTermTimeFrame));
+          if (!has_bars(short_tick, kShortTermTimeFrame)) {
+            continue;
+          }
+          auto short_hist_windows = short_prefetcher.windows(short_tick);
           for (int k = 0; k < StringToDataFreq(kShortTermTimeFrame) / StringToDataFreq(kSimulateTickTimeFrame); ++k) {
             // simulate term data
             auto simulate_tick = short_tick + k * StringToDataFreq(kSimulateTickTimeFrame);
-            auto simulate_data_map = hdf5data->candlestick_data(*instruments, simulate_tick, StringToDataFreq(kSimulateTickTimeFrame));
-            for (auto const &[name, data] : *simulate_data_map) {
-              if (data) {
+            hdf5data->FillSnapshot(simulate_tick, StringToDataFreq(kSimulateTickTimeFrame), snapshot);
+            for (std::size_t n = 0; n < instruments->size(); ++n) {
+              const auto &name = instruments->at(n)->name();
+              if (snapshot.has_data(static_cast<int>(n))) {
                 // instrument history data
-                auto long_term_hist_data_ptr = long_hist_data_map->at(name);
-                auto intermediate_term_hist_data_ptr = intermediate_hist_data_map->at(name);
-                auto short_term_hist_data_ptr = short_hist_data_map->at(name);
                 SimulateTrade(
                     name,
+                    static_cast<int>(n),
                     simulate_tick,
-                    *long_term_hist_data_ptr,
-                    *intermediate_term_hist_data_ptr,
-                    *short_term_hist_data_ptr,
-                    *simulate_data_map,
+                    long_hist_windows.at(n),
+                    intermediate_hist_windows.at(n),
+                    short_hist_windows.at(n),
+                    snapshot,
                     account_ptr,
                     kSpread);
               } else {
                 continue;
               }
             }
-            account_ptr->ProcessOrders(simulate_tick, *simulate_data_map);
-            iridium::logger()->info(account_ptr->summary(simulate_tick, *simulate_data_map));
+            account_ptr->ProcessOrders(simulate_tick, snapshot);
+            iridium::logger()->info(account_ptr->summary(simulate_tick, snapshot));
           }
         }
       }
     } catch (const std::out_of_range& e) {
+      // fewer candlesticks than a window before the tick, only at the start of the data
       iridium::logger()->error(e.what());
       continue;
     }
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include <string>
 #include <memory>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <algorithm>
 #include <cmath>
@@ -49,11 +51,11 @@ class Account {
 
   [[nodiscard]]
   virtual std::optional<double>
-  net_asset_value(const data::TickDataMap &tick_data_map) const = 0;
+  net_asset_value(const data::MarketSnapshot &snapshot) const = 0;
 
   [[nodiscard]]
   virtual std::optional<double>
-  margin_used(const data::TickDataMap &tick_data_map) const = 0;
+  margin_used(const data::MarketSnapshot &snapshot) const = 0;
 
   virtual void CreateLimitOrder(
       std::time_t create_time,
@@ -65,11 +67,15 @@ class Account {
       std::optional<double> trailing_stop_loss_distance = std::nullopt) = 0;
 
 
+  /*
+   * order at the quoted ask (buy) or bid (sell) close of the snapshot, price widened by the spread if it has no quote
+   */
   virtual void CreateMarketOrder(
       std::time_t create_time,
       const std::string &instrument,
       int units,
       double price,
+      const data::MarketSnapshot &snapshot,
       std::optional<double> take_profit_price = std::nullopt,
       std::optional<double> stop_loss_price = std::nullopt,
       std::optional<double> trailing_stop_loss_distance = std::nullopt) = 0;
@@ -78,7 +84,8 @@ class Account {
       const std::string &instrument,
       double acc_quote_rate,
       double current_price,
-      std::time_t time) = 0;
+      std::time_t time,
+      const data::MarketSnapshot &snapshot) = 0;
 
   virtual void UpdateTradeStopLossPrice(
       const std::shared_ptr<Trade> &trade_ptr,
@@ -126,11 +133,11 @@ class SimulationAccount: public Account {
 
   [[nodiscard]]
   std::optional<double>
-  net_asset_value(const data::TickDataMap &tick_data_map) const override;
+  net_asset_value(const data::MarketSnapshot &snapshot) const override;
 
   [[nodiscard]]
   std::optional<double>
-  margin_used(const data::TickDataMap &tick_data_map) const override;
+  margin_used(const data::MarketSnapshot &snapshot) const override;
 
   void CreateLimitOrder(
       std::time_t create_time,
@@ -146,6 +153,7 @@ class SimulationAccount: public Account {
       const std::string &instrument,
       int units,
       double price,
+      const data::MarketSnapshot &snapshot,
       std::optional<double> take_profit_price = std::nullopt,
       std::optional<double> stop_loss_price = std::nullopt,
       std::optional<double> trailing_stop_loss_distance = std::nullopt) override;
@@ -154,7 +162,8 @@ class SimulationAccount: public Account {
       const std::string &instrument,
       double acc_quote_rate,
       double current_price,
-      std::time_t time) override;
+      std::time_t time,
+      const data::MarketSnapshot &snapshot) override;
 
   void UpdateTradeStopLossPrice(
       const std::shared_ptr<Trade> &trade_ptr,
@@ -192,11 +201,11 @@ class SimulationAccount: public Account {
   std::string string();
 
   std::string summary(std::time_t tick,
-                      const iridium::data::TickDataMap &data_map) const;
+                      const iridium::data::MarketSnapshot &snapshot) const;
 
   void ProcessOrders(
       std::time_t time,
-      const data::TickDataMap &tick_data_map);
+      const data::MarketSnapshot &snapshot);
 
   friend std::ostream &operator<<(std::ostream &os, const SimulationAccount &account);
 
@@ -206,6 +215,8 @@ class SimulationAccount: public Account {
   double capital_base_;
   double balance_;
   double spread_;
+  std::unordered_map<std::string, double> half_spreads_;
+  data::Pipettes spread_pipettes_;
   std::shared_ptr<TradeList> trades_ptr_;
   std::shared_ptr<OrderList> orders_ptr_;
   std::shared_ptr<spdlog::logger> logger_;
@@ -223,36 +234,82 @@ class SimulationAccount: public Account {
   acc_trade_ptr(const TriggerOrder &order) const;
 
   /*
-   * return instrument name, ask low, ask high, bid low, bid high, account vs quote, account vs base, current price
+   * snapshot id of the instrument of the trade or order, looked up by name the first time and kept on it,
+   * every snapshot of the account is built from the same instrument list
+   */
+  template<typename T>
+  static int instrument_id(T &trade_or_order, const data::MarketSnapshot &snapshot) {
+    auto id = trade_or_order.instrument_id();
+    if (!id.has_value()) {
+      id = snapshot.instrument_id(trade_or_order.instrument_ptr()->name());
+      trade_or_order.set_instrument_id(*id);
+    }
+    return *id;
+  }
+
+  /*
+   * half of the constant spread in price, used when a snapshot has no quote of the instrument
+   */
+  double half_spread(const std::string &instrument);
+
+  /*
+   * return bid and ask to fill at, the quote closes of the instrument if the snapshot has a quote,
+   * otherwise price widened by the constant spread
+   */
+  std::pair<double, double> fill_prices(
+      const std::string &instrument,
+      int id,
+      double price,
+      const data::MarketSnapshot &snapshot);
+
+  /*
+   * return instrument name, ask low, ask high, bid low, bid high, account vs quote, account vs base, current price.
+   * Ask and bid ranges come from the snapshot quote of the instrument if any, otherwise from the constant spread.
   */
   std::optional<std::tuple<std::string, double, double, double, double, double, double, double>>
-  instrument_market_info(const Instrument &instrument, const data::TickDataMap &tick_data_map);
+  instrument_market_info(const Instrument &instrument, int id, const data::MarketSnapshot &snapshot);
 
+  /*
+   * return true if price lies within the bid range (on_bid) or the ask range of the instrument at the
+   * snapshot, compared in whole pipettes. Only valid for fixed point snapshots with data of the instrument.
+   */
+  bool PipetteRangeTouched(
+      int id,
+      double price,
+      bool on_bid,
+      const data::MarketSnapshot &snapshot) const;
+
+  /*
+   * close at bid if the trade is long, at ask if short
+   */
   void PartiallyCloseTrade(
       const std::shared_ptr<Trade> &trade_ptr,
       double acc_quote_rate,
-      double current_price,
+      double bid,
+      double ask,
       int units);
 
   void CloseTrade(
       const std::shared_ptr<Trade> &trade_ptr,
       double acc_quote_rate,
-      double current_price,
+      double bid,
+      double ask,
       std::time_t time);
 
   void ProcessLimitOrder(
       const std::shared_ptr<LimitOrder> &order_ptr,
       std::time_t time,
-      const data::TickDataMap &tick_data_map);
+      const data::MarketSnapshot &snapshot);
 
   void ProcessTriggerOrder(
       const std::shared_ptr<TriggerOrder> &order_ptr,
       std::time_t time,
-      const data::TickDataMap &tick_data_map);
+      const data::MarketSnapshot &snapshot);
 
   void ProcessPriceTriggerOrder(
       const std::shared_ptr<PriceTriggerOrder> &order_ptr,
       const std::shared_ptr<Trade> &trade_ptr,
+      const data::MarketSnapshot &snapshot,
       double ask_low,
       double ask_high,
       double bid_low,
@@ -263,6 +320,7 @@ class SimulationAccount: public Account {
   void ProcessTrailingStopLossOrder(
       const std::shared_ptr<TrailingStopLossOrder> &order_ptr,
       const std::shared_ptr<Trade> &trade_ptr,
+      const data::MarketSnapshot &snapshot,
       double ask_low,
       double ask_high,
       double bid_low,
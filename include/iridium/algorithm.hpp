@@ -20,6 +20,60 @@ limitations under the License.
 
 namespace iridium {
 namespace algorithm {
+/*
+ * Non-owning read-only view over a contiguous array
+ */
+template<typename T>
+class ColumnView {
+ public:
+  ColumnView() = default;
+
+  ColumnView(const T *data, std::size_t size) : data_(data), size_(size) {}
+
+  ColumnView(const std::vector<T> &v) : data_(v.data()), size_(v.size()) {}
+
+  [[nodiscard]]
+  const T *data() const noexcept { return data_; }
+
+  [[nodiscard]]
+  std::size_t size() const noexcept { return size_; }
+
+  [[nodiscard]]
+  bool empty() const noexcept { return size_ == 0; }
+
+  [[nodiscard]]
+  const T *begin() const noexcept { return data_; }
+
+  [[nodiscard]]
+  const T *end() const noexcept { return data_ + size_; }
+
+  const T &operator[](std::size_t i) const { return data_[i]; }
+
+  [[nodiscard]]
+  const T &at(std::size_t i) const {
+    if (i >= size_) throw std::out_of_range("Out of range");
+    return data_[i];
+  }
+
+  [[nodiscard]]
+  const T &front() const { return data_[0]; }
+
+  [[nodiscard]]
+  const T &back() const { return data_[size_ - 1]; }
+
+  [[nodiscard]]
+  ColumnView<T> sub_view(std::size_t first, std::size_t count) const {
+    return ColumnView<T>(data_ + first, count);
+  }
+
+  [[nodiscard]]
+  std::vector<T> to_vector() const { return std::vector<T>(begin(), end()); }
+
+ private:
+  const T *data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
 template<class Comparable>
 int BinarySearch(
     const std::vector<Comparable> &a,
@@ -0,0 +1,80 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef INCLUDE_IRIDIUM_COMPRESSED_STORE_HPP_
+#define INCLUDE_IRIDIUM_COMPRESSED_STORE_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <ctime>
+#include <vector>
+#include "data.hpp"
+#include "storage.hpp"
+
+namespace iridium::data {
+/*
+ * Rows per compressed block, a decoded block fits comfortably in L1 cache
+ */
+constexpr std::size_t kCompressedBlockRows = 128;
+
+/*
+ * Series held in memory as delta-encoded blocks of kCompressedBlockRows rows.
+ * In each block:
+ *  time	zigzag varint of the distance from the previous bar minus the frequency stride
+ *  prices	zigzag varint pipette offsets from the block's first open
+ *  volume	varint
+ * Prices are rounded to the nearest pipette, i.e. pip_point + 1 decimals.
+ */
+class CompressedCandleSeries : public CandleSeries {
+ public:
+  /*
+   * @param columns: candlesticks sorted by ascending time
+   * @param freq
+   * @param price_decimals: decimals of one pipette, e.g., 5 for EUR_USD, 3 for USD_JPY
+   */
+  CompressedCandleSeries(const CandleColumns &columns, DataFreq freq, int price_decimals);
+
+  [[nodiscard]]
+  std::size_t size() const override;
+
+  [[nodiscard]]
+  int row_index(std::time_t time) const override;
+
+  [[nodiscard]]
+  HistoryWindow window(std::size_t first, std::size_t count) const override;
+
+  /*
+   * bytes held by the block index and encoded rows
+   */
+  [[nodiscard]]
+  std::size_t memory_usage() const noexcept;
+
+ private:
+  struct Block {
+    std::time_t first_time;
+    std::int64_t open;
+    std::size_t offset;
+    std::uint32_t rows;
+  };
+
+  void DecodeBlock(std::size_t block_index, CandleColumns &columns) const;
+
+  DataFreq freq_;
+  double price_scale_;
+  std::size_t size_;
+  std::vector<Block> blocks_;
+  std::vector<std::uint8_t> bytes_;
+  TimeIndex time_index_;
+};
+}  // namespace iridium::data
+
+#endif  // INCLUDE_IRIDIUM_COMPRESSED_STORE_HPP_
@@ -0,0 +1,119 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef INCLUDE_IRIDIUM_CSV_IMPORT_HPP_
+#define INCLUDE_IRIDIUM_CSV_IMPORT_HPP_
+
+#include <cstddef>
+#include <ctime>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "data.hpp"
+
+namespace iridium::data {
+/*
+ * Column index of a field the CSV does not have, e.g., dumps without volumes
+ */
+constexpr std::size_t kNoCsvColumn = std::numeric_limits<std::size_t>::max();
+
+/*
+ * Smallest part of a CSV parsed by one thread
+ */
+constexpr std::size_t kCsvChunkBytes = std::size_t{4} << 20;
+
+/*
+ * Field layout of a candle CSV dump, one candlestick per line.
+ * A first line whose time does not parse is taken for a header and skipped.
+ * Missing volumes are 0.
+ */
+struct CsvFormat {
+  char delimiter = ',';
+  std::size_t time_column = 0;
+  std::size_t open_column = 1;
+  std::size_t high_column = 2;
+  std::size_t low_column = 3;
+  std::size_t close_column = 4;
+  std::size_t volume_column = 5;
+};
+
+/*
+ * Parse a UTC time field: unix seconds, unix milliseconds (13 digits), YYYYMMDDHHMMSS,
+ * YYYYMMDD HHMMSS or YYYY-MM-DD[ T]HH:MM[:SS] with -, . or / between the date parts.
+ * Fractions of a second and a trailing Z are ignored.
+ * return std::nullopt if the field is none of them
+ */
+std::optional<std::time_t> ParseCsvTime(std::string_view field);
+
+/*
+ * Parse candle CSV text into columns in line order. The text is split at line ends into chunks of
+ * at least kCsvChunkBytes parsed on threads threads, 0 for one per core.
+ * Throws std::runtime_error naming the line of the first malformed row.
+ * @param text
+ * @param format
+ * @param threads
+ * @param name: reported in errors, e.g., the file name
+ */
+std::shared_ptr<CandleColumns> ParseCandleCsv(
+    std::string_view text,
+    const CsvFormat &format = CsvFormat(),
+    std::size_t threads = 0,
+    const std::string &name = "csv");
+
+/*
+ * Memory map and parse a candle CSV file, see ParseCandleCsv
+ */
+std::shared_ptr<CandleColumns> ReadCandleCsv(
+    const std::string &path,
+    const CsvFormat &format = CsvFormat(),
+    std::size_t threads = 0);
+
+/*
+ * Ordering and gaps of imported candlesticks
+ * out_of_order	rows earlier than the row before them
+ * duplicates	rows at the time of the row before them
+ * off_grid	rows not on a whole minute, or a whole hour from H1 up
+ * gaps		steps longer than the frequency, weekends and holidays included
+ * long_gaps	steps longer than kLongGap
+ * longest_gap	longest step in seconds
+ */
+struct CandleValidation {
+  std::size_t out_of_order = 0;
+  std::size_t duplicates = 0;
+  std::size_t off_grid = 0;
+  std::size_t gaps = 0;
+  std::size_t long_gaps = 0;
+  std::time_t longest_gap = 0;
+
+  /*
+   * return true if times strictly ascend, i.e. the rows can be stored as they are
+   */
+  [[nodiscard]]
+  bool ordered() const noexcept;
+};
+
+/*
+ * Steps longer than a long weekend are reported as long gaps
+ */
+constexpr std::time_t kLongGap = 4 * 24 * 60 * 60;
+
+CandleValidation ValidateCandles(const CandleColumns &columns, DataFreq freq);
+
+/*
+ * Sort rows by ascending time, of rows sharing a time only the last one is kept
+ */
+void SortCandles(CandleColumns &columns);
+}  // namespace iridium::data
+
+#endif  // INCLUDE_IRIDIUM_CSV_IMPORT_HPP_
@@ -14,13 +14,16 @@ limitations under the License.
 #define INCLUDE_IRIDIUM_DATA_HPP_
 
 #include <map>
+#include <functional>
+#include <unordered_map>
+#include <cstdint>
 #include <vector>
 #include <memory>
 #include <iostream>
 #include <string>
 #include <optional>
-#include "H5Cpp.h"
 #include "instrument.hpp"
+#include "price.hpp"
 #include "algorithm.hpp"
 #include "util.hpp"
 
@@ -58,8 +61,344 @@ struct Candlestick {
   int volume;
 };
 
+/*
+ * Bid and ask candlesticks of one bar
+ */
+struct Quote {
+  Candlestick bid;
+  Candlestick ask;
+};
+
+/*
+ * Non-owning views of struct-of-arrays candlestick columns
+ */
+struct CandleColumnsView {
+  algorithm::ColumnView<std::time_t> times;
+  algorithm::ColumnView<double> opens;
+  algorithm::ColumnView<double> closes;
+  algorithm::ColumnView<double> highs;
+  algorithm::ColumnView<double> lows;
+  algorithm::ColumnView<int> volumes;
+};
+
+/*
+ * Struct-of-arrays candlestick columns sorted by ascending time
+ */
+struct CandleColumns {
+  std::vector<std::time_t> times;
+  std::vector<double> opens;
+  std::vector<double> closes;
+  std::vector<double> highs;
+  std::vector<double> lows;
+  std::vector<int> volumes;
+
+  [[nodiscard]]
+  std::size_t size() const noexcept;
+
+  [[nodiscard]]
+  Candlestick candlestick(std::size_t index) const;
+
+  void reserve(std::size_t size);
+
+  void push_back(const Candlestick &candlestick);
+
+  [[nodiscard]]
+  CandleColumnsView view() const noexcept;
+};
+
+/*
+ * Read-only window over contiguous candlestick columns sorted by ascending time.
+ * The window never copies the candlesticks it views, it only shares ownership of the
+ * underlying storage so the view stays valid as long as the window is alive.
+ */
+class HistoryWindow {
+ public:
+  HistoryWindow() = default;
+
+  HistoryWindow(
+      const std::shared_ptr<const CandleColumns> &columns,
+      std::size_t first,
+      std::size_t count);
+
+  /*
+   * @param owner: keeps the storage behind the column views alive
+   * @param columns
+   * @param first
+   * @param count
+   */
+  HistoryWindow(
+      std::shared_ptr<const void> owner,
+      const CandleColumnsView &columns,
+      std::size_t first,
+      std::size_t count);
+
+  /*
+   * copy a candlestick list into columns owned by the window
+   */
+  explicit HistoryWindow(const std::vector<Candlestick> &data_list);
+
+  [[nodiscard]]
+  std::size_t size() const noexcept;
+
+  [[nodiscard]]
+  bool empty() const noexcept;
+
+  [[nodiscard]]
+  std::time_t begin_time() const;
+
+  [[nodiscard]]
+  std::time_t end_time() const;
+
+  [[nodiscard]]
+  Candlestick operator[](std::size_t index) const;
+
+  [[nodiscard]]
+  Candlestick front() const;
+
+  [[nodiscard]]
+  Candlestick back() const;
+
+  [[nodiscard]]
+  algorithm::ColumnView<std::time_t> times() const noexcept;
+
+  [[nodiscard]]
+  algorithm::ColumnView<double> opens() const noexcept;
+
+  [[nodiscard]]
+  algorithm::ColumnView<double> closes() const noexcept;
+
+  [[nodiscard]]
+  algorithm::ColumnView<double> highs() const noexcept;
+
+  [[nodiscard]]
+  algorithm::ColumnView<double> lows() const noexcept;
+
+  [[nodiscard]]
+  algorithm::ColumnView<int> volumes() const noexcept;
+
+  /*
+   * view of count candlesticks starting at first, sharing the same storage
+   */
+  [[nodiscard]]
+  HistoryWindow sub_window(std::size_t first, std::size_t count) const;
+
+  [[nodiscard]]
+  std::shared_ptr<std::vector<Candlestick>> data_list() const;
+
+ private:
+  std::shared_ptr<const void> owner_;
+  algorithm::ColumnView<std::time_t> times_;
+  algorithm::ColumnView<double> opens_;
+  algorithm::ColumnView<double> closes_;
+  algorithm::ColumnView<double> highs_;
+  algorithm::ColumnView<double> lows_;
+  algorithm::ColumnView<int> volumes_;
+};
+
+using HistoryWindowList = std::vector<HistoryWindow>;
+
+/*
+ * Candlestick field of a panel
+ */
+enum CandleField {
+  kOpenPrice, kHighPrice, kLowPrice, kClosePrice, kVolume
+};
+
+double candle_field(const Candlestick &candlestick, CandleField field);
+
+/*
+ * Time-major [time x instrument] matrix of one candlestick field. Row r holds every instrument at
+ * times()[r] contiguously, so cross-instrument computations, e.g., correlations or basket values,
+ * vectorize over rows. valid(r, c) is true if instrument c has a bar at times()[r], other cells hold
+ * the previous bar of the instrument if forward filled, NaN otherwise.
+ */
+class Panel {
+ public:
+  Panel() = default;
+
+  /*
+   * rows at times with columns cells each, every cell NaN and invalid
+   */
+  Panel(std::vector<std::time_t> times, std::size_t columns);
+
+  [[nodiscard]]
+  std::size_t rows() const noexcept;
+
+  [[nodiscard]]
+  std::size_t columns() const noexcept;
+
+  [[nodiscard]]
+  const std::vector<std::time_t> &times() const noexcept;
+
+  /*
+   * rows() * columns() values, row after row
+   */
+  [[nodiscard]]
+  const double *values() const noexcept;
+
+  [[nodiscard]]
+  const double *row(std::size_t row) const noexcept;
+
+  [[nodiscard]]
+  double operator()(std::size_t row, std::size_t column) const noexcept;
+
+  /*
+   * rows() * columns() flags, 1 where the instrument has a bar
+   */
+  [[nodiscard]]
+  const std::uint8_t *mask() const noexcept;
+
+  [[nodiscard]]
+  bool valid(std::size_t row, std::size_t column) const noexcept;
+
+  /*
+   * fill a column in one pass over a window sorted by ascending time whose times are all in times().
+   * With forward_fill, cells without a bar take the previous bar of the window, or seed before its first bar.
+   */
+  void FillColumn(
+      std::size_t column,
+      const HistoryWindow &window,
+      CandleField field,
+      bool forward_fill,
+      std::optional<double> seed = std::nullopt);
+
+ private:
+  std::vector<std::time_t> times_;
+  std::size_t columns_ = 0;
+  std::vector<double> values_;
+  std::vector<std::uint8_t> mask_;
+};
+
+/*
+ * kOnDemand	Read candlesticks from the HDF5 file on every query
+ * kInMemory	Load every instrument/frequency into memory columns at construction
+ * kCompressed	Load every instrument/frequency into delta-encoded blocks at construction,
+ *		prices are rounded to pipettes and blocks are decoded per query
+ * kFixedPoint	Load every instrument/frequency into int32 pipette columns next to their rounded prices at
+ *		construction, snapshots carry pipette candlesticks and the account compares fills in pipettes
+ * kStreaming	Keep a sliding buffer per instrument/frequency while the clock walks forward, holding
+ *		warm_up_bars bars behind the latest bar read and reading stream_block_rows bars ahead at once,
+ *		memory is bounded by the buffers instead of the history, see stream_store.hpp
+ */
+enum LoadMode {
+  kOnDemand, kInMemory, kCompressed, kFixedPoint, kStreaming
+};
+
+/*
+ * Bars kStreaming reads ahead at once by default
+ */
+constexpr std::size_t kStreamBlockRows = 16384;
+
+/*
+ * kAutoDetect	Partitions if the path is a directory with a manifest.csv, native candle files if it is
+ *		another directory, otherwise HDF5
+ * kHdf5	HDF5 file with /instruments/<instrument>_<freq> compound datasets
+ * kNative	Directory of memory mapped <instrument>_<freq>.candles files
+ * kSharedMemory	POSIX shared memory published by iridium-shm-server, the file name is the prefix
+ *		of the objects, see shm_store.hpp
+ * kPartitioned	Directory of one HDF5 file per instrument/frequency/year and a manifest of their time
+ *		ranges, only the partitions overlapping range are opened, see partition_store.hpp
+ */
+enum StorageBackend {
+  kAutoDetect, kHdf5, kNative, kSharedMemory, kPartitioned
+};
+
+/*
+ * Reported each time TradeData finishes loading a dataset
+ */
+struct LoadProgress {
+  std::string dataset;
+  std::size_t completed;
+  std::size_t total;
+  std::size_t rows;
+  double seconds;
+};
+
+using LoadProgressCallback = std::function<void(const LoadProgress &)>;
+
+/*
+ * Inclusive time range
+ */
+struct TimeRange {
+  std::time_t begin;
+  std::time_t end;
+};
+
+/*
+ * How TradeData loads its data, the defaults read HDF5 datasets per query
+ */
+struct TradeDataOptions {
+  /*
+   * only applies to HDF5, native candle files and shared memory are always memory mapped
+   */
+  LoadMode load_mode = LoadMode::kOnDemand;
+
+  /*
+   * kPartitioned reads partitions in memory, in parallel at construction and one after another with
+   * lazy_open, it throws std::invalid_argument with kOnDemand or kStreaming
+   */
+  StorageBackend backend = StorageBackend::kAutoDetect;
+
+  /*
+   * read only the M1 data and resample every other frequency from it at construction, bars align
+   * to the trading days of the region. kStreaming does not resample.
+   */
+  std::optional<std::string> resample_region = std::nullopt;
+
+  /*
+   * threads datasets load on, 0 for one per core, HDF5 reads still take turns
+   */
+  std::size_t load_threads = 0;
+
+  /*
+   * called from the loading threads, one call at a time
+   */
+  LoadProgressCallback progress = nullptr;
+
+  /*
+   * read nothing at construction, open and index each instrument/frequency on first access,
+   * missing datasets only throw then and progress is not reported
+   */
+  bool lazy_open = false;
+
+  /*
+   * bytes of a chunk cache keeping recently read kOnDemand rows, 0 for none
+   */
+  std::size_t cache_bytes = 0;
+
+  /*
+   * load bid/ask bars of the stored frequencies from the HDF5 /quotes/<instrument>_<freq> datasets
+   * where present, FillSnapshot adds them to snapshots
+   */
+  bool quotes = false;
+
+  /*
+   * load only the HDF5 bars within it plus warm_up_bars bars before its begin, each bound found by a
+   * binary search reading one time per step. Resampled frequencies get warm_up_bars bars of the
+   * coarsest frequency. Native candle files, shared memory and quotes are not scoped.
+   */
+  std::optional<TimeRange> range = std::nullopt;
+
+  /*
+   * bars loaded before range, also the largest lookback of the run kStreaming buffers keep,
+   * kStreaming throws std::invalid_argument when it is 0
+   */
+  std::size_t warm_up_bars = 0;
+
+  /*
+   * bars kStreaming reads ahead at once
+   */
+  std::size_t stream_block_rows = kStreamBlockRows;
+
+  /*
+   * open the HDF5 file for single-writer/multi-reader access while an Hdf5Appender appends to it,
+   * see swmr_store.hpp. Datasets are read in memory, kOnDemand loads like kInMemory, and Refresh
+   * picks up appended rows. Throws std::invalid_argument with resampling, range, quotes or lazy_open.
+   */
+  bool swmr_read = false;
+};
+
 using DataListMap = std::map<std::string, std::shared_ptr<std::vector<Candlestick>>>;
-using TickDataMap = std::map<std::string, std::optional<iridium::data::Candlestick>>;
 using DataList = std::vector<Candlestick>;
 
 std::shared_ptr<std::vector<double>> candlestick_closes(const std::vector<Candlestick> &dataList);
@@ -67,22 +406,229 @@ std::shared_ptr<std::vector<double>> candlestick_opens(const std::vector<Candles
 std::shared_ptr<std::vector<double>> candlestick_lows(const std::vector<Candlestick> &dataList);
 std::shared_ptr<std::vector<double>> candlestick_highs(const std::vector<Candlestick> &dataList);
 
+/*
+ * Dense instrument id reported for instruments a MarketSnapshot does not cover
+ */
+constexpr int kNoInstrument = -1;
+
+/*
+ * Dense currency id reported for currencies no instrument of a MarketSnapshot quotes
+ */
+constexpr int kNoCurrency = -1;
+
+/*
+ * Candlestick of every instrument at one tick, stored in a flat array indexed by the dense
+ * instrument id, i.e. the position of the instrument in the list the snapshot was built from.
+ * A presence bitmask tells which instruments have a candlestick at the tick, a second one which
+ * instruments also have a bid/ask quote.
+ * Reset, Set and SetQuote never allocate, a snapshot is meant to be refilled in place every tick.
+ * A fixed point snapshot also keeps every candlestick and quote in pipettes of its instrument.
+ * The conversion route between every two currencies of the instruments is resolved once at
+ * construction: the direct pair if there is one, otherwise two pairs through USD or EUR.
+ */
+class MarketSnapshot {
+ public:
+  MarketSnapshot() = default;
+
+  explicit MarketSnapshot(const InstrumentList &instruments, bool fixed_point = false);
+
+  [[nodiscard]]
+  std::size_t size() const noexcept;
+
+  [[nodiscard]]
+  const InstrumentList &instruments() const noexcept;
+
+  [[nodiscard]]
+  std::time_t time() const noexcept;
+
+  /*
+   * return the dense id of the instrument, kNoInstrument if the snapshot does not cover it
+   */
+  [[nodiscard]]
+  int instrument_id(const std::string &instrument_name) const noexcept;
+
+  [[nodiscard]]
+  bool has_data(int id) const noexcept;
+
+  /*
+   * return the dense id of the currency, kNoCurrency if no instrument of the snapshot has it
+   */
+  [[nodiscard]]
+  int currency_id(const std::string &currency) const noexcept;
+
+  /*
+   * return units of currency per unit of account currency at the snapshot close,
+   * std::nullopt if there is no route between them or a pair on the route has no data
+   */
+  [[nodiscard]]
+  std::optional<double> currency_rate(int account_id, int currency_id) const noexcept;
+
+  /*
+   * only valid if has_data(id)
+   */
+  [[nodiscard]]
+  const Candlestick &candlestick(int id) const noexcept;
+
+  [[nodiscard]]
+  std::optional<Candlestick> candlestick(const std::string &instrument_name) const noexcept;
+
+  [[nodiscard]]
+  bool has_quote(int id) const noexcept;
+
+  /*
+   * only valid if has_quote(id)
+   */
+  [[nodiscard]]
+  const Quote &quote(int id) const noexcept;
+
+  [[nodiscard]]
+  bool fixed_point() const noexcept;
+
+  /*
+   * only valid if fixed_point()
+   */
+  [[nodiscard]]
+  const PriceScale &price_scale(int id) const noexcept;
+
+  /*
+   * only valid if fixed_point() and has_data(id)
+   */
+  [[nodiscard]]
+  const FixedCandlestick &fixed_candlestick(int id) const noexcept;
+
+  /*
+   * only valid if fixed_point() and has_quote(id)
+   */
+  [[nodiscard]]
+  const FixedQuote &fixed_quote(int id) const noexcept;
+
+  /*
+   * clear every candlestick and quote and move the snapshot to time
+   */
+  void Reset(std::time_t time) noexcept;
+
+  void Set(int id, const Candlestick &candlestick) noexcept;
+
+  void SetQuote(int id, const Quote &quote) noexcept;
+
+ private:
+  /*
+   * one pair of a conversion route, inverse if the route sells the base currency of the pair
+   */
+  struct CurrencyLeg {
+    int instrument_id;
+    bool inverse;
+  };
+
+  struct CurrencyRoute {
+    CurrencyLeg legs[2];
+    int size;
+  };
+
+  void BuildCurrencyRoutes();
+
+  InstrumentList instruments_;
+  std::unordered_map<std::string, int> ids_;
+  std::vector<Candlestick> candlesticks_;
+  std::vector<Quote> quotes_;
+  std::vector<PriceScale> scales_;
+  std::vector<FixedCandlestick> fixed_candlesticks_;
+  std::vector<FixedQuote> fixed_quotes_;
+  std::vector<std::uint64_t> present_;
+  std::vector<std::uint64_t> quoted_;
+  std::unordered_map<std::string, int> currency_ids_;
+  std::vector<CurrencyRoute> currency_routes_;
+  std::time_t time_ = 0;
+};
+
+/*
+ * Candlestick data of instruments at several frequencies.
+ * Every const method is safe to call from several threads at once, e.g., parameter sweeps or
+ * per-instrument evaluation sharing one loaded TradeData.
+ * kInMemory, kCompressed, kFixedPoint, native candle files, shared memory and resampled frequencies
+ * are immutable after construction and read without any lock. kOnDemand and kStreaming reads go
+ * through the HDF5 library and serialize on one lock, see lock_free_reads. SWMR series read without
+ * a lock and only change in Refresh.
+ */
 class TradeData {
  public:
   TradeData(
       const std::string &file_name,
       const InstrumentList &instruments,
-      const std::vector<DataFreq> &freqs);
+      const std::vector<DataFreq> &freqs,
+      const TradeDataOptions &options = TradeDataOptions());
 
   ~TradeData();
 
+  /*
+   * return true if concurrent reads never wait on each other
+   */
+  [[nodiscard]]
+  bool lock_free_reads() const noexcept;
+
+  /*
+   * read the rows appended to the file since construction or the last refresh, extending every series
+   * and its time index in place, return how many. Only for swmr_read. Not safe to call concurrently
+   * with other methods, windows returned before stay valid.
+   */
+  std::size_t Refresh();
+
+  /*
+   * return true if the instrument has a candlestick at time, false for instruments or
+   * frequencies that are not loaded. Missing bars cost a bit test and never throw.
+   */
+  [[nodiscard]]
+  bool has_bar(const std::string &instrument_name, std::time_t time, DataFreq freq) const;
+
+  /*
+   * return the candlestick at time, std::nullopt if there is none, without throwing
+   */
+  [[nodiscard]]
+  std::optional<Candlestick>
+  try_candle(const std::string &instrument_name, std::time_t time, DataFreq freq) const;
+
   [[nodiscard]]
   std::optional<Candlestick>
   candlestick_data(const std::string &instrument_name, std::time_t time, DataFreq freq) const;
 
+  /*
+   * return an empty snapshot over the instruments of this TradeData
+   */
+  [[nodiscard]]
+  MarketSnapshot market_snapshot() const;
+
+  /*
+   * refill snapshot with the candlesticks at time, snapshots from market_snapshot()
+   * skip every name lookup
+   */
+  void FillSnapshot(std::time_t time, DataFreq freq, MarketSnapshot &snapshot) const;
+
+  [[nodiscard]]
+  HistoryWindow
+  history_window(
+      const std::string &instrument_name,
+      std::time_t end,
+      int count,
+      DataFreq freq) const;
+
   [[nodiscard]]
-  std::shared_ptr<TickDataMap>
-  candlestick_data(const InstrumentList &instruments, std::time_t time, DataFreq freq) const;
+  HistoryWindow
+  history_window_date_range(
+      const std::string &instrument_name,
+      std::time_t begin,
+      std::time_t end,
+      DataFreq freq) const;
+
+  /*
+   * return count candlesticks before end for each instrument, in the order of instruments
+   */
+  [[nodiscard]]
+  HistoryWindowList
+  history_windows(
+      const InstrumentList &instruments,
+      std::time_t end,
+      int count,
+      DataFreq freq) const;
 
   [[nodiscard]]
   std::shared_ptr<DataList>
@@ -108,14 +654,66 @@ class TradeData {
       int count,
       DataFreq freq) const;
 
+  /*
+   * return the field of instruments at every bar time with begin <= time <= end of any of them,
+   * columns in the order of instruments. Each instrument is read with one window over its bars.
+   * With forward_fill, gaps take the previous bar of the instrument, including the last bar before begin.
+   */
+  [[nodiscard]]
+  Panel
+  panel(
+      const InstrumentList &instruments,
+      std::time_t begin,
+      std::time_t end,
+      DataFreq freq,
+      CandleField field,
+      bool forward_fill = false) const;
+
+  /*
+   * return the highest high of the bars with begin <= time <= end, std::nullopt if there is none.
+   * The first range or touch query of an instrument/frequency builds a min/max pyramid over the bars
+   * held in memory, see range_query.hpp, later queries take constant time. kCompressed decodes a copy
+   * of the bars for it. Series read from disk with kOnDemand or kStreaming throw std::logic_error.
+   */
+  [[nodiscard]]
+  std::optional<double>
+  highest_high(const std::string &instrument_name, std::time_t begin, std::time_t end, DataFreq freq) const;
+
+  /*
+   * return the lowest low of the bars with begin <= time <= end, std::nullopt if there is none
+   */
+  [[nodiscard]]
+  std::optional<double>
+  lowest_low(const std::string &instrument_name, std::time_t begin, std::time_t end, DataFreq freq) const;
+
+  /*
+   * return the time of the first bar after the given time whose high reaches price,
+   * e.g., where a take profit of a long trade or a stop loss of a short trade fills,
+   * std::nullopt if no bar does. Takes O(log n) on the pyramid.
+   */
+  [[nodiscard]]
+  std::optional<std::time_t>
+  first_high_at_or_above(const std::string &instrument_name, std::time_t after, double price, DataFreq freq) const;
+
+  /*
+   * return the time of the first bar after the given time whose low reaches price,
+   * std::nullopt if no bar does
+   */
+  [[nodiscard]]
+  std::optional<std::time_t>
+  first_low_at_or_below(const std::string &instrument_name, std::time_t after, double price, DataFreq freq) const;
+
  private:
   class DataImpl;
   std::unique_ptr<DataImpl> pimpl_;
 };
 
+/*
+ * return units of currency per unit of account currency at the snapshot close, see MarketSnapshot::currency_rate
+ */
 std::optional<double>
 account_currency_rate(const std::string &account, const std::string &currency,
-                      const TickDataMap &tickDataMap);
+                      const MarketSnapshot &snapshot);
 }  // namespace iridium
 
 std::ostream &operator<<(std::ostream &os, const iridium::data::Candlestick &candlestick);
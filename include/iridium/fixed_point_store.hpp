@@ -0,0 +1,72 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef INCLUDE_IRIDIUM_FIXED_POINT_STORE_HPP_
+#define INCLUDE_IRIDIUM_FIXED_POINT_STORE_HPP_
+
+#include <cstddef>
+#include <ctime>
+#include <memory>
+#include <vector>
+#include "data.hpp"
+#include "price.hpp"
+#include "storage.hpp"
+
+namespace iridium::data {
+/*
+ * Series held in memory as columns of int32 pipettes for exact comparisons, next to the double columns
+ * they round to, converted once at construction so windows view them without a copy.
+ * Takes a third more memory than kInMemory columns in exchange for fills compared in whole pipettes.
+ */
+class FixedPointSeries : public CandleSeries {
+ public:
+  /*
+   * @param columns: candlesticks sorted by ascending time
+   * @param freq
+   * @param scale: pipettes of the instrument
+   */
+  FixedPointSeries(const CandleColumns &columns, DataFreq freq, const PriceScale &scale);
+
+  [[nodiscard]]
+  std::size_t size() const override;
+
+  [[nodiscard]]
+  int row_index(std::time_t time) const override;
+
+  [[nodiscard]]
+  HistoryWindow window(std::size_t first, std::size_t count) const override;
+
+  [[nodiscard]]
+  FixedCandlestick fixed_candlestick(std::size_t row) const noexcept;
+
+  [[nodiscard]]
+  const PriceScale &price_scale() const noexcept;
+
+  /*
+   * bytes held by the columns
+   */
+  [[nodiscard]]
+  std::size_t memory_usage() const noexcept;
+
+ private:
+  PriceScale scale_;
+  std::vector<Pipettes> opens_;
+  std::vector<Pipettes> closes_;
+  std::vector<Pipettes> highs_;
+  std::vector<Pipettes> lows_;
+  // times, volumes and prices of the pipettes
+  std::shared_ptr<const CandleColumns> columns_;
+  TimeIndex time_index_;
+};
+}  // namespace iridium::data
+
+#endif  // INCLUDE_IRIDIUM_FIXED_POINT_STORE_HPP_
@@ -0,0 +1,220 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef INCLUDE_IRIDIUM_HDF5_STORE_HPP_
+#define INCLUDE_IRIDIUM_HDF5_STORE_HPP_
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "H5Cpp.h"
+#include "data.hpp"
+#include "storage.hpp"
+
+namespace iridium::data {
+/*
+ * e.g., /instruments/EUR_USD_M1
+ */
+std::string instrument_dataset_path(const std::string &dataset_name);
+
+/*
+ * e.g., /quotes/EUR_USD_M1
+ */
+std::string quote_dataset_path(const std::string &dataset_name);
+
+/*
+ * return the names of the candlestick datasets of the file, e.g., EUR_USD_M1, none without /instruments
+ */
+std::vector<std::string> ListCandleDataSets(const H5::H5File &file);
+
+/*
+ * return the names of the quote datasets of the file, none without /quotes
+ */
+std::vector<std::string> ListQuoteDataSets(const H5::H5File &file);
+
+/*
+ * split a dataset name into its instrument name and frequency, e.g., EUR_USD_M1 into EUR_USD and M1,
+ * std::nullopt if it has no '_'
+ */
+std::optional<std::pair<std::string, DataFreq>> SplitDataSetName(const std::string &dataset_name);
+
+/*
+ * HDF5 serial builds are not thread safe, series reading from HDF5 hold this lock
+ */
+std::mutex &hdf5_mutex();
+
+/*
+ * Compound type matching the Candlestick struct layout
+ */
+H5::CompType candlestick_type();
+
+/*
+ * Chunk layout of datasets written for our access pattern: whole-column loads and windows walking
+ * forward in time. Chunks of kChunkRows rows line up with ChunkCache chunks, shuffle groups the bytes
+ * of each member before deflate.
+ */
+struct ChunkLayout {
+  std::size_t chunk_rows = kChunkRows;
+  int deflate_level = 4;
+  bool shuffle = true;
+};
+
+/*
+ * Attribute of candlestick datasets stored by ascending time, every other dataset is stored by descending time
+ */
+constexpr char kAscendingAttribute[] = "ascending";
+
+/*
+ * Chunks an open chunked dataset keeps in its chunk cache
+ */
+constexpr std::size_t kCachedChunks = 16;
+
+/*
+ * Open /instruments/<dataset_name>. Chunked datasets get a chunk cache sized to kCachedChunks of
+ * their chunks instead of the 1MB default, fully read chunks are evicted first.
+ */
+std::shared_ptr<H5::DataSet> OpenCandleDataSet(const H5::H5File &file, const std::string &dataset_name);
+
+/*
+ * Rows of a dataset counted in ascending time order
+ */
+struct RowRange {
+  std::size_t first;
+  std::size_t count;
+};
+
+/*
+ * Rows a binary search over the times of a dataset reads at once when it narrows to them
+ */
+constexpr std::size_t kTimeSearchRows = 4096;
+
+/*
+ * Find the rows of a candlestick dataset with begin <= time <= end, extended by up to warm_up rows
+ * before begin. Each bound is found by a binary search reading one time per step, about
+ * log2(rows / kTimeSearchRows) chunks and one block of kTimeSearchRows times, never the whole time column.
+ */
+RowRange FindRowRange(const H5::DataSet &dataset, std::time_t begin, std::time_t end, std::size_t warm_up);
+
+/*
+ * Return the first row within rows of a candlestick dataset with a time not before time,
+ * rows.first + rows.count if there is none, by the same binary search as FindRowRange
+ */
+std::size_t FindRow(const H5::DataSet &dataset, RowRange rows, std::time_t time);
+
+/*
+ * Read every row of a candlestick dataset into columns sorted by ascending time.
+ * Datasets are stored by descending time, or ascending time if they carry kAscendingAttribute.
+ * Chunked datasets with little endian members and only deflate, shuffle or fletcher32 filters are read
+ * chunk by chunk with H5Dread_chunk and decoded straight into the columns, bypassing the HDF5 type
+ * conversion and chunk cache. Decoding runs outside hdf5_mutex. Other datasets are read in
+ * blocks of whole rows, which HDF5 copies without conversion when the file type matches candlestick_type.
+ */
+std::shared_ptr<CandleColumns> ReadColumns(const H5::DataSet &dataset);
+
+/*
+ * Read the rows of a candlestick dataset into columns sorted by ascending time
+ */
+std::shared_ptr<CandleColumns> ReadColumns(const H5::DataSet &dataset, RowRange rows);
+
+/*
+ * Read a quote dataset with time, bid_open, bid_close, bid_high, bid_low, ask_open, ask_close,
+ * ask_high, ask_low and volume members into bid and ask columns sorted by ascending time
+ */
+std::pair<CandleColumns, CandleColumns> ReadQuotes(const H5::DataSet &dataset);
+
+/*
+ * Write candlesticks sorted by ascending time to /instruments/<dataset_name>, stored by descending time.
+ * An existing dataset of that name is replaced. With a chunk layout, rows are stored packed in
+ * compressed chunks, otherwise contiguous in the candlestick_type layout.
+ */
+void WriteCandles(
+    H5::H5File &file,
+    const std::string &dataset_name,
+    const CandleColumns &columns,
+    std::optional<ChunkLayout> layout = std::nullopt);
+
+/*
+ * Create an empty /instruments/<dataset_name> chunked with a layout and stored by ascending time,
+ * so AppendCandles extends it in place while SWMR readers keep it open, see swmr_store.hpp.
+ * An existing dataset of that name is replaced.
+ */
+void CreateAppendableCandles(H5::H5File &file, const std::string &dataset_name, const ChunkLayout &layout = ChunkLayout());
+
+/*
+ * Append candlesticks sorted by ascending time, all after the last stored one, to a dataset created by
+ * CreateAppendableCandles and flush them to the file. Return the row count of the dataset.
+ */
+std::size_t AppendCandles(const H5::DataSet &dataset, const CandleColumns &columns);
+
+/*
+ * Write bid and ask bars to /quotes/<dataset_name>, stored by descending time like
+ * the instrument datasets, see WriteCandles
+ */
+void WriteQuotes(
+    H5::H5File &file,
+    const std::string &dataset_name,
+    const CandleColumns &bid,
+    const CandleColumns &ask,
+    std::optional<ChunkLayout> layout = std::nullopt);
+
+/*
+ * Series reading candlesticks from an HDF5 dataset on every window request,
+ * only the time index is held in memory.
+ * With a chunk cache, rows are read in chunks of kChunkRows and recently used chunks are kept.
+ * With rows, the series only covers those rows of the dataset.
+ */
+class Hdf5Series : public CandleSeries {
+ public:
+  Hdf5Series(
+      std::shared_ptr<H5::DataSet> dataset,
+      DataFreq freq,
+      std::shared_ptr<ChunkCache> cache = nullptr,
+      std::optional<RowRange> rows = std::nullopt);
+
+  [[nodiscard]]
+  std::size_t size() const override;
+
+  [[nodiscard]]
+  int row_index(std::time_t time) const override;
+
+  [[nodiscard]]
+  HistoryWindow window(std::size_t first, std::size_t count) const override;
+
+  [[nodiscard]]
+  bool lock_free() const noexcept override;
+
+  [[nodiscard]]
+  bool in_memory() const override;
+
+ private:
+  std::shared_ptr<H5::DataSet> dataset_;
+  std::size_t dataset_size_;
+  std::size_t first_row_;
+  std::size_t size_;
+  bool ascending_;
+  TimeIndex time_index_;
+  H5::CompType candlestick_type_;
+  std::shared_ptr<ChunkCache> cache_;
+  std::uint64_t cache_id_;
+
+  /*
+   * read rows first ... first + count - 1 sorted by ascending time
+   */
+  [[nodiscard]]
+  std::vector<Candlestick> ReadRows(std::size_t first, std::size_t count) const;
+};
+}  // namespace iridium::data
+
+#endif  // INCLUDE_IRIDIUM_HDF5_STORE_HPP_
@@ -42,6 +42,11 @@ class Instrument {
 
 int pip_point(const Instrument &instrument) noexcept;
 
+/*
+ * price of one pip, 10 ^ -pip_point
+ */
+double pip_size(const Instrument &instrument) noexcept;
+
 using InstrumentList = std::vector<std::shared_ptr<Instrument>>;
 
 std::shared_ptr<InstrumentList>
@@ -216,6 +216,15 @@ class LimitOrder: public Order {
   [[nodiscard]]
   const std::shared_ptr<Instrument> &instrument_ptr() const noexcept;
 
+  /*
+   * dense id of the instrument in the market snapshots the account processes it with,
+   * std::nullopt until the account first looks it up
+   */
+  [[nodiscard]]
+  std::optional<int> instrument_id() const noexcept;
+
+  void set_instrument_id(int id) noexcept;
+
   [[nodiscard]]
   const std::shared_ptr<TakeProfitDetails> &take_profit_details_ptr() const noexcept;
 
@@ -238,6 +247,7 @@ class LimitOrder: public Order {
 
  private:
   std::shared_ptr<Instrument> instrument_ptr_;
+  std::optional<int> instrument_id_;
   int units_;
   double price_;
   std::shared_ptr<TakeProfitDetails> take_profit_details_ptr_;
@@ -0,0 +1,138 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef INCLUDE_IRIDIUM_PARTITION_STORE_HPP_
+#define INCLUDE_IRIDIUM_PARTITION_STORE_HPP_
+
+#include <cstddef>
+#include <ctime>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "data.hpp"
+#include "hdf5_store.hpp"
+
+namespace iridium::data {
+/*
+ * Partition manifest file in the root directory of a partitioned history
+ */
+constexpr char kManifestFileName[] = "manifest.csv";
+
+/*
+ * One UTC year of an instrument/frequency, stored as /instruments/<instrument>_<freq> of
+ * <instrument>_<freq>/<year>.h5 under the root directory
+ */
+struct Partition {
+  std::string instrument;
+  DataFreq freq;
+  int year;
+  std::time_t first_time;
+  std::time_t last_time;
+  std::size_t rows;
+};
+
+/*
+ * e.g., EUR_USD_M1/2020.h5
+ */
+std::string partition_file_name(const std::string &instrument_name, DataFreq freq, int year);
+
+/*
+ * return the UTC year of time
+ */
+int utc_year(std::time_t time);
+
+/*
+ * Time range and row count of every partition of a partitioned history, kept in manifest.csv
+ * so loads pick the partitions of a backtest window without opening the others
+ */
+class PartitionManifest {
+ public:
+  /*
+   * read the manifest of directory, empty if there is none yet
+   */
+  explicit PartitionManifest(std::string directory);
+
+  [[nodiscard]]
+  const std::string &directory() const noexcept;
+
+  /*
+   * return the partitions of an instrument/frequency sorted by year
+   */
+  [[nodiscard]]
+  std::vector<Partition> partitions(const std::string &instrument_name, DataFreq freq) const;
+
+  [[nodiscard]]
+  const std::vector<Partition> &all() const noexcept;
+
+  /*
+   * path of the partition file
+   */
+  [[nodiscard]]
+  std::string path(const Partition &partition) const;
+
+  /*
+   * add the partition or replace the one of its instrument, frequency and year
+   */
+  void Update(const Partition &partition);
+
+  /*
+   * write manifest.csv, replacing the previous one atomically
+   */
+  void Save() const;
+
+  /*
+   * return true if directory holds a manifest
+   */
+  static bool Exists(const std::string &directory);
+
+ private:
+  std::string directory_;
+  std::vector<Partition> partitions_;
+};
+
+/*
+ * Candlestick dataset of a partition file, opened and closed under hdf5_mutex
+ */
+class PartitionReader {
+ public:
+  PartitionReader(const PartitionManifest &manifest, const Partition &partition);
+
+  PartitionReader(const PartitionReader &) = delete;
+
+  PartitionReader &operator=(const PartitionReader &) = delete;
+
+  ~PartitionReader();
+
+  [[nodiscard]]
+  const H5::DataSet &dataset() const noexcept;
+
+ private:
+  std::unique_ptr<H5::H5File> file_;
+  std::shared_ptr<H5::DataSet> dataset_;
+};
+
+/*
+ * Write candlesticks sorted by ascending time into the year partitions of an instrument/frequency and save
+ * the manifest. Rows of a year that already has a partition are merged into it, replacing stored rows of
+ * the same time. Only the partitions of the years the rows fall in are rewritten, each into a new file
+ * renamed over the old one, so readers never see a partial partition.
+ */
+void WritePartitions(
+    PartitionManifest &manifest,
+    const std::string &instrument_name,
+    DataFreq freq,
+    const CandleColumns &columns,
+    std::optional<ChunkLayout> layout = ChunkLayout());
+}  // namespace iridium::data
+
+#endif  // INCLUDE_IRIDIUM_PARTITION_STORE_HPP_
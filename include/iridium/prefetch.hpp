@@ -0,0 +1,86 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef INCLUDE_IRIDIUM_PREFETCH_HPP_
+#define INCLUDE_IRIDIUM_PREFETCH_HPP_
+
+#include <condition_variable>
+#include <ctime>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "data.hpp"
+
+namespace iridium::data {
+/*
+ * Reads TradeData::history_windows for every tick of a schedule on a background thread,
+ * keeping up to depth ticks ready in a ring of buffers.
+ * The TradeData must outlive the prefetcher.
+ */
+class WindowPrefetcher {
+ public:
+  /*
+   * @param data
+   * @param instruments
+   * @param ticks: schedule sorted by ascending time, e.g., calendar::all_ticks_ptr
+   * @param count: candlesticks per window
+   * @param freq
+   * @param depth: number of ticks read ahead
+   */
+  WindowPrefetcher(
+      const TradeData &data,
+      const InstrumentList &instruments,
+      std::vector<std::time_t> ticks,
+      int count,
+      DataFreq freq,
+      std::size_t depth = 8);
+
+  WindowPrefetcher(const WindowPrefetcher &) = delete;
+
+  WindowPrefetcher &operator=(const WindowPrefetcher &) = delete;
+
+  ~WindowPrefetcher();
+
+  /*
+   * return the windows of TradeData::history_windows(instruments, tick, count, freq),
+   * rethrow its exception if it failed. Ticks must be requested by ascending time, prefetched
+   * ticks before tick are dropped, ticks outside the schedule are read synchronously.
+   */
+  HistoryWindowList windows(std::time_t tick);
+
+ private:
+  struct Slot {
+    std::time_t tick;
+    HistoryWindowList windows;
+    std::exception_ptr error;
+  };
+
+  const TradeData &data_;
+  InstrumentList instruments_;
+  std::vector<std::time_t> ticks_;
+  int count_;
+  DataFreq freq_;
+  std::vector<Slot> ring_;
+  std::size_t head_;
+  std::size_t tail_;
+  bool stopped_;
+  std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  std::thread worker_;
+
+  void Run();
+};
+}  // namespace iridium::data
+
+#endif  // INCLUDE_IRIDIUM_PREFETCH_HPP_
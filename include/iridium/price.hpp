@@ -0,0 +1,97 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef INCLUDE_IRIDIUM_PRICE_HPP_
+#define INCLUDE_IRIDIUM_PRICE_HPP_
+
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include "instrument.hpp"
+
+namespace iridium::data {
+/*
+ * Fixed-point price, an integer count of pipettes, i.e. units of the last quoted decimal
+ */
+using Pipettes = std::int32_t;
+
+constexpr Pipettes kPipettesPerPip = 10;
+
+struct Candlestick;
+
+/*
+ * Candlestick with prices in pipettes
+ */
+struct FixedCandlestick {
+  std::time_t time;
+  Pipettes open;
+  Pipettes close;
+  Pipettes high;
+  Pipettes low;
+  int volume;
+};
+
+/*
+ * Bid and ask candlesticks of one bar in pipettes
+ */
+struct FixedQuote {
+  FixedCandlestick bid;
+  FixedCandlestick ask;
+};
+
+/*
+ * Converts the prices of one instrument to and from pipettes.
+ * The scale is computed once, a conversion is a single multiplication or division.
+ */
+class PriceScale {
+ public:
+  PriceScale() = default;
+
+  /*
+   * @param price_decimals: decimals of one pipette, e.g., 5 for EUR_USD, 3 for USD_JPY
+   */
+  explicit PriceScale(int price_decimals);
+
+  /*
+   * pipettes of the instrument, pip_point + 1 decimals
+   */
+  explicit PriceScale(const Instrument &instrument);
+
+  [[nodiscard]]
+  int decimals() const noexcept;
+
+  /*
+   * return price rounded to the nearest pipette
+   */
+  [[nodiscard]]
+  Pipettes pipettes(double price) const noexcept {
+    return static_cast<Pipettes>(std::lround(price * scale_));
+  }
+
+  [[nodiscard]]
+  double price(Pipettes pipettes) const noexcept {
+    return static_cast<double>(pipettes) / scale_;
+  }
+
+  [[nodiscard]]
+  FixedCandlestick pipettes(const Candlestick &candlestick) const noexcept;
+
+  [[nodiscard]]
+  Candlestick candlestick(const FixedCandlestick &candlestick) const noexcept;
+
+ private:
+  int decimals_ = 0;
+  double scale_ = 1.0;
+};
+}  // namespace iridium::data
+
+#endif  // INCLUDE_IRIDIUM_PRICE_HPP_
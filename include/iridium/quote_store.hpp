@@ -0,0 +1,93 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef INCLUDE_IRIDIUM_QUOTE_STORE_HPP_
+#define INCLUDE_IRIDIUM_QUOTE_STORE_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <ctime>
+#include <istream>
+#include <optional>
+#include <vector>
+#include "data.hpp"
+#include "price.hpp"
+#include "storage.hpp"
+
+namespace iridium::data {
+/*
+ * Per-bar bid and ask OHLC held in columns.
+ * Bid prices are kept as candlestick columns, ask prices as the spread over the bid in pipettes,
+ * i.e. four int32 columns instead of four more double columns.
+ */
+class QuoteSeries {
+ public:
+  /*
+   * @param bid: bid bars sorted by ascending time
+   * @param ask: ask bars at the same times as bid
+   * @param freq
+   * @param price_decimals: decimals of one pipette, e.g., 5 for EUR_USD, 3 for USD_JPY
+   */
+  QuoteSeries(const CandleColumns &bid, const CandleColumns &ask, DataFreq freq, int price_decimals);
+
+  [[nodiscard]]
+  std::size_t size() const noexcept;
+
+  /*
+   * return the row of the bar at time, kNoBar if there is no bar at time
+   */
+  [[nodiscard]]
+  int row_index(std::time_t time) const;
+
+  [[nodiscard]]
+  Quote quote(std::size_t row) const;
+
+  /*
+   * bytes held by the columns
+   */
+  [[nodiscard]]
+  std::size_t memory_usage() const noexcept;
+
+ private:
+  PriceScale scale_;
+  CandleColumns bid_;
+  std::vector<Pipettes> open_spreads_;
+  std::vector<Pipettes> close_spreads_;
+  std::vector<Pipettes> high_spreads_;
+  std::vector<Pipettes> low_spreads_;
+  TimeIndex time_index_;
+};
+
+/*
+ * Streams sub-minute bid/ask ticks into M1 bid/ask bars.
+ * Every line is "time,bid,ask" with time in seconds, ticks arrive by ascending time,
+ * lines not starting with a digit, e.g., a header, are skipped.
+ * A line missing a field or with a field that does not parse throws std::runtime_error with its line number.
+ * The volume of a bar is its number of ticks.
+ */
+class QuoteTickReader {
+ public:
+  explicit QuoteTickReader(std::istream &input);
+
+  /*
+   * return the next M1 bar, std::nullopt once the input is exhausted
+   */
+  std::optional<Quote> Next();
+
+ private:
+  std::istream &input_;
+  std::optional<Quote> forming_bar_;
+  std::size_t lines_;
+};
+}  // namespace iridium::data
+
+#endif  // INCLUDE_IRIDIUM_QUOTE_STORE_HPP_
@@ -0,0 +1,73 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef INCLUDE_IRIDIUM_RANGE_QUERY_HPP_
+#define INCLUDE_IRIDIUM_RANGE_QUERY_HPP_
+
+#include <cstddef>
+#include <vector>
+#include "algorithm.hpp"
+
+namespace iridium::data {
+/*
+ * Rows per block of a RangeExtrema
+ */
+constexpr std::size_t kExtremaBlockRows = 64;
+
+/*
+ * Min/max pyramid over the high and low columns of a series.
+ * Highs and lows are split into blocks of kExtremaBlockRows rows, level k of the pyramid holds the
+ * max high and min low of every run of 2^k blocks. A range query reads two pyramid entries and
+ * scans at most two partial blocks, a first-touch query skips untouched runs of blocks from the
+ * top level down. The pyramid takes about 2 * log2(n / 64) / 64 doubles per row.
+ * The columns are not copied and must outlive the pyramid.
+ */
+class RangeExtrema {
+ public:
+  RangeExtrema(algorithm::ColumnView<double> highs, algorithm::ColumnView<double> lows);
+
+  [[nodiscard]]
+  std::size_t size() const noexcept;
+
+  /*
+   * return the max high of rows first ... last, first <= last < size()
+   */
+  [[nodiscard]]
+  double max_high(std::size_t first, std::size_t last) const;
+
+  /*
+   * return the min low of rows first ... last, first <= last < size()
+   */
+  [[nodiscard]]
+  double min_low(std::size_t first, std::size_t last) const;
+
+  /*
+   * return the first row from first on whose high is at least price, size() if there is none
+   */
+  [[nodiscard]]
+  std::size_t first_high_at_or_above(std::size_t first, double price) const;
+
+  /*
+   * return the first row from first on whose low is at most price, size() if there is none
+   */
+  [[nodiscard]]
+  std::size_t first_low_at_or_below(std::size_t first, double price) const;
+
+ private:
+  algorithm::ColumnView<double> highs_;
+  algorithm::ColumnView<double> lows_;
+  std::vector<std::vector<double>> high_levels_;
+  std::vector<std::vector<double>> low_levels_;
+};
+}  // namespace iridium::data
+
+#endif  // INCLUDE_IRIDIUM_RANGE_QUERY_HPP_
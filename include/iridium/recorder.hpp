@@ -0,0 +1,62 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef INCLUDE_IRIDIUM_RECORDER_HPP_
+#define INCLUDE_IRIDIUM_RECORDER_HPP_
+
+#include <ctime>
+#include <memory>
+#include <optional>
+#include <string>
+#include "data.hpp"
+
+namespace iridium::data {
+/*
+ * Records completed live candlesticks into a directory of native candle files, one file per
+ * instrument. The directory loads as TradeData with the kNative backend, so recorded data
+ * warm-starts live trading and feeds later backtests.
+ */
+class CandleRecorder {
+ public:
+  CandleRecorder(const std::string &directory, DataFreq freq);
+
+  [[nodiscard]]
+  DataFreq freq() const noexcept;
+
+  /*
+   * append completed candlesticks sorted by ascending time, already recorded ones are skipped
+   * return the number of recorded candlesticks
+   */
+  std::size_t Record(const std::string &instrument_name, const DataList &candlesticks);
+
+  /*
+   * return the time of the last recorded candlestick, std::nullopt if nothing is recorded
+   */
+  [[nodiscard]]
+  std::optional<std::time_t> last_time(const std::string &instrument_name) const;
+
+  /*
+   * return up to count last recorded candlesticks sorted by ascending time
+   */
+  [[nodiscard]]
+  std::shared_ptr<DataList> tail(const std::string &instrument_name, std::size_t count) const;
+
+ private:
+  std::string directory_;
+  DataFreq freq_;
+
+  [[nodiscard]]
+  std::string path(const std::string &instrument_name) const;
+};
+}  // namespace iridium::data
+
+#endif  // INCLUDE_IRIDIUM_RECORDER_HPP_
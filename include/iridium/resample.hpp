@@ -0,0 +1,78 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef INCLUDE_IRIDIUM_RESAMPLE_HPP_
+#define INCLUDE_IRIDIUM_RESAMPLE_HPP_
+
+#include <ctime>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "data.hpp"
+
+namespace iridium::data {
+/*
+ * Build freq candlesticks from M1 candlesticks.
+ * Bars start at trade_start + k * freq of each trading day, see calendar::trade_start_times_ptr,
+ * M1 candlesticks outside every trading day are dropped.
+ */
+class Resampler {
+ public:
+  /*
+   * @param freq: target frequency, M1 up to D
+   * @param trade_starts: trading day start times sorted by ascending time
+   */
+  Resampler(DataFreq freq, std::shared_ptr<const std::vector<std::time_t>> trade_starts);
+
+  [[nodiscard]]
+  DataFreq freq() const noexcept;
+
+  /*
+   * return the start time of the freq bar containing time, -1 if time is outside every trading day
+   */
+  [[nodiscard]]
+  std::time_t bar_time(std::time_t time) const noexcept;
+
+  /*
+   * Feed the next M1 candlestick, M1 candlesticks must arrive by ascending time.
+   * return the previously forming bar once candlestick starts a new bar
+   */
+  std::optional<Candlestick> Add(const Candlestick &candlestick);
+
+  /*
+   * return the bar still being formed, candlesticks of its remaining minutes have not arrived yet
+   */
+  [[nodiscard]]
+  const std::optional<Candlestick> &forming_bar() const noexcept;
+
+  /*
+   * Resample whole M1 columns, the trailing incomplete bar is kept
+   */
+  [[nodiscard]]
+  std::shared_ptr<CandleColumns> Resample(const CandleColumnsView &columns);
+
+ private:
+  DataFreq freq_;
+  std::shared_ptr<const std::vector<std::time_t>> trade_starts_;
+  mutable std::size_t day_;
+  std::optional<Candlestick> forming_bar_;
+};
+
+/*
+ * Trading day start times covering every M1 candlestick in times
+ */
+std::shared_ptr<const std::vector<std::time_t>>
+trade_start_times(const algorithm::ColumnView<std::time_t> &times, const std::string &region);
+}  // namespace iridium::data
+
+#endif  // INCLUDE_IRIDIUM_RESAMPLE_HPP_
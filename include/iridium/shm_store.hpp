@@ -0,0 +1,64 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef INCLUDE_IRIDIUM_SHM_STORE_HPP_
+#define INCLUDE_IRIDIUM_SHM_STORE_HPP_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "data.hpp"
+#include "storage.hpp"
+
+namespace iridium::data {
+/*
+ * POSIX shared memory object of one instrument/frequency, e.g., /iridium_EUR_USD_M1 for prefix iridium
+ */
+std::string shm_segment_name(const std::string &prefix, const std::string &instrument_name, DataFreq freq);
+
+/*
+ * Publishes candle columns into POSIX shared memory objects laid out like native candle files,
+ * so every process attaching to them shares one copy of the decoded columns.
+ * Republishing replaces the object, processes already attached keep the previous columns.
+ * Every published object is unlinked when the publisher is destroyed.
+ */
+class ShmPublisher {
+ public:
+  explicit ShmPublisher(std::string prefix);
+
+  ShmPublisher(const ShmPublisher &) = delete;
+
+  ShmPublisher &operator=(const ShmPublisher &) = delete;
+
+  ~ShmPublisher();
+
+  void Publish(const std::string &instrument_name, DataFreq freq, const CandleColumns &columns);
+
+  /*
+   * names of the published objects
+   */
+  [[nodiscard]]
+  const std::vector<std::string> &segments() const noexcept;
+
+ private:
+  std::string prefix_;
+  std::vector<std::string> segments_;
+};
+
+/*
+ * Attach read-only and zero-copy to a published instrument/frequency
+ */
+std::shared_ptr<MappedCandleSeries>
+AttachShmSeries(const std::string &prefix, const std::string &instrument_name, DataFreq freq);
+}  // namespace iridium::data
+
+#endif  // INCLUDE_IRIDIUM_SHM_STORE_HPP_
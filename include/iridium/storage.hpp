@@ -0,0 +1,407 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef INCLUDE_IRIDIUM_STORAGE_HPP_
+#define INCLUDE_IRIDIUM_STORAGE_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <ctime>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "data.hpp"
+
+namespace iridium::data {
+/*
+ * Row index reported when there is no candlestick at the requested time
+ */
+constexpr int kNoBar = -1;
+
+/*
+ * Time to row lookup for candlesticks sorted by ascending time.
+ * Bars sit on the calendar::Clock grid, trade start + k * freq, so every bar time is a whole
+ * number of grid steps, the frequency up to H1 and H1 above it to follow daylight saving shifts,
+ * from the first bar. A presence bitmap over the grid answers a lookup with a bit test and
+ * the row with a popcount from per-word ranks, missing bars never search.
+ * Rows are also split into runs of consecutive bars one frequency stride apart. Runs only break
+ * at weekends, holidays and missing bars, a lookup falls back to searching them when the times
+ * are off the grid.
+ */
+class TimeIndex {
+ public:
+  TimeIndex() = default;
+
+  TimeIndex(const algorithm::ColumnView<std::time_t> &times, DataFreq freq);
+
+  /*
+   * return the row of the candlestick at time, kNoBar if there is none
+   */
+  [[nodiscard]]
+  int row(std::time_t time) const noexcept;
+
+  [[nodiscard]]
+  bool contains(std::time_t time) const noexcept;
+
+  /*
+   * index times sorted by ascending time after the last indexed one as the following rows,
+   * only the runs and bitmap words past the previous last row are touched
+   */
+  void Append(const algorithm::ColumnView<std::time_t> &times);
+
+  [[nodiscard]]
+  std::size_t run_count() const noexcept;
+
+  /*
+   * return true if lookups use the presence bitmap
+   */
+  [[nodiscard]]
+  bool has_bitmap() const noexcept;
+
+  /*
+   * bytes held by the runs and the presence bitmap
+   */
+  [[nodiscard]]
+  std::size_t memory_usage() const noexcept;
+
+ private:
+  std::time_t freq_ = DataFreq::m1;
+  std::size_t size_ = 0;
+  std::vector<std::time_t> run_times_;
+  std::vector<std::size_t> run_rows_;
+  std::time_t origin_ = 0;
+  std::time_t step_ = 0;
+  std::vector<std::uint64_t> present_;
+  std::vector<std::uint32_t> ranks_;
+
+  [[nodiscard]]
+  int run_row(std::time_t time) const noexcept;
+};
+
+/*
+ * Candlestick rows of one instrument/frequency sorted by ascending time
+ */
+class CandleSeries {
+ public:
+  virtual ~CandleSeries() = default;
+
+  [[nodiscard]]
+  virtual std::size_t size() const = 0;
+
+  /*
+   * return the row index of the candlestick at time, kNoBar if there is no candlestick at time
+   */
+  [[nodiscard]]
+  virtual int row_index(std::time_t time) const = 0;
+
+  [[nodiscard]]
+  bool has_bar(std::time_t time) const {
+    return row_index(time) != kNoBar;
+  }
+
+  [[nodiscard]]
+  virtual HistoryWindow window(std::size_t first, std::size_t count) const = 0;
+
+  /*
+   * series are immutable after construction and safe to read from several threads,
+   * return false if reads still serialize on a lock
+   */
+  [[nodiscard]]
+  virtual bool lock_free() const noexcept { return true; }
+
+  /*
+   * return false if rows are read from disk per query instead of held in memory or memory mapped
+   */
+  [[nodiscard]]
+  virtual bool in_memory() const { return true; }
+};
+
+/*
+ * Series served from candlestick columns held in memory
+ */
+class ColumnSeries : public CandleSeries {
+ public:
+  ColumnSeries(std::shared_ptr<const CandleColumns> columns, DataFreq freq);
+
+  [[nodiscard]]
+  std::size_t size() const override;
+
+  [[nodiscard]]
+  int row_index(std::time_t time) const override;
+
+  [[nodiscard]]
+  HistoryWindow window(std::size_t first, std::size_t count) const override;
+
+  [[nodiscard]]
+  const std::shared_ptr<const CandleColumns> &columns() const noexcept;
+
+ private:
+  std::shared_ptr<const CandleColumns> columns_;
+  TimeIndex time_index_;
+};
+
+/*
+ * Series whose underlying series is created on first access, e.g., opened and time indexed
+ * only once a run touches it
+ */
+class LazySeries : public CandleSeries {
+ public:
+  explicit LazySeries(std::function<std::shared_ptr<CandleSeries>()> open);
+
+  [[nodiscard]]
+  std::size_t size() const override;
+
+  [[nodiscard]]
+  int row_index(std::time_t time) const override;
+
+  [[nodiscard]]
+  HistoryWindow window(std::size_t first, std::size_t count) const override;
+
+  /*
+   * false, the first access opens the series under a lock
+   */
+  [[nodiscard]]
+  bool lock_free() const noexcept override;
+
+  /*
+   * opens the series
+   */
+  [[nodiscard]]
+  bool in_memory() const override;
+
+  [[nodiscard]]
+  bool opened() const noexcept;
+
+ private:
+  std::function<std::shared_ptr<CandleSeries>()> open_;
+  mutable std::once_flag once_;
+  mutable std::shared_ptr<CandleSeries> series_;
+  mutable std::atomic<bool> opened_;
+
+  const CandleSeries &series() const;
+};
+
+/*
+ * Rows per cached chunk
+ */
+constexpr std::size_t kChunkRows = 4096;
+
+/*
+ * LRU cache of column chunks shared by series, least recently used chunks are evicted once
+ * the cached bytes exceed the budget. Windows keep their chunks alive after eviction.
+ */
+class ChunkCache {
+ public:
+  using Loader = std::function<std::shared_ptr<const CandleColumns>()>;
+
+  explicit ChunkCache(std::size_t budget_bytes);
+
+  /*
+   * return the cached chunk, load and cache it on a miss
+   * @param series_id: ChunkCache::NextSeriesId of the series owning the chunk
+   * @param chunk: chunk index in the series
+   * @param load
+   */
+  std::shared_ptr<const CandleColumns> Get(std::uint64_t series_id, std::size_t chunk, const Loader &load);
+
+  [[nodiscard]]
+  std::size_t budget_bytes() const noexcept;
+
+  [[nodiscard]]
+  std::size_t cached_bytes() const;
+
+  [[nodiscard]]
+  std::size_t hits() const;
+
+  [[nodiscard]]
+  std::size_t misses() const;
+
+  static std::uint64_t NextSeriesId();
+
+ private:
+  using Key = std::pair<std::uint64_t, std::size_t>;
+
+  struct Entry {
+    Key key;
+    std::shared_ptr<const CandleColumns> columns;
+    std::size_t bytes;
+  };
+
+  std::size_t budget_bytes_;
+  std::size_t cached_bytes_;
+  std::size_t hits_;
+  std::size_t misses_;
+  std::list<Entry> entries_;
+  std::map<Key, std::list<Entry>::iterator> index_;
+  mutable std::mutex mutex_;
+};
+
+/*
+ * Native candle file layout:
+ * a 128 bytes header followed by the time, open, close, high, low and volume columns.
+ * Every column holds capacity rows and starts at a 64 bytes aligned offset, the first
+ * rows entries are valid and sorted by ascending time.
+ */
+struct CandleFileHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t freq;
+  std::uint64_t rows;
+  std::uint64_t capacity;
+  char instrument[16];
+  std::uint64_t column_offsets[6];
+  std::uint8_t reserved[32];
+};
+
+static_assert(sizeof(CandleFileHeader) == 128, "Candle file header must be 128 bytes");
+
+constexpr char kCandleFileMagic[8] = {'I', 'R', 'D', 'C', 'N', 'D', 'L', '\0'};
+
+constexpr std::uint32_t kCandleFileVersion = 1;
+
+constexpr std::uint64_t kCandleFileAlignment = 64;
+
+constexpr auto kCandleFileExtension = ".candles";
+
+/*
+ * return the header of a native candle file holding rows of capacity rows, column offsets included
+ */
+CandleFileHeader candle_file_header(
+    const std::string &instrument_name,
+    DataFreq freq,
+    std::size_t rows,
+    std::size_t capacity);
+
+/*
+ * return the bytes of a native candle file with header, i.e. up to the end of its last column
+ */
+std::size_t candle_file_size(const CandleFileHeader &header) noexcept;
+
+/*
+ * Copy the header and columns into a buffer of candle_file_size(header) bytes, the header last
+ */
+void CopyCandleFile(const CandleFileHeader &header, const CandleColumns &columns, std::uint8_t *data);
+
+/*
+ * Read-only memory mapping of a whole file
+ */
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string &path);
+
+  /*
+   * map the whole of an open file descriptor, the descriptor stays owned by the caller
+   * @param fd
+   * @param name: reported in errors
+   */
+  MappedFile(int fd, const std::string &name);
+
+  MappedFile(const MappedFile &) = delete;
+
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  ~MappedFile();
+
+  [[nodiscard]]
+  const std::uint8_t *data() const noexcept;
+
+  [[nodiscard]]
+  std::size_t size() const noexcept;
+
+ private:
+  const std::uint8_t *data_;
+  std::size_t size_;
+};
+
+/*
+ * Series served straight from a memory mapped native candle file
+ */
+class MappedCandleSeries : public CandleSeries {
+ public:
+  explicit MappedCandleSeries(const std::string &path);
+
+  /*
+   * @param file: mapping holding the native candle layout, e.g., a shared memory segment
+   * @param name: reported in errors
+   */
+  MappedCandleSeries(std::shared_ptr<MappedFile> file, const std::string &name);
+
+  [[nodiscard]]
+  std::size_t size() const override;
+
+  [[nodiscard]]
+  int row_index(std::time_t time) const override;
+
+  [[nodiscard]]
+  HistoryWindow window(std::size_t first, std::size_t count) const override;
+
+  [[nodiscard]]
+  std::string instrument_name() const;
+
+  [[nodiscard]]
+  DataFreq freq() const noexcept;
+
+  [[nodiscard]]
+  const CandleColumnsView &columns() const noexcept;
+
+ private:
+  std::shared_ptr<MappedFile> file_;
+  const CandleFileHeader *header_;
+  CandleColumnsView columns_;
+  TimeIndex time_index_;
+};
+
+/*
+ * e.g., EUR_USD_M1.candles
+ */
+std::string candle_file_name(const std::string &instrument_name, DataFreq freq);
+
+/*
+ * @param path
+ * @param instrument_name
+ * @param freq
+ * @param columns: candlesticks sorted by ascending time
+ * @param capacity: rows reserved for later appends, at least the number of candlesticks
+ */
+void WriteCandleFile(
+    const std::string &path,
+    const std::string &instrument_name,
+    DataFreq freq,
+    const CandleColumns &columns,
+    std::size_t capacity = 0);
+
+/*
+ * Rows reserved by AppendCandleFile when it creates a file
+ */
+constexpr std::size_t kCandleFileMinCapacity = 1024;
+
+/*
+ * Append the candlesticks newer than the last stored one to a native candle file, the file is
+ * created if missing. Rows go into the spare capacity and the header row count is written last,
+ * so readers mapping the file meanwhile see either the old or the new rows. A full file is
+ * rewritten with twice the capacity and renamed over the old one.
+ * return the number of appended rows
+ */
+std::size_t AppendCandleFile(
+    const std::string &path,
+    const std::string &instrument_name,
+    DataFreq freq,
+    const CandleColumns &columns);
+}  // namespace iridium::data
+
+#endif  // INCLUDE_IRIDIUM_STORAGE_HPP_
@@ -0,0 +1,116 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef INCLUDE_IRIDIUM_STREAM_STORE_HPP_
+#define INCLUDE_IRIDIUM_STREAM_STORE_HPP_
+
+#include <cstddef>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include "H5Cpp.h"
+#include "data.hpp"
+#include "hdf5_store.hpp"
+#include "storage.hpp"
+
+namespace iridium::data {
+/*
+ * Series streaming an HDF5 dataset through a sliding buffer of lookback + block_rows rows.
+ * Walking forward in time, a lookup past the buffer keeps its last lookback rows and reads the next
+ * block_rows rows in one sequential read, so memory is bounded by the buffer and not by the history.
+ * Lookups before the buffer or past it search the dataset times for the row to seek to, see FindRow.
+ * Windows of up to lookback + 1 rows ending at the last looked up row
+ * share the buffer, larger windows are read on their own.
+ * Windows keep their buffer alive after it slides. Reads serialize on a lock.
+ */
+class StreamingSeries : public CandleSeries {
+ public:
+  /*
+   * @param dataset
+   * @param freq
+   * @param lookback: rows kept before the last looked up row
+   * @param block_rows: rows read ahead at once
+   * @param rows: rows of the dataset the series covers, every row by default
+   */
+  StreamingSeries(
+      std::shared_ptr<H5::DataSet> dataset,
+      DataFreq freq,
+      std::size_t lookback,
+      std::size_t block_rows = kStreamBlockRows,
+      std::optional<RowRange> rows = std::nullopt);
+
+  [[nodiscard]]
+  std::size_t size() const override;
+
+  [[nodiscard]]
+  int row_index(std::time_t time) const override;
+
+  [[nodiscard]]
+  HistoryWindow window(std::size_t first, std::size_t count) const override;
+
+  [[nodiscard]]
+  bool lock_free() const noexcept override;
+
+  [[nodiscard]]
+  bool in_memory() const override;
+
+  /*
+   * rows currently buffered
+   */
+  [[nodiscard]]
+  std::size_t buffered_rows() const;
+
+  /*
+   * number of reads of the dataset so far
+   */
+  [[nodiscard]]
+  std::size_t reads() const;
+
+ private:
+  std::shared_ptr<H5::DataSet> dataset_;
+  DataFreq freq_;
+  std::size_t lookback_;
+  std::size_t block_rows_;
+  std::size_t first_row_;
+  std::size_t size_;
+  std::time_t first_time_;
+  mutable std::mutex mutex_;
+  mutable std::shared_ptr<const CandleColumns> buffer_;
+  mutable std::size_t buffer_first_;
+  mutable TimeIndex buffer_index_;
+  mutable std::size_t reads_;
+
+  /*
+   * return the first row with a time not before time, size() if there is none
+   */
+  [[nodiscard]]
+  std::size_t find_row(std::time_t time) const;
+
+  [[nodiscard]]
+  std::size_t buffer_end() const noexcept;
+
+  /*
+   * buffer rows first ... first + lookback + block_rows - 1, reusing the buffered rows among them
+   */
+  void Load(std::size_t first) const;
+
+  /*
+   * read rows first ... first + count - 1 sorted by ascending time
+   */
+  [[nodiscard]]
+  std::shared_ptr<CandleColumns> ReadRows(std::size_t first, std::size_t count) const;
+};
+}  // namespace iridium::data
+
+#endif  // INCLUDE_IRIDIUM_STREAM_STORE_HPP_
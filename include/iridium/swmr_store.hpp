@@ -0,0 +1,104 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef INCLUDE_IRIDIUM_SWMR_STORE_HPP_
+#define INCLUDE_IRIDIUM_SWMR_STORE_HPP_
+
+#include <ctime>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "data.hpp"
+#include "hdf5_store.hpp"
+#include "storage.hpp"
+
+namespace iridium::data {
+/*
+ * Single writer of an HDF5 history file that backtests keep reading with TradeDataOptions::swmr_read.
+ * Datasets it creates are stored by ascending time, so appends extend them in place and readers only
+ * pick up the new rows, see TradeData::Refresh. HDF5 cannot create datasets once SWMR writing started,
+ * every instrument/frequency to append is created at construction. The file needs the latest HDF5
+ * file format, history files written by other tools are not appendable.
+ */
+class Hdf5Appender {
+ public:
+  Hdf5Appender(
+      const std::string &file_name,
+      const InstrumentList &instruments,
+      const std::vector<DataFreq> &freqs,
+      const ChunkLayout &layout = ChunkLayout());
+
+  Hdf5Appender(const Hdf5Appender &) = delete;
+
+  Hdf5Appender &operator=(const Hdf5Appender &) = delete;
+
+  ~Hdf5Appender();
+
+  /*
+   * append completed candlesticks sorted by ascending time, already stored ones are skipped
+   * return the number of appended candlesticks
+   */
+  std::size_t Append(const std::string &instrument_name, DataFreq freq, const DataList &candlesticks);
+
+  /*
+   * return the time of the last stored candlestick, std::nullopt if nothing is stored
+   */
+  [[nodiscard]]
+  std::optional<std::time_t> last_time(const std::string &instrument_name, DataFreq freq) const;
+
+ private:
+  struct AppendedDataSet {
+    std::shared_ptr<H5::DataSet> dataset;
+    std::optional<std::time_t> last_time;
+  };
+
+  std::unique_ptr<H5::H5File> file_;
+  std::unordered_map<std::string, AppendedDataSet> datasets_;
+};
+
+/*
+ * Series of an HDF5 dataset opened for SWMR reading, held in memory like ColumnSeries.
+ * Refresh reads the rows appended since and grows the columns in place while their capacity lasts,
+ * or moves them to columns of twice the size, so windows handed out before stay valid either way.
+ * Refresh must not run concurrently with reads of the series.
+ */
+class SwmrSeries : public CandleSeries {
+ public:
+  SwmrSeries(std::shared_ptr<H5::DataSet> dataset, DataFreq freq);
+
+  ~SwmrSeries() override;
+
+  [[nodiscard]]
+  std::size_t size() const override;
+
+  [[nodiscard]]
+  int row_index(std::time_t time) const override;
+
+  [[nodiscard]]
+  HistoryWindow window(std::size_t first, std::size_t count) const override;
+
+  /*
+   * read the rows appended since the last refresh, return how many
+   */
+  std::size_t Refresh();
+
+ private:
+  std::shared_ptr<H5::DataSet> dataset_;
+  std::shared_ptr<CandleColumns> columns_;
+  TimeIndex time_index_;
+};
+}  // namespace iridium::data
+
+#endif  // INCLUDE_IRIDIUM_SWMR_STORE_HPP_
@@ -16,6 +16,7 @@ limitations under the License.
 #include <string>
 #include <ctime>
 #include <memory>
+#include <optional>
 #include <iostream>
 #include <vector>
 #include <boost/uuid/uuid_generators.hpp>
@@ -50,6 +51,15 @@ class Trade {
   [[nodiscard]]
   const std::shared_ptr<Instrument> &instrument_ptr() const noexcept;
 
+  /*
+   * dense id of the instrument in the market snapshots the account processes it with,
+   * std::nullopt until the account first looks it up
+   */
+  [[nodiscard]]
+  std::optional<int> instrument_id() const noexcept;
+
+  void set_instrument_id(int id) noexcept;
+
   [[nodiscard]]
   double price() const noexcept;
 
@@ -125,6 +135,7 @@ class Trade {
  private:
   std::string trade_id_;
   std::shared_ptr<Instrument> instrument_ptr_;
+  std::optional<int> instrument_id_;
   double price_;
   TradeState state_;
   std::time_t open_time_;
@@ -39,10 +39,10 @@ iridium::Oanda::open_position_size(const std::string &instrument) const {
   return 0;
 }
 
-std::optional<double> iridium::Oanda::net_asset_value(const iridium::data::TickDataMap &tick_data_map) const {
+std::optional<double> iridium::Oanda::net_asset_value(const iridium::data::MarketSnapshot &snapshot) const {
   return account_details_->nav;
 }
-std::optional<double> iridium::Oanda::margin_used(const iridium::data::TickDataMap &tick_data_map) const {
+std::optional<double> iridium::Oanda::margin_used(const iridium::data::MarketSnapshot &snapshot) const {
   return account_details_->margin_used;
 }
 
@@ -90,7 +90,8 @@ void iridium::Oanda::CreateLimitOrder(
 void iridium::Oanda::CloserPosition(const std::string &instrument,
                                     double rate,
                                     double current_price,
-                                    std::time_t time) {
+                                    std::time_t time,
+                                    const iridium::data::MarketSnapshot &snapshot) {
   auto trades = account_details_->trades;
   for (const auto &trade : *trades) {
     if ((trade->instrument == instrument)
@@ -151,11 +152,15 @@ iridium::Oanda::Oanda(
 std::unique_ptr<iridium::data::DataList> iridium::Oanda::instrument_data(
     const std::string &instrument_name,
     int count,
-    iridium::data::DataFreq freq) const {
+    iridium::data::DataFreq freq,
+    std::optional<std::time_t> from) const {
   auto path = "/instruments/" + instrument_name + "/candles";
   std::map<std::string, std::string> query_params;
   query_params.insert_or_assign("count", std::to_string(count));
   query_params.insert_or_assign("granularity", iridium::data::DataFreqToString(freq));
+  if (from.has_value()) {
+    query_params.insert_or_assign("from", std::to_string(from.value()));
+  }
   std::map<std::string, std::string> headers;
   headers.insert_or_assign("Accept-Datetime-Format", "UNIX");
   auto resp = SendRequest(path, Poco::Net::HTTPRequest::HTTP_GET, query_params, std::nullopt, headers);
@@ -269,20 +274,21 @@ void iridium::Oanda::FetchAccountDetails() {
 }
 
 
-std::tuple<std::unique_ptr<iridium::data::DataListMap>, std::unique_ptr<iridium::data::TickDataMap>>
+std::tuple<std::unique_ptr<iridium::data::DataListMap>, std::unique_ptr<iridium::data::MarketSnapshot>>
 iridium::Oanda::trade_data(
     const iridium::InstrumentList &instruments,
     int count,
     iridium::data::DataFreq freq) const {
   auto hist_data_map = std::make_unique<iridium::data::DataListMap>();
-  auto tick_data_map = std::make_unique<iridium::data::TickDataMap>();
-  for (const auto &instrument : instruments) {
+  auto snapshot = std::make_unique<iridium::data::MarketSnapshot>(instruments);
+  for (std::size_t id = 0; id < instruments.size(); ++id) {
+    const auto &instrument = instruments[id];
     auto data = instrument_data(instrument->name(), count, freq);
-    tick_data_map->insert({instrument->name(), data->back()});
+    snapshot->Set(static_cast<int>(id), data->back());
     data->pop_back();
     hist_data_map->insert({instrument->name(), std::move(data)});
   }
-  return std::make_tuple(std::move(hist_data_map), std::move(tick_data_map));
+  return std::make_tuple(std::move(hist_data_map), std::move(snapshot));
 }
 
 std::unique_ptr<iridium::Oanda::Resp> iridium::Oanda::SendRequest(
@@ -343,7 +349,7 @@ void iridium::Oanda::CloseTrade(const std::string &trade_id) {
   logger_->info("close a trade, status code: {0}, resp: {1}", path, resp->status, resp->body);
 }
 
-std::tuple<std::shared_ptr<iridium::data::DataListMap>, std::shared_ptr<iridium::data::TickDataMap>>
+std::tuple<std::shared_ptr<iridium::data::DataListMap>, std::shared_ptr<iridium::data::MarketSnapshot>>
 iridium::trade_data_thread_pool(
     iridium::Oanda::Env env,
     const std::string &token,
@@ -352,18 +358,32 @@ iridium::trade_data_thread_pool(
     int count,
     iridium::data::DataFreq freq) {
   auto hist_data_map = std::make_shared<iridium::data::DataListMap>();
-  auto tick_data_map = std::make_shared<iridium::data::TickDataMap>();
+  auto snapshot = std::make_shared<iridium::data::MarketSnapshot>(instruments);
+  // every task writes its own slots, the map and the presence bitmask are filled after join
+  std::vector<std::optional<iridium::data::Candlestick>> ticks(instruments.size());
+  std::vector<std::shared_ptr<iridium::data::DataList>> histories(instruments.size());
   boost::asio::thread_pool pool(instruments.size());
-  for (const auto &instrument : instruments) {
-    boost::asio::post(pool, [env, token, account_id, instrument, count, freq, tick_data_map, hist_data_map]() {
+  for (std::size_t id = 0; id < instruments.size(); ++id) {
+    const auto &instrument = instruments[id];
+    auto &tick = ticks[id];
+    auto &history = histories[id];
+    boost::asio::post(pool, [env, token, account_id, instrument, count, freq, &tick, &history]() {
       auto client = std::make_unique<iridium::Oanda>(env, token, account_id);
       auto data = client->instrument_data(instrument->name(), count, freq);
-      tick_data_map->insert({instrument->name(), data->back()});
+      tick = data->back();
       data->pop_back();
-      hist_data_map->insert({instrument->name(), std::move(data)});
+      history = std::move(data);
     });
   }
   pool.join();
-  return std::make_tuple(hist_data_map, tick_data_map);
+  for (std::size_t id = 0; id < ticks.size(); ++id) {
+    if (ticks[id]) {
+      snapshot->Set(static_cast<int>(id), *ticks[id]);
+    }
+    if (histories[id]) {
+      hist_data_map->insert({instruments[id]->name(), std::move(histories[id])});
+    }
+  }
+  return std::make_tuple(hist_data_map, snapshot);
 }
 
@@ -54,11 +54,11 @@ class Oanda : public Account {
 
   [[nodiscard]]
   std::optional<double>
-  net_asset_value(const data::TickDataMap &tick_data_map) const override;
+  net_asset_value(const data::MarketSnapshot &snapshot) const override;
 
   [[nodiscard]]
   std::optional<double>
-  margin_used(const data::TickDataMap &tick_data_map) const override;
+  margin_used(const data::MarketSnapshot &snapshot) const override;
 
   void CreateLimitOrder(
       std::time_t create_time,
@@ -73,7 +73,8 @@ class Oanda : public Account {
       const std::string &instrument,
       double rate,
       double current_price,
-      std::time_t time) override;
+      std::time_t time,
+      const data::MarketSnapshot &snapshot) override;
 
   void UpdateTradeStopLossPrice(
       const std::shared_ptr<Trade> &trade_ptr,
@@ -143,12 +144,17 @@ class Oanda : public Account {
       const std::string &token,
       const std::string &account_id);
 
+  /*
+   * return the latest count candlesticks, the last one still forming,
+   * or count candlesticks starting at from if given
+   */
   [[nodiscard]]
   std::unique_ptr<iridium::data::DataList>
   instrument_data(
       const std::string &instrument_name,
       int count,
-      iridium::data::DataFreq freq) const;
+      iridium::data::DataFreq freq,
+      std::optional<std::time_t> from = std::nullopt) const;
 
   [[nodiscard]]
   std::unique_ptr<std::map<std::string, double>>
@@ -167,7 +173,7 @@ class Oanda : public Account {
   static const std::string kLiveBaseURL;
 
   [[nodiscard]]
-  std::tuple<std::unique_ptr<iridium::data::DataListMap>, std::unique_ptr<iridium::data::TickDataMap>>
+  std::tuple<std::unique_ptr<iridium::data::DataListMap>, std::unique_ptr<iridium::data::MarketSnapshot>>
   trade_data(
       const InstrumentList &instruments,
       int count,
@@ -183,7 +189,7 @@ class Oanda : public Account {
   void CloseTrade(const std::string &trade_id);
 };
 
-std::tuple<std::shared_ptr<iridium::data::DataListMap>, std::shared_ptr<iridium::data::TickDataMap>>
+std::tuple<std::shared_ptr<iridium::data::DataListMap>, std::shared_ptr<iridium::data::MarketSnapshot>>
 trade_data_thread_pool(
     iridium::Oanda::Env env,
     const std::string &token,
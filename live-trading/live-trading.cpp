@@ -2,7 +2,10 @@
 // Created by Evan Su on 13/3/21.
 //
 
+#include <algorithm>
 #include <iostream>
+#include <iterator>
+#include <map>
 #include <thread>
 #include <chrono>
 #include <ctime>
@@ -11,6 +14,7 @@
 #include <Poco/Util/OptionSet.h>
 #include <Poco/Util/HelpFormatter.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
+#include <iridium/recorder.hpp>
 #include "apiclient.hpp"
 #include "../strategy/include/simulate.hpp"
 
@@ -56,6 +60,13 @@ class IridiumLive: public Application {
             .repeatable(false)
             .argument("account id")
             .callback(OptionCallback<IridiumLive>(this, &IridiumLive::HandleAccount)));
+
+    options.addOption(
+        Option("store", "s", "Specify a directory recording completed candles, history warm-starts from it.")
+            .required(false)
+            .repeatable(false)
+            .argument("directory")
+            .callback(OptionCallback<IridiumLive>(this, &IridiumLive::HandleStore)));
   }
 
   void HandleHelp(const std::string& name, const std::string& value) {
@@ -83,6 +94,92 @@ class IridiumLive: public Application {
     account_id_ = value;
   }
 
+  void HandleStore(const std::string& name, const std::string& value) {
+    store_ = value;
+  }
+
+  /*
+   * Fetch the forming candle and the candles completed since the last known one on one client per
+   * instrument, record the completed ones and keep the last count of them per instrument in history.
+   * Gaps longer than one request are fetched in pages starting after the last known candle, and a
+   * history shorter than count, e.g. a short recorded tail, is backfilled with the latest count candles.
+   */
+  std::tuple<std::shared_ptr<iridium::data::DataListMap>, std::shared_ptr<iridium::data::MarketSnapshot>>
+  RecordedTradeData(
+      iridium::data::CandleRecorder &recorder,
+      const iridium::InstrumentList &instruments,
+      std::map<std::string, iridium::data::DataList> &history,
+      std::size_t count) {
+    // Oanda returns at most 5000 candles per request
+    const auto kMaxCandleCount = 5000;
+    auto logger = iridium::logger();
+    auto hist_data_map = std::make_shared<iridium::data::DataListMap>();
+    auto snapshot = std::make_shared<iridium::data::MarketSnapshot>(instruments);
+    auto now = std::time(nullptr);
+    auto freq = recorder.freq();
+    // every task writes its own slot, recording and history are updated after join
+    std::vector<std::unique_ptr<iridium::data::DataList>> fetched(instruments.size());
+    boost::asio::thread_pool pool(instruments.size());
+    for (std::size_t id = 0; id < instruments.size(); ++id) {
+      const auto &name = instruments[id]->name();
+      const auto &data_list = history[name];
+      auto last_time = data_list.empty() ? std::nullopt : std::optional<std::time_t>(data_list.back().time);
+      auto backfill = data_list.size() < count;
+      auto &data = fetched[id];
+      boost::asio::post(pool, [this, name, last_time, backfill, count, now, freq, &data, logger]() {
+        auto client = std::make_unique<iridium::Oanda>(env_, token_, account_id_);
+        auto pages = std::make_unique<iridium::data::DataList>();
+        auto from = last_time.has_value() ? last_time.value() + freq : now;
+        while (last_time.has_value() && (now - from) / freq + 1 > kMaxCandleCount) {
+          auto page = client->instrument_data(name, kMaxCandleCount, freq, from);
+          if (page->empty()) {
+            logger->warn("{} candles missing after {}", name, TimeToLocalTimeString(from));
+            break;
+          }
+          pages->insert(pages->end(), page->begin(), page->end());
+          from = page->back().time + freq;
+        }
+        auto missing = last_time.has_value() ? static_cast<int>((now - from) / freq) + 1 : static_cast<int>(count) + 1;
+        if (backfill) {
+          missing = std::max(missing, static_cast<int>(count) + 1);
+        }
+        data = client->instrument_data(name, std::clamp(missing, 2, kMaxCandleCount), freq);
+        if (!data->empty()) {
+          // pages may reach the latest candles, keep them from the latest request
+          auto first_time = data->front().time;
+          pages->erase(
+              std::find_if(pages->begin(), pages->end(), [first_time](const auto &c) { return c.time >= first_time; }),
+              pages->end());
+          data->insert(data->begin(), pages->begin(), pages->end());
+        }
+      });
+    }
+    pool.join();
+    for (std::size_t id = 0; id < instruments.size(); ++id) {
+      auto &data = fetched[id];
+      if (!data || data->empty()) {
+        continue;
+      }
+      const auto &name = instruments[id]->name();
+      auto &data_list = history[name];
+      snapshot->Set(static_cast<int>(id), data->back());
+      data->pop_back();
+      recorder.Record(name, *data);
+      // backfilled candles may precede the known ones, merge by time
+      iridium::data::DataList merged;
+      merged.reserve(data_list.size() + data->size());
+      std::set_union(
+          data_list.begin(), data_list.end(), data->begin(), data->end(), std::back_inserter(merged),
+          [](const auto &lhs, const auto &rhs) { return lhs.time < rhs.time; });
+      data_list.swap(merged);
+      if (data_list.size() > count) {
+        data_list.erase(data_list.begin(), data_list.end() - static_cast<std::ptrdiff_t>(count));
+      }
+      hist_data_map->insert({name, std::make_shared<iridium::data::DataList>(data_list)});
+    }
+    return std::make_tuple(hist_data_map, snapshot);
+  }
+
   int main(const std::vector<std::string>& args) {
     // Logging
     auto logger = iridium::logger();
@@ -98,19 +195,45 @@ class IridiumLive: public Application {
                                              "SGD_JPY",
                                              "USD_CAD", "USD_JPY", "USD_SGD"});
       const auto kHistDataCount = 90;
+      const auto kDataFreq = iridium::data::DataFreq::m15;
 
       auto client = std::make_shared<iridium::Oanda>(env_, token_, account_id_);
+      // warm start the history windows from the recorded candles
+      std::unique_ptr<iridium::data::CandleRecorder> recorder;
+      std::map<std::string, iridium::data::DataList> history;
+      if (!store_.empty()) {
+        recorder = std::make_unique<iridium::data::CandleRecorder>(store_, kDataFreq);
+        for (const auto &instrument : *instruments) {
+          history[instrument->name()] = *recorder->tail(instrument->name(), kHistDataCount);
+        }
+        logger->info("recording candles to {}", store_);
+      }
       while (true) {
-        auto [hist_data_map, tick_data_map] = iridium::trade_data_thread_pool(
-            env_, token_, account_id_, *instruments, kHistDataCount + 1, iridium::data::DataFreq::m15);
+        std::shared_ptr<iridium::data::DataListMap> hist_data_map;
+        std::shared_ptr<iridium::data::MarketSnapshot> snapshot;
+        if (recorder) {
+          std::tie(hist_data_map, snapshot) = RecordedTradeData(*recorder, *instruments, history, kHistDataCount);
+        } else {
+          std::tie(hist_data_map, snapshot) = iridium::trade_data_thread_pool(
+              env_, token_, account_id_, *instruments, kHistDataCount + 1, kDataFreq);
+        }
         auto spreads = client->spread(*instruments);
-        for (auto const &[name, data] : *tick_data_map) {
+        for (auto const &instrument : *instruments) {
+          const auto &name = instrument->name();
+          if (hist_data_map->count(name) == 0) {
+            continue;
+          }
           client->FetchAccountDetails();
+          auto id = snapshot->instrument_id(name);
+          if (!snapshot->has_data(id)) {
+            continue;
+          }
           SimulateTrade(
               name,
+              id,
               std::time(nullptr),
               *hist_data_map->at(name),
-              *tick_data_map,
+              *snapshot,
               client,
               spreads->at(name));
         }
@@ -130,6 +253,7 @@ class IridiumLive: public Application {
  private:
   std::string token_;
   std::string account_id_;
+  std::string store_;
   iridium::Oanda::Env env_;
 };
 
@@ -63,21 +63,21 @@ int iridium::SimulationAccount::open_position_size(const std::string &instrument
 }
 
 std::optional<double>
-iridium::SimulationAccount::net_asset_value(const iridium::data::TickDataMap &tick_data_map) const {
+iridium::SimulationAccount::net_asset_value(const iridium::data::MarketSnapshot &snapshot) const {
   auto net_asset_value = balance();
   auto open_trades = open_trades_ptr();
   for (const auto &trade : *open_trades) {
-    auto current_data = tick_data_map.at(trade->instrument_ptr()->name());
+    auto id = instrument_id(*trade, snapshot);
     auto quote = trade->instrument_ptr()->quote_name();
     auto acc_quote_rate = data::account_currency_rate(
         account_currency(),
         quote,
-        tick_data_map);
-    if (current_data.has_value() && acc_quote_rate.has_value()) {
+        snapshot);
+    if (snapshot.has_data(id) && acc_quote_rate.has_value()) {
       auto unrealized_profit_loss = CalculateUnrealizedProfitLoss(
           *trade,
           acc_quote_rate.value(),
-          current_data->close);
+          snapshot.candlestick(id).close);
       net_asset_value += unrealized_profit_loss;
     } else {
       return std::nullopt;
@@ -87,17 +87,17 @@ iridium::SimulationAccount::net_asset_value(const iridium::data::TickDataMap &ti
 }
 
 std::optional<double>
-iridium::SimulationAccount::margin_used(const iridium::data::TickDataMap &tick_data_map) const {
+iridium::SimulationAccount::margin_used(const iridium::data::MarketSnapshot &snapshot) const {
   auto margin_used = 0.00;
   auto open_trades = open_trades_ptr();
   for (const auto &trade : *open_trades) {
-    auto current_data = tick_data_map.at(trade->instrument_ptr()->name());
+    auto id = instrument_id(*trade, snapshot);
     auto base = trade->instrument_ptr()->base_name();
     auto acc_base_rate = data::account_currency_rate(
         account_currency(),
         base,
-        tick_data_map);
-    if (current_data.has_value() && acc_base_rate.has_value()) {
+        snapshot);
+    if (snapshot.has_data(id) && acc_base_rate.has_value()) {
       margin_used += CalculateMarginUsed(
           *trade,
           acc_base_rate.value(),
@@ -133,12 +133,11 @@ void iridium::SimulationAccount::CreateMarketOrder(
     const std::string &instrument,
     int units,
     double price,
+    const iridium::data::MarketSnapshot &snapshot,
     std::optional<double> take_profit_price,
     std::optional<double> stop_loss_price,
     std::optional<double> trailing_stop_loss_distance) {
-  auto spread_value = this->spread_ * pow(10, -pip_point(Instrument(instrument)));
-  auto ask = price + spread_value / 2.0;
-  auto bid = price - spread_value / 2.0;
+  auto[bid, ask] = fill_prices(instrument, snapshot.instrument_id(instrument), price, snapshot);
   auto order_price = units > 0 ? ask : bid;
   CreateLimitOrder(
       create_time,
@@ -154,10 +153,12 @@ void iridium::SimulationAccount::CloserPosition(
     const std::string &instrument,
     double acc_quote_rate,
     double current_price,
-    std::time_t time) {
+    std::time_t time,
+    const iridium::data::MarketSnapshot &snapshot) {
+  auto[bid, ask] = fill_prices(instrument, snapshot.instrument_id(instrument), current_price, snapshot);
   auto trades_ptr = open_trades_ptr(instrument);
   for (const auto &trade_ptr : *trades_ptr) {
-    CloseTrade(trade_ptr, acc_quote_rate, current_price, time);
+    CloseTrade(trade_ptr, acc_quote_rate, bid, ask, time);
   }
 }
 
@@ -205,6 +206,7 @@ iridium::SimulationAccount::SimulationAccount(
     capital_base_(capital_base),
     balance_(capital_base),
     spread_(spread),
+    spread_pipettes_(static_cast<data::Pipettes>(std::lround(spread * data::kPipettesPerPip))),
     trades_ptr_(std::make_shared<TradeList>()),
     orders_ptr_(std::make_shared<OrderList>()),
     logger_(iridium::logger()) {
@@ -220,9 +222,9 @@ std::string iridium::SimulationAccount::string() {
   return ss.str();
 }
 
-std::string iridium::SimulationAccount::summary(std::time_t tick, const iridium::data::TickDataMap &data_map) const {
-  auto nav = net_asset_value(data_map);
-  auto account_margin_used = margin_used(data_map);
+std::string iridium::SimulationAccount::summary(std::time_t tick, const iridium::data::MarketSnapshot &snapshot) const {
+  auto nav = net_asset_value(snapshot);
+  auto account_margin_used = margin_used(snapshot);
   if (nav.has_value() && account_margin_used.has_value()) {
     auto margin_available = iridium::CalculateMarginAvailable(nav.value(), account_margin_used.value());
     auto summary = ("time: " +  TimeToLocalTimeString(tick) +
@@ -238,13 +240,13 @@ std::string iridium::SimulationAccount::summary(std::time_t tick, const iridium:
 void
 iridium::SimulationAccount::ProcessOrders(
     std::time_t time,
-    const iridium::data::TickDataMap &tick_data_map) {
+    const iridium::data::MarketSnapshot &snapshot) {
   auto acc_pending_orders = pending_orders_ptr();
   for (const auto &order_ptr : *acc_pending_orders) {
     if (auto limit_order_ptr = std::dynamic_pointer_cast<LimitOrder>(order_ptr)) {
-      ProcessLimitOrder(limit_order_ptr, time, tick_data_map);
+      ProcessLimitOrder(limit_order_ptr, time, snapshot);
     } else if (auto price_trigger_order_ptr = std::dynamic_pointer_cast<TriggerOrder>(order_ptr)) {
-      ProcessTriggerOrder(price_trigger_order_ptr, time, tick_data_map);
+      ProcessTriggerOrder(price_trigger_order_ptr, time, snapshot);
     }
   }
 }
@@ -300,36 +302,65 @@ iridium::SimulationAccount::acc_trade_ptr(
   return trades_ptr->front();
 }
 
+double iridium::SimulationAccount::half_spread(const std::string &instrument) {
+  auto it = half_spreads_.find(instrument);
+  if (it == half_spreads_.end()) {
+    it = half_spreads_.emplace(instrument, spread_ * pip_size(Instrument(instrument)) / 2.0).first;
+  }
+  return it->second;
+}
+
+std::pair<double, double> iridium::SimulationAccount::fill_prices(
+    const std::string &instrument,
+    int id,
+    double price,
+    const iridium::data::MarketSnapshot &snapshot) {
+  if (snapshot.has_quote(id)) {
+    const auto &quote = snapshot.quote(id);
+    return {quote.bid.close, quote.ask.close};
+  }
+  auto half_spread = this->half_spread(instrument);
+  return {price - half_spread, price + half_spread};
+}
+
 std::optional<std::tuple<std::string, double, double, double, double, double, double, double>>
 iridium::SimulationAccount::instrument_market_info(
     const iridium::Instrument &instrument,
-    const iridium::data::TickDataMap &tick_data_map) {
+    int id,
+    const iridium::data::MarketSnapshot &snapshot) {
   auto instrument_name = instrument.name();
   auto base = instrument.base_name();
   auto quote = instrument.quote_name();
   // price data
-  auto data = tick_data_map.at(instrument_name);
   auto acc_quote_rate = data::account_currency_rate(
       account_currency(),
       quote,
-      tick_data_map);
+      snapshot);
   auto acc_base_rate = iridium::data::account_currency_rate(
       account_currency(),
       base,
-      tick_data_map);
-  if (data.has_value() &&
+      snapshot);
+  if (snapshot.has_data(id) &&
       acc_quote_rate.has_value() &&
       acc_base_rate.has_value()) {
-    auto low = data.value().low;
-    auto high = data.value().high;
-    auto current_price = data.value().close;
-    auto spread_value = this->spread_ * pow(10, -pip_point(instrument));
-    // ask range
-    auto ask_low = low + spread_value / 2.0;
-    auto ask_high = high + spread_value / 2.0;
-    // bid range
-    auto bid_low = low - spread_value / 2.0;
-    auto bid_high = high - spread_value / 2.0;
+    const auto &data = snapshot.candlestick(id);
+    auto low = data.low;
+    auto high = data.high;
+    auto current_price = data.close;
+    double ask_low, ask_high, bid_low, bid_high;
+    if (snapshot.has_quote(id)) {
+      const auto &quote = snapshot.quote(id);
+      ask_low = quote.ask.low;
+      ask_high = quote.ask.high;
+      bid_low = quote.bid.low;
+      bid_high = quote.bid.high;
+    } else {
+      auto half_spread = this->half_spread(instrument_name);
+      ask_low = low + half_spread;
+      ask_high = high + half_spread;
+      bid_low = low - half_spread;
+      bid_high = high - half_spread;
+    }
     // account vs quote && account vs base
     auto acc_quote_rate_value = acc_quote_rate.value();
     auto acc_base_rate_value = acc_base_rate.value();
@@ -347,18 +378,31 @@ iridium::SimulationAccount::instrument_market_info(
   }
 }
 
+bool iridium::SimulationAccount::PipetteRangeTouched(
+    int id,
+    double price,
+    bool on_bid,
+    const iridium::data::MarketSnapshot &snapshot) const {
+  auto pipettes = snapshot.price_scale(id).pipettes(price);
+  if (snapshot.has_quote(id)) {
+    const auto &side = on_bid ? snapshot.fixed_quote(id).bid : snapshot.fixed_quote(id).ask;
+    return pipettes >= side.low && pipettes <= side.high;
+  }
+  // half the spread may be half a pipette, compare in doubled pipettes
+  const auto &candlestick = snapshot.fixed_candlestick(id);
+  auto spread = on_bid ? -spread_pipettes_ : spread_pipettes_;
+  return 2 * pipettes >= 2 * candlestick.low + spread && 2 * pipettes <= 2 * candlestick.high + spread;
+}
+
 void iridium::SimulationAccount::PartiallyCloseTrade(
     const std::shared_ptr<Trade> &trade_ptr,
     double acc_quote_rate,
-    double current_price,
+    double bid,
+    double ask,
     int units) {
-  auto instrument = trade_ptr->instrument_ptr();
-  auto spread_value = this->spread_ * pow(10, -pip_point(*instrument));
-  auto current_ask = current_price + spread_value / 2.0;
-  auto current_bid = current_price - spread_value / 2.0;
   auto profit_loss = trade_ptr->PartiallyCloseTrade(
       acc_quote_rate,
-      trade_ptr->current_units() > 0 ? current_bid : current_ask,
+      trade_ptr->current_units() > 0 ? bid : ask,
       units);
   balance_ += profit_loss;
 }
@@ -366,15 +410,12 @@ void iridium::SimulationAccount::PartiallyCloseTrade(
 void iridium::SimulationAccount::CloseTrade(
     const std::shared_ptr<Trade> &trade_ptr,
     double acc_quote_rate,
-    double current_price,
+    double bid,
+    double ask,
     std::time_t time) {
-  auto instrument = trade_ptr->instrument_ptr();
-  auto spread_value = this->spread_ * pow(10, -pip_point(*instrument));
-  auto current_ask = current_price + spread_value / 2.0;
-  auto current_bid = current_price - spread_value / 2.0;
   auto profit_loss = trade_ptr->CloseTrade(
       acc_quote_rate,
-      trade_ptr->current_units() > 0 ? current_bid : current_ask,
+      trade_ptr->current_units() > 0 ? bid : ask,
       time);
   balance_ += profit_loss;
 }
@@ -383,10 +424,11 @@ void
 iridium::SimulationAccount::ProcessLimitOrder(
     const std::shared_ptr<LimitOrder> &order_ptr,
     std::time_t time,
-    const iridium::data::TickDataMap &tick_data_map) {
+    const iridium::data::MarketSnapshot &snapshot) {
   // instrument info
   auto instrument = order_ptr->instrument_ptr();
-  auto instrument_info = instrument_market_info(*instrument, tick_data_map);
+  auto id = instrument_id(*order_ptr, snapshot);
+  auto instrument_info = instrument_market_info(*instrument, id, snapshot);
   if (instrument_info.has_value()) {
     auto[instrument_name,
     ask_low,
@@ -399,18 +441,23 @@ iridium::SimulationAccount::ProcessLimitOrder(
     auto order_units = order_ptr->units();
     auto order_price = order_ptr->price();
     // limit order trigger condition
-    if ((order_price >= bid_low && order_price <= bid_high && order_units < 0) ||
-        (order_price >= ask_low && order_price <= ask_high && order_units > 0)) {
+    auto touched = snapshot.fixed_point() ?
+        order_units != 0 && PipetteRangeTouched(id, order_price, order_units < 0, snapshot) :
+        (order_price >= bid_low && order_price <= bid_high && order_units < 0) ||
+            (order_price >= ask_low && order_price <= ask_high && order_units > 0);
+    if (touched) {
       auto existing_trades_ptr = open_trades_ptr(instrument_name);
       auto existing_units = open_position_size(instrument_name);
-      // handle existing positions
+      // handle existing positions, a quoted order touched its own side and closes at the order price
       if (order_units * existing_units < 0) {
+        auto[bid, ask] = snapshot.has_quote(id) ?
+            std::make_pair(order_price, order_price) : fill_prices(instrument_name, id, order_price, snapshot);
         for (auto &trade : *existing_trades_ptr) {
           if (abs(order_units) >= abs(trade->current_units())) {
             order_units += trade->current_units();
-            CloseTrade(trade, acc_quote_rate, order_price, time);
+            CloseTrade(trade, acc_quote_rate, bid, ask, time);
           } else {
-            PartiallyCloseTrade(trade, acc_quote_rate, order_price, order_units);
+            PartiallyCloseTrade(trade, acc_quote_rate, bid, ask, order_units);
             order_units = 0;
           }
         }
@@ -422,8 +469,8 @@ iridium::SimulationAccount::ProcessLimitOrder(
           abs(order_units),
           acc_base_rate,
           leverage());
-      auto nav = net_asset_value(tick_data_map);
-      auto account_margin_used = margin_used(tick_data_map);
+      auto nav = net_asset_value(snapshot);
+      auto account_margin_used = margin_used(snapshot);
       if (nav.has_value() && account_margin_used.has_value()) {
         auto margin_available = CalculateMarginAvailable(nav.value(), account_margin_used.value());
         if (margin_available >= initial_margin) {
@@ -471,11 +518,11 @@ void
 iridium::SimulationAccount::ProcessTriggerOrder(
     const std::shared_ptr<TriggerOrder> &order_ptr,
     std::time_t time,
-    const iridium::data::TickDataMap &tick_data_map) {
+    const iridium::data::MarketSnapshot &snapshot) {
   // instrument info
   auto trade_ptr = acc_trade_ptr(*order_ptr);
   auto instrument = trade_ptr->instrument_ptr();
-  auto instrument_info = instrument_market_info(*instrument, tick_data_map);
+  auto instrument_info = instrument_market_info(*instrument, instrument_id(*trade_ptr, snapshot), snapshot);
   if (instrument_info.has_value()) {
     auto[instrument_name,
     ask_low,
@@ -489,6 +536,7 @@ iridium::SimulationAccount::ProcessTriggerOrder(
       ProcessPriceTriggerOrder(
           price_trigger_order_ptr,
           trade_ptr,
+          snapshot,
           ask_low,
           ask_high,
           bid_low,
@@ -499,6 +547,7 @@ iridium::SimulationAccount::ProcessTriggerOrder(
       ProcessTrailingStopLossOrder(
           trailing_stop_loss_order_ptr,
           trade_ptr,
+          snapshot,
           ask_low,
           ask_high,
           bid_low,
@@ -514,6 +563,7 @@ void
 iridium::SimulationAccount::ProcessPriceTriggerOrder(
     const std::shared_ptr<PriceTriggerOrder> &order_ptr,
     const std::shared_ptr<Trade> &trade_ptr,
+    const iridium::data::MarketSnapshot &snapshot,
     double ask_low,
     double ask_high,
     double bid_low,
@@ -522,8 +572,12 @@ iridium::SimulationAccount::ProcessPriceTriggerOrder(
     std::time_t time) {
   auto trade_units = trade_ptr->current_units();
   auto order_price = order_ptr->price();
-  if ((order_price >= bid_low && order_price <= bid_high && trade_units > 0) ||
-      (order_price >= ask_low && order_price <= ask_high && trade_units < 0)) {
+  auto id = instrument_id(*trade_ptr, snapshot);
+  auto touched = snapshot.fixed_point() ?
+      trade_units != 0 && PipetteRangeTouched(id, order_price, trade_units > 0, snapshot) :
+      (order_price >= bid_low && order_price <= bid_high && trade_units > 0) ||
+          (order_price >= ask_low && order_price <= ask_high && trade_units < 0);
+  if (touched) {
     order_ptr->set_order_state(OrderState::kTriggered);
     auto profit_loss = trade_ptr->CloseTrade(
         acc_quote_rate,
@@ -543,6 +597,7 @@ void
 iridium::SimulationAccount::ProcessTrailingStopLossOrder(
     const std::shared_ptr<TrailingStopLossOrder> &order_ptr,
     const std::shared_ptr<Trade> &trade_ptr,
+    const iridium::data::MarketSnapshot &snapshot,
     double ask_low,
     double ask_high,
     double bid_low,
@@ -553,8 +608,12 @@ iridium::SimulationAccount::ProcessTrailingStopLossOrder(
   auto trade_units = trade_ptr->current_units();
   auto distance = order_ptr->distance();
   auto trailing_stop_loss_price = order_ptr->trailing_stop_price();
-  if ((trailing_stop_loss_price >= bid_low && trailing_stop_loss_price <= bid_high && trade_units > 0) ||
-      (trailing_stop_loss_price >= ask_low && trailing_stop_loss_price <= ask_high && trade_units < 0)) {
+  auto id = instrument_id(*trade_ptr, snapshot);
+  auto touched = snapshot.fixed_point() ?
+      trade_units != 0 && PipetteRangeTouched(id, trailing_stop_loss_price, trade_units > 0, snapshot) :
+      (trailing_stop_loss_price >= bid_low && trailing_stop_loss_price <= bid_high && trade_units > 0) ||
+          (trailing_stop_loss_price >= ask_low && trailing_stop_loss_price <= ask_high && trade_units < 0);
+  if (touched) {
     order_ptr->set_order_state(OrderState::kTriggered);
     auto profit_loss = trade_ptr->CloseTrade(
         acc_quote_rate,
@@ -0,0 +1,118 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <iridium/compressed_store.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+static void PutVarint(std::vector<std::uint8_t> &bytes, std::uint64_t value) {
+  while (value >= 0x80) {
+    bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  bytes.push_back(static_cast<std::uint8_t>(value));
+}
+
+static void PutSignedVarint(std::vector<std::uint8_t> &bytes, std::int64_t value) {
+  PutVarint(bytes, (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+}
+
+static std::uint64_t GetVarint(const std::uint8_t *&pos) {
+  std::uint64_t value = 0;
+  int shift = 0;
+  while (*pos & 0x80) {
+    value |= static_cast<std::uint64_t>(*pos++ & 0x7f) << shift;
+    shift += 7;
+  }
+  value |= static_cast<std::uint64_t>(*pos++) << shift;
+  return value;
+}
+
+static std::int64_t GetSignedVarint(const std::uint8_t *&pos) {
+  auto value = GetVarint(pos);
+  return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+iridium::data::CompressedCandleSeries::CompressedCandleSeries(
+    const iridium::data::CandleColumns &columns,
+    iridium::data::DataFreq freq,
+    int price_decimals) :
+    freq_(freq),
+    price_scale_(std::pow(10.0, price_decimals)),
+    size_(columns.size()),
+    time_index_(columns.times, freq) {
+  auto pipettes = [this](double price) { return std::llround(price * price_scale_); };
+  blocks_.reserve((size_ + kCompressedBlockRows - 1) / kCompressedBlockRows);
+  for (std::size_t first = 0; first < size_; first += kCompressedBlockRows) {
+    auto rows = std::min(kCompressedBlockRows, size_ - first);
+    Block block{columns.times[first], pipettes(columns.opens[first]), bytes_.size(),
+                static_cast<std::uint32_t>(rows)};
+    auto prev_time = block.first_time - freq_;
+    for (auto i = first; i < first + rows; ++i) {
+      PutSignedVarint(bytes_, columns.times[i] - prev_time - freq_);
+      PutSignedVarint(bytes_, pipettes(columns.opens[i]) - block.open);
+      PutSignedVarint(bytes_, pipettes(columns.closes[i]) - block.open);
+      PutSignedVarint(bytes_, pipettes(columns.highs[i]) - block.open);
+      PutSignedVarint(bytes_, pipettes(columns.lows[i]) - block.open);
+      PutVarint(bytes_, static_cast<std::uint32_t>(columns.volumes[i]));
+      prev_time = columns.times[i];
+    }
+    blocks_.push_back(block);
+  }
+  bytes_.shrink_to_fit();
+}
+
+std::size_t iridium::data::CompressedCandleSeries::size() const {
+  return size_;
+}
+
+int iridium::data::CompressedCandleSeries::row_index(std::time_t time) const {
+  return time_index_.row(time);
+}
+
+iridium::data::HistoryWindow
+iridium::data::CompressedCandleSeries::window(std::size_t first, std::size_t count) const {
+  if (first + count > size()) throw std::out_of_range("Candlestick Data Not Found");
+  auto columns = std::make_shared<CandleColumns>();
+  if (count == 0) {
+    return HistoryWindow(columns, 0, 0);
+  }
+  auto first_block = first / kCompressedBlockRows;
+  auto last_block = (first + count - 1) / kCompressedBlockRows;
+  columns->reserve((last_block - first_block + 1) * kCompressedBlockRows);
+  for (auto block_index = first_block; block_index <= last_block; ++block_index) {
+    DecodeBlock(block_index, *columns);
+  }
+  return HistoryWindow(columns, first - first_block * kCompressedBlockRows, count);
+}
+
+std::size_t iridium::data::CompressedCandleSeries::memory_usage() const noexcept {
+  return blocks_.capacity() * sizeof(Block) + bytes_.capacity() + time_index_.memory_usage();
+}
+
+void iridium::data::CompressedCandleSeries::DecodeBlock(
+    std::size_t block_index,
+    iridium::data::CandleColumns &columns) const {
+  const auto &block = blocks_[block_index];
+  const auto *pos = bytes_.data() + block.offset;
+  auto time = block.first_time - freq_;
+  for (std::uint32_t row = 0; row < block.rows; ++row) {
+    time += GetSignedVarint(pos) + freq_;
+    columns.times.push_back(time);
+    columns.opens.push_back(static_cast<double>(block.open + GetSignedVarint(pos)) / price_scale_);
+    columns.closes.push_back(static_cast<double>(block.open + GetSignedVarint(pos)) / price_scale_);
+    columns.highs.push_back(static_cast<double>(block.open + GetSignedVarint(pos)) / price_scale_);
+    columns.lows.push_back(static_cast<double>(block.open + GetSignedVarint(pos)) / price_scale_);
+    columns.volumes.push_back(static_cast<int>(GetVarint(pos)));
+  }
+}
@@ -0,0 +1,300 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <iridium/csv_import.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <iridium/storage.hpp>
+
+/*
+ * read n digits at pos, return false if any of them is not a digit
+ */
+static bool ParseDigits(std::string_view text, std::size_t pos, std::size_t n, int &value) {
+  if (pos + n > text.size()) {
+    return false;
+  }
+  value = 0;
+  for (std::size_t i = pos; i < pos + n; ++i) {
+    if (text[i] < '0' || text[i] > '9') {
+      return false;
+    }
+    value = value * 10 + (text[i] - '0');
+  }
+  return true;
+}
+
+/*
+ * days since 1970-01-01 of a proleptic Gregorian date
+ */
+static std::time_t DaysFromCivil(int year, int month, int day) {
+  year -= month <= 2;
+  auto era = (year >= 0 ? year : year - 399) / 400;
+  auto year_of_era = year - era * 400;
+  auto day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  auto day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+  return static_cast<std::time_t>(era) * 146097 + day_of_era - 719468;
+}
+
+static bool IsDateSeparator(char c) {
+  return c == '-' || c == '.' || c == '/';
+}
+
+static std::string_view Trim(std::string_view field) {
+  while (!field.empty() && (field.front() == ' ' || field.front() == '"')) field.remove_prefix(1);
+  while (!field.empty() && (field.back() == ' ' || field.back() == '"' || field.back() == '\r')) field.remove_suffix(1);
+  return field;
+}
+
+std::optional<std::time_t> iridium::data::ParseCsvTime(std::string_view field) {
+  field = Trim(field);
+  if (field.empty()) {
+    return std::nullopt;
+  }
+  if (std::all_of(field.begin(), field.end(), [](char c) { return c >= '0' && c <= '9'; }) && field.size() != 14) {
+    std::int64_t value = 0;
+    std::from_chars(field.data(), field.data() + field.size(), value);
+    if (field.size() <= 10) return value;
+    if (field.size() == 13) return value / 1000;
+    return std::nullopt;
+  }
+  int year, month, day, hour = 0, minute = 0, second = 0;
+  std::size_t pos;
+  if (field.size() >= 10 && IsDateSeparator(field[4]) && field[7] == field[4]) {
+    if (!ParseDigits(field, 0, 4, year) || !ParseDigits(field, 5, 2, month) || !ParseDigits(field, 8, 2, day)) {
+      return std::nullopt;
+    }
+    pos = 10;
+  } else if (ParseDigits(field, 0, 4, year) && ParseDigits(field, 4, 2, month) && ParseDigits(field, 6, 2, day)) {
+    pos = 8;
+  } else {
+    return std::nullopt;
+  }
+  if (pos < field.size()) {
+    // the time follows the date directly, or after a space or T
+    if (field[pos] == ' ' || field[pos] == 'T') ++pos;
+    if (ParseDigits(field, pos, 6, hour) && (pos + 6 == field.size() || field[pos + 6] == '.' || field[pos + 6] == 'Z')) {
+      auto hhmmss = hour;
+      hour = hhmmss / 10000;
+      minute = hhmmss / 100 % 100;
+      second = hhmmss % 100;
+    } else {
+      if (!ParseDigits(field, pos, 2, hour) || pos + 2 >= field.size() || field[pos + 2] != ':' ||
+          !ParseDigits(field, pos + 3, 2, minute)) {
+        return std::nullopt;
+      }
+      pos += 5;
+      if (pos < field.size() && field[pos] == ':') {
+        if (!ParseDigits(field, pos + 1, 2, second)) return std::nullopt;
+        pos += 3;
+      }
+      if (pos < field.size() && field[pos] != '.' && field[pos] != 'Z') {
+        return std::nullopt;
+      }
+    }
+  }
+  if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+    return std::nullopt;
+  }
+  return DaysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+}
+
+/*
+ * candlesticks of one chunk, error_line counts the lines of the chunk from 1
+ */
+struct CsvChunk {
+  iridium::data::CandleColumns columns;
+  std::size_t lines = 0;
+  std::size_t error_line = 0;
+  std::string error;
+};
+
+template<typename T>
+static bool ParseNumber(std::string_view field, T &value) {
+  field = Trim(field);
+  auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+  return result.ec == std::errc() && result.ptr == field.data() + field.size();
+}
+
+static bool ParseVolume(std::string_view field, int &volume) {
+  if (ParseNumber(field, volume)) {
+    return true;
+  }
+  // tick volumes of some vendors carry decimals
+  double value;
+  if (!ParseNumber(field, value)) {
+    return false;
+  }
+  volume = static_cast<int>(std::lround(value));
+  return true;
+}
+
+static void ParseChunk(
+    std::string_view text,
+    const iridium::data::CsvFormat &format,
+    bool header,
+    CsvChunk &chunk) {
+  auto columns = std::max({format.time_column, format.open_column, format.high_column,
+                           format.low_column, format.close_column,
+                           format.volume_column == iridium::data::kNoCsvColumn ? 0 : format.volume_column}) + 1;
+  std::vector<std::string_view> fields(columns);
+  chunk.columns.reserve(text.size() / 48);
+  std::size_t pos = 0;
+  while (pos < text.size()) {
+    auto end = text.find('\n', pos);
+    if (end == std::string_view::npos) end = text.size();
+    auto line = text.substr(pos, end - pos);
+    pos = end + 1;
+    ++chunk.lines;
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    if (line.empty()) {
+      continue;
+    }
+    std::size_t count = 0;
+    for (std::size_t field_pos = 0; count < columns;) {
+      auto sep = line.find(format.delimiter, field_pos);
+      fields[count++] = line.substr(field_pos, sep == std::string_view::npos ? sep : sep - field_pos);
+      if (sep == std::string_view::npos) break;
+      field_pos = sep + 1;
+    }
+    auto time = count == columns ? iridium::data::ParseCsvTime(fields[format.time_column]) : std::nullopt;
+    if (!time && header && chunk.lines == 1) {
+      continue;
+    }
+    iridium::data::Candlestick candle{0, 0.0, 0.0, 0.0, 0.0, 0};
+    if (!time || !ParseNumber(fields[format.open_column], candle.open) ||
+        !ParseNumber(fields[format.high_column], candle.high) ||
+        !ParseNumber(fields[format.low_column], candle.low) ||
+        !ParseNumber(fields[format.close_column], candle.close) ||
+        (format.volume_column != iridium::data::kNoCsvColumn && !ParseVolume(fields[format.volume_column], candle.volume))) {
+      chunk.error_line = chunk.lines;
+      chunk.error = std::string(line);
+      return;
+    }
+    candle.time = *time;
+    chunk.columns.push_back(candle);
+  }
+}
+
+std::shared_ptr<iridium::data::CandleColumns> iridium::data::ParseCandleCsv(
+    std::string_view text,
+    const iridium::data::CsvFormat &format,
+    std::size_t threads,
+    const std::string &name) {
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  // chunk bounds sit right after a line end
+  auto chunk_count = std::clamp<std::size_t>(text.size() / kCsvChunkBytes, 1, threads);
+  std::vector<std::size_t> bounds{0};
+  for (std::size_t i = 1; i < chunk_count; ++i) {
+    auto bound = text.find('\n', std::max(bounds.back(), text.size() / chunk_count * i));
+    if (bound == std::string_view::npos) break;
+    bounds.push_back(bound + 1);
+  }
+  bounds.push_back(text.size());
+  std::vector<CsvChunk> chunks(bounds.size() - 1);
+  if (chunks.size() == 1) {
+    ParseChunk(text, format, true, chunks[0]);
+  } else {
+    boost::asio::thread_pool pool(chunks.size());
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+      boost::asio::post(pool, [&, i] {
+        ParseChunk(text.substr(bounds[i], bounds[i + 1] - bounds[i]), format, i == 0, chunks[i]);
+      });
+    }
+    pool.join();
+  }
+  std::size_t lines = 0;
+  std::size_t rows = 0;
+  for (const auto &chunk : chunks) {
+    if (chunk.error_line != 0) {
+      throw std::runtime_error(
+          "Malformed candle at " + name + ":" + std::to_string(lines + chunk.error_line) + ": " + chunk.error);
+    }
+    lines += chunk.lines;
+    rows += chunk.columns.size();
+  }
+  if (chunks.size() == 1) {
+    return std::make_shared<CandleColumns>(std::move(chunks[0].columns));
+  }
+  auto columns = std::make_shared<CandleColumns>();
+  columns->reserve(rows);
+  for (auto &chunk : chunks) {
+    auto append = [](auto &to, const auto &from) { to.insert(to.end(), from.begin(), from.end()); };
+    append(columns->times, chunk.columns.times);
+    append(columns->opens, chunk.columns.opens);
+    append(columns->closes, chunk.columns.closes);
+    append(columns->highs, chunk.columns.highs);
+    append(columns->lows, chunk.columns.lows);
+    append(columns->volumes, chunk.columns.volumes);
+    chunk.columns = CandleColumns();
+  }
+  return columns;
+}
+
+std::shared_ptr<iridium::data::CandleColumns> iridium::data::ReadCandleCsv(
+    const std::string &path,
+    const iridium::data::CsvFormat &format,
+    std::size_t threads) {
+  MappedFile file(path);
+  std::string_view text(reinterpret_cast<const char *>(file.data()), file.size());
+  return ParseCandleCsv(text, format, threads, path);
+}
+
+bool iridium::data::CandleValidation::ordered() const noexcept {
+  return out_of_order == 0 && duplicates == 0;
+}
+
+iridium::data::CandleValidation
+iridium::data::ValidateCandles(const iridium::data::CandleColumns &columns, iridium::data::DataFreq freq) {
+  CandleValidation validation;
+  auto step = std::min<std::time_t>(freq, DataFreq::h1);
+  for (std::size_t i = 0; i < columns.size(); ++i) {
+    auto time = columns.times[i];
+    if (time % step != 0) ++validation.off_grid;
+    if (i == 0) continue;
+    auto gap = time - columns.times[i - 1];
+    if (gap < 0) {
+      ++validation.out_of_order;
+    } else if (gap == 0) {
+      ++validation.duplicates;
+    } else if (gap > freq) {
+      ++validation.gaps;
+      if (gap > kLongGap) ++validation.long_gaps;
+    }
+    validation.longest_gap = std::max(validation.longest_gap, gap);
+  }
+  return validation;
+}
+
+void iridium::data::SortCandles(iridium::data::CandleColumns &columns) {
+  std::vector<std::size_t> order(columns.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&columns](auto a, auto b) {
+    return columns.times[a] < columns.times[b];
+  });
+  CandleColumns sorted;
+  sorted.reserve(order.size());
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    // the last row of a time wins, i.e. later files and lines override earlier ones
+    if (i + 1 < order.size() && columns.times[order[i + 1]] == columns.times[order[i]]) continue;
+    sorted.push_back(columns.candlestick(order[i]));
+  }
+  columns = std::move(sorted);
+}
@@ -11,6 +11,26 @@ limitations under the License.
 ==============================================================================*/
 
 #include <iridium/data.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/post.hpp>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <iridium/storage.hpp>
+#include <iridium/hdf5_store.hpp>
+#include <iridium/compressed_store.hpp>
+#include <iridium/fixed_point_store.hpp>
+#include <iridium/quote_store.hpp>
+#include <iridium/shm_store.hpp>
+#include <iridium/stream_store.hpp>
+#include <iridium/range_query.hpp>
+#include <iridium/partition_store.hpp>
+#include <iridium/swmr_store.hpp>
+#include <iridium/resample.hpp>
 
 // utility methods
 std::string
@@ -116,46 +136,11 @@ std::optional<double>
 iridium::data::account_currency_rate(
     const std::string &account,
     const std::string &currency,
-    const iridium::data::TickDataMap &tickDataMap) {
+    const iridium::data::MarketSnapshot &snapshot) {
   if (account == currency) {
     return 1.0;
-  } else {
-    auto instruments = std::make_shared<std::vector<std::string>>();
-    for (const auto &[name, _] : tickDataMap) {
-      instruments->push_back(name);
-    }
-    auto pair = account + "_" + currency;
-    auto reversedPair = currency + "_" + account;
-    std::optional<bool> reversed = std::nullopt;
-    for (const auto &instrument : *instruments) {
-      if (instrument == pair) {
-        reversed = false;
-        break;
-      } else if (instrument == reversedPair) {
-        reversed = true;
-        break;
-      }
-    }
-    if (reversed) {
-      if (reversed.value()) {
-        auto data = tickDataMap.at(reversedPair);
-        if (data.has_value()) {
-          return 1.0 / data->close;
-        } else {
-          return std::nullopt;
-        }
-      } else {
-        auto data = tickDataMap.at(pair);
-        if (data.has_value()) {
-          return data->close;
-        } else {
-          return std::nullopt;
-        }
-      }
-    } else {
-      return std::nullopt;
-    }
   }
+  return snapshot.currency_rate(snapshot.currency_id(account), snapshot.currency_id(currency));
 }
 
 std::ostream &operator<<(std::ostream &os, const iridium::data::Candlestick &candlestick) {
@@ -168,39 +153,515 @@ std::ostream &operator<<(std::ostream &os, const iridium::data::Candlestick &can
   return os;
 }
 
+// CandleColumns
+std::size_t iridium::data::CandleColumns::size() const noexcept {
+  return times.size();
+}
+
+iridium::data::Candlestick
+iridium::data::CandleColumns::candlestick(std::size_t index) const {
+  Candlestick candlestick;
+  candlestick.time = times[index];
+  candlestick.open = opens[index];
+  candlestick.close = closes[index];
+  candlestick.high = highs[index];
+  candlestick.low = lows[index];
+  candlestick.volume = volumes[index];
+  return candlestick;
+}
+
+void iridium::data::CandleColumns::reserve(std::size_t size) {
+  times.reserve(size);
+  opens.reserve(size);
+  closes.reserve(size);
+  highs.reserve(size);
+  lows.reserve(size);
+  volumes.reserve(size);
+}
+
+void iridium::data::CandleColumns::push_back(const Candlestick &candlestick) {
+  times.push_back(candlestick.time);
+  opens.push_back(candlestick.open);
+  closes.push_back(candlestick.close);
+  highs.push_back(candlestick.high);
+  lows.push_back(candlestick.low);
+  volumes.push_back(candlestick.volume);
+}
+
+iridium::data::CandleColumnsView iridium::data::CandleColumns::view() const noexcept {
+  return CandleColumnsView{times, opens, closes, highs, lows, volumes};
+}
+
+// HistoryWindow
+iridium::data::HistoryWindow::HistoryWindow(
+    const std::shared_ptr<const CandleColumns> &columns,
+    std::size_t first,
+    std::size_t count) :
+    HistoryWindow(columns, columns->view(), first, count) {}
+
+iridium::data::HistoryWindow::HistoryWindow(
+    std::shared_ptr<const void> owner,
+    const CandleColumnsView &columns,
+    std::size_t first,
+    std::size_t count) :
+    owner_(std::move(owner)),
+    times_(columns.times.sub_view(first, count)),
+    opens_(columns.opens.sub_view(first, count)),
+    closes_(columns.closes.sub_view(first, count)),
+    highs_(columns.highs.sub_view(first, count)),
+    lows_(columns.lows.sub_view(first, count)),
+    volumes_(columns.volumes.sub_view(first, count)) {}
+
+iridium::data::HistoryWindow::HistoryWindow(const std::vector<Candlestick> &data_list) {
+  auto columns = std::make_shared<CandleColumns>();
+  columns->reserve(data_list.size());
+  for (const auto &candle : data_list) {
+    columns->push_back(candle);
+  }
+  *this = HistoryWindow(columns, 0, columns->size());
+}
+
+std::size_t iridium::data::HistoryWindow::size() const noexcept {
+  return times_.size();
+}
+
+bool iridium::data::HistoryWindow::empty() const noexcept {
+  return times_.empty();
+}
+
+std::time_t iridium::data::HistoryWindow::begin_time() const {
+  if (empty()) throw std::out_of_range("Empty history window");
+  return times_.front();
+}
+
+std::time_t iridium::data::HistoryWindow::end_time() const {
+  if (empty()) throw std::out_of_range("Empty history window");
+  return times_.back();
+}
+
+iridium::data::Candlestick
+iridium::data::HistoryWindow::operator[](std::size_t index) const {
+  Candlestick candlestick;
+  candlestick.time = times_[index];
+  candlestick.open = opens_[index];
+  candlestick.close = closes_[index];
+  candlestick.high = highs_[index];
+  candlestick.low = lows_[index];
+  candlestick.volume = volumes_[index];
+  return candlestick;
+}
+
+iridium::data::Candlestick iridium::data::HistoryWindow::front() const {
+  if (empty()) throw std::out_of_range("Empty history window");
+  return (*this)[0];
+}
+
+iridium::data::Candlestick iridium::data::HistoryWindow::back() const {
+  if (empty()) throw std::out_of_range("Empty history window");
+  return (*this)[size() - 1];
+}
+
+iridium::algorithm::ColumnView<std::time_t> iridium::data::HistoryWindow::times() const noexcept {
+  return times_;
+}
+
+iridium::algorithm::ColumnView<double> iridium::data::HistoryWindow::opens() const noexcept {
+  return opens_;
+}
+
+iridium::algorithm::ColumnView<double> iridium::data::HistoryWindow::closes() const noexcept {
+  return closes_;
+}
+
+iridium::algorithm::ColumnView<double> iridium::data::HistoryWindow::highs() const noexcept {
+  return highs_;
+}
+
+iridium::algorithm::ColumnView<double> iridium::data::HistoryWindow::lows() const noexcept {
+  return lows_;
+}
+
+iridium::algorithm::ColumnView<int> iridium::data::HistoryWindow::volumes() const noexcept {
+  return volumes_;
+}
+
+iridium::data::HistoryWindow
+iridium::data::HistoryWindow::sub_window(std::size_t first, std::size_t count) const {
+  if (first + count > size()) throw std::out_of_range("Out of range");
+  auto window = *this;
+  window.times_ = times_.sub_view(first, count);
+  window.opens_ = opens_.sub_view(first, count);
+  window.closes_ = closes_.sub_view(first, count);
+  window.highs_ = highs_.sub_view(first, count);
+  window.lows_ = lows_.sub_view(first, count);
+  window.volumes_ = volumes_.sub_view(first, count);
+  return window;
+}
+
+std::shared_ptr<iridium::data::DataList> iridium::data::HistoryWindow::data_list() const {
+  auto candles = std::make_shared<DataList>();
+  candles->reserve(size());
+  for (std::size_t i = 0; i < size(); ++i) {
+    candles->push_back((*this)[i]);
+  }
+  return candles;
+}
+
+double iridium::data::candle_field(const iridium::data::Candlestick &candlestick, iridium::data::CandleField field) {
+  switch (field) {
+    case kOpenPrice:return candlestick.open;
+    case kHighPrice:return candlestick.high;
+    case kLowPrice:return candlestick.low;
+    case kClosePrice:return candlestick.close;
+    case kVolume:return candlestick.volume;
+  }
+  return std::numeric_limits<double>::quiet_NaN();
+}
+
+// Panel
+iridium::data::Panel::Panel(std::vector<std::time_t> times, std::size_t columns) :
+    times_(std::move(times)),
+    columns_(columns),
+    values_(times_.size() * columns, std::numeric_limits<double>::quiet_NaN()),
+    mask_(times_.size() * columns, 0) {}
+
+std::size_t iridium::data::Panel::rows() const noexcept {
+  return times_.size();
+}
+
+std::size_t iridium::data::Panel::columns() const noexcept {
+  return columns_;
+}
+
+const std::vector<std::time_t> &iridium::data::Panel::times() const noexcept {
+  return times_;
+}
+
+const double *iridium::data::Panel::values() const noexcept {
+  return values_.data();
+}
+
+const double *iridium::data::Panel::row(std::size_t row) const noexcept {
+  return values_.data() + row * columns_;
+}
+
+double iridium::data::Panel::operator()(std::size_t row, std::size_t column) const noexcept {
+  return values_[row * columns_ + column];
+}
+
+const std::uint8_t *iridium::data::Panel::mask() const noexcept {
+  return mask_.data();
+}
+
+bool iridium::data::Panel::valid(std::size_t row, std::size_t column) const noexcept {
+  return mask_[row * columns_ + column] != 0;
+}
+
+void iridium::data::Panel::FillColumn(
+    std::size_t column,
+    const iridium::data::HistoryWindow &window,
+    iridium::data::CandleField field,
+    bool forward_fill,
+    std::optional<double> seed) {
+  if (column >= columns_) throw std::out_of_range("Panel column out of range");
+  auto times = window.times();
+  auto fill = [&](auto bars) {
+    auto last = forward_fill && seed ? *seed : std::numeric_limits<double>::quiet_NaN();
+    std::size_t bar = 0;
+    for (std::size_t row = 0; row < times_.size(); ++row) {
+      auto cell = row * columns_ + column;
+      if (bar < times.size() && times[bar] == times_[row]) {
+        values_[cell] = last = bars[bar++];
+        mask_[cell] = 1;
+      } else if (forward_fill) {
+        values_[cell] = last;
+      }
+    }
+    if (bar != times.size()) {
+      throw std::invalid_argument("Window times are not in the panel");
+    }
+  };
+  switch (field) {
+    case kOpenPrice:fill(window.opens());
+      break;
+    case kHighPrice:fill(window.highs());
+      break;
+    case kLowPrice:fill(window.lows());
+      break;
+    case kClosePrice:fill(window.closes());
+      break;
+    case kVolume:fill(window.volumes());
+      break;
+  }
+}
+
+// MarketSnapshot
+iridium::data::MarketSnapshot::MarketSnapshot(const iridium::InstrumentList &instruments, bool fixed_point) :
+    instruments_(instruments),
+    candlesticks_(instruments.size()),
+    quotes_(instruments.size()),
+    present_((instruments.size() + 63) / 64, 0),
+    quoted_((instruments.size() + 63) / 64, 0) {
+  for (std::size_t i = 0; i < instruments_.size(); ++i) {
+    ids_.emplace(instruments_[i]->name(), static_cast<int>(i));
+  }
+  if (fixed_point) {
+    for (const auto &instrument : instruments_) {
+      scales_.emplace_back(*instrument);
+    }
+    fixed_candlesticks_.resize(instruments.size());
+    fixed_quotes_.resize(instruments.size());
+  }
+  BuildCurrencyRoutes();
+}
+
+std::size_t iridium::data::MarketSnapshot::size() const noexcept {
+  return instruments_.size();
+}
+
+const iridium::InstrumentList &iridium::data::MarketSnapshot::instruments() const noexcept {
+  return instruments_;
+}
+
+std::time_t iridium::data::MarketSnapshot::time() const noexcept {
+  return time_;
+}
+
+int iridium::data::MarketSnapshot::instrument_id(const std::string &instrument_name) const noexcept {
+  auto it = ids_.find(instrument_name);
+  return it == ids_.end() ? kNoInstrument : it->second;
+}
+
+bool iridium::data::MarketSnapshot::has_data(int id) const noexcept {
+  return id >= 0 && static_cast<std::size_t>(id) < size() && (present_[id >> 6] >> (id & 63)) & 1U;
+}
+
+int iridium::data::MarketSnapshot::currency_id(const std::string &currency) const noexcept {
+  auto it = currency_ids_.find(currency);
+  return it == currency_ids_.end() ? kNoCurrency : it->second;
+}
+
+std::optional<double> iridium::data::MarketSnapshot::currency_rate(int account_id, int currency_id) const noexcept {
+  if (account_id == kNoCurrency || currency_id == kNoCurrency) {
+    return std::nullopt;
+  }
+  const auto &route = currency_routes_[account_id * currency_ids_.size() + currency_id];
+  auto rate = 1.0;
+  for (int i = 0; i < route.size; ++i) {
+    const auto &leg = route.legs[i];
+    if (!has_data(leg.instrument_id)) {
+      return std::nullopt;
+    }
+    auto close = candlesticks_[leg.instrument_id].close;
+    rate = leg.inverse ? rate / close : rate * close;
+  }
+  if (route.size == 0 && account_id != currency_id) {
+    return std::nullopt;
+  }
+  return rate;
+}
+
+const iridium::data::Candlestick &iridium::data::MarketSnapshot::candlestick(int id) const noexcept {
+  return candlesticks_[id];
+}
+
+std::optional<iridium::data::Candlestick>
+iridium::data::MarketSnapshot::candlestick(const std::string &instrument_name) const noexcept {
+  auto id = instrument_id(instrument_name);
+  if (!has_data(id)) {
+    return std::nullopt;
+  }
+  return candlesticks_[id];
+}
+
+bool iridium::data::MarketSnapshot::has_quote(int id) const noexcept {
+  return id >= 0 && static_cast<std::size_t>(id) < size() && (quoted_[id >> 6] >> (id & 63)) & 1U;
+}
+
+const iridium::data::Quote &iridium::data::MarketSnapshot::quote(int id) const noexcept {
+  return quotes_[id];
+}
+
+bool iridium::data::MarketSnapshot::fixed_point() const noexcept {
+  return !scales_.empty();
+}
+
+const iridium::data::PriceScale &iridium::data::MarketSnapshot::price_scale(int id) const noexcept {
+  return scales_[id];
+}
+
+const iridium::data::FixedCandlestick &iridium::data::MarketSnapshot::fixed_candlestick(int id) const noexcept {
+  return fixed_candlesticks_[id];
+}
+
+const iridium::data::FixedQuote &iridium::data::MarketSnapshot::fixed_quote(int id) const noexcept {
+  return fixed_quotes_[id];
+}
+
+void iridium::data::MarketSnapshot::BuildCurrencyRoutes() {
+  for (const auto &instrument : instruments_) {
+    for (const auto &currency : {instrument->base_name(), instrument->quote_name()}) {
+      currency_ids_.emplace(currency, static_cast<int>(currency_ids_.size()));
+    }
+  }
+  auto currencies = static_cast<int>(currency_ids_.size());
+  // direct pairs, base_quote converts base to quote at its close
+  std::vector<std::optional<CurrencyLeg>> direct(currencies * currencies);
+  for (std::size_t id = 0; id < instruments_.size(); ++id) {
+    auto base = currency_ids_.at(instruments_[id]->base_name());
+    auto quote = currency_ids_.at(instruments_[id]->quote_name());
+    direct[base * currencies + quote] = CurrencyLeg{static_cast<int>(id), false};
+    direct[quote * currencies + base] = CurrencyLeg{static_cast<int>(id), true};
+  }
+  currency_routes_.assign(currencies * currencies, CurrencyRoute{{}, 0});
+  for (int from = 0; from < currencies; ++from) {
+    for (int to = 0; to < currencies; ++to) {
+      auto &route = currency_routes_[from * currencies + to];
+      if (from == to) {
+        continue;
+      }
+      if (auto leg = direct[from * currencies + to]) {
+        route = {{*leg}, 1};
+        continue;
+      }
+      // triangulate through the first hub with a pair to both currencies
+      for (const auto &hub_name : {"USD", "EUR"}) {
+        auto hub = currency_id(hub_name);
+        if (hub == kNoCurrency || hub == from || hub == to) {
+          continue;
+        }
+        auto first = direct[from * currencies + hub];
+        auto second = direct[hub * currencies + to];
+        if (first && second) {
+          route = {{*first, *second}, 2};
+          break;
+        }
+      }
+    }
+  }
+}
+
+void iridium::data::MarketSnapshot::Reset(std::time_t time) noexcept {
+  time_ = time;
+  std::fill(present_.begin(), present_.end(), 0);
+  std::fill(quoted_.begin(), quoted_.end(), 0);
+}
+
+void iridium::data::MarketSnapshot::Set(int id, const iridium::data::Candlestick &candlestick) noexcept {
+  candlesticks_[id] = candlestick;
+  if (!scales_.empty()) {
+    fixed_candlesticks_[id] = scales_[id].pipettes(candlestick);
+  }
+  present_[id >> 6] |= std::uint64_t{1} << (id & 63);
+}
+
+void iridium::data::MarketSnapshot::SetQuote(int id, const iridium::data::Quote &quote) noexcept {
+  quotes_[id] = quote;
+  if (!scales_.empty()) {
+    fixed_quotes_[id] = {scales_[id].pipettes(quote.bid), scales_[id].pipettes(quote.ask)};
+  }
+  quoted_[id >> 6] |= std::uint64_t{1} << (id & 63);
+}
+
 // TradeData Pimpl
 class iridium::data::TradeData::DataImpl {
  public:
   DataImpl(
       const std::string &file_name,
       const InstrumentList &instruments,
-      const std::vector<DataFreq> &freqs);
+      const std::vector<DataFreq> &freqs,
+      const TradeDataOptions &options);
 
+  /*
+   * return the row index of the candlestick at time, kNoBar if there is no candlestick at time,
+   * rows are sorted by ascending time
+   */
   [[nodiscard]]
   int time_index(
       const std::string &instrument_name,
       std::time_t time,
       DataFreq freq) const;
 
-  [[nodiscard]]
-  std::shared_ptr<H5::DataSet>
-  instrument_dataset(const std::string &instrument_name, DataFreq freq) const;
-
   [[nodiscard]]
   static std::string
   dataset_name(const std::string &instrument_name, DataFreq freq);
 
   [[nodiscard]]
-  std::shared_ptr<std::vector<int>>
-  time_indices(const std::string &instrument_name, DataFreq freq) const;
+  std::shared_ptr<CandleSeries>
+  series(const std::string &instrument_name, DataFreq freq) const;
+
+  /*
+   * return nullptr if the instrument/frequency is not loaded
+   */
+  [[nodiscard]]
+  const CandleSeries *
+  find_series(const std::string &instrument_name, DataFreq freq) const;
+
+  /*
+   * series of every instrument at freq, in the order of instruments
+   */
+  [[nodiscard]]
+  const std::vector<std::shared_ptr<CandleSeries>> &dense_series(DataFreq freq) const;
+
+  /*
+   * quote series of every instrument at freq, in the order of instruments, nullptr for
+   * instruments without quotes. nullptr if no quotes are loaded at freq.
+   */
+  [[nodiscard]]
+  const std::vector<std::shared_ptr<QuoteSeries>> *dense_quotes(DataFreq freq) const;
+
+  [[nodiscard]]
+  const std::vector<std::shared_ptr<Instrument>> &instruments() const noexcept;
+
+  [[nodiscard]]
+  bool lock_free() const noexcept;
 
+  /*
+   * return true if series hold pipettes and snapshots should too
+   */
   [[nodiscard]]
-  std::shared_ptr<DataList> history_data_(
+  bool fixed_point() const noexcept;
+
+  [[nodiscard]]
+  HistoryWindow history_window_(
       const std::string &instrument_name,
-      std::time_t begin,
+      int end_index,
       int count,
-      DataFreq freq,
-      bool reversed) const;
+      DataFreq freq) const;
+
+  /*
+   * every bar of a series and the min/max pyramid over them
+   */
+  struct SeriesExtrema {
+    std::once_flag once;
+    HistoryWindow window;
+    std::unique_ptr<RangeExtrema> extrema;
+  };
+
+  /*
+   * return the pyramid of an instrument/frequency, built on first use
+   */
+  [[nodiscard]]
+  const SeriesExtrema &series_extrema(const std::string &instrument_name, DataFreq freq) const;
+
+  /*
+   * rows first ... last of a series with begin <= time <= end, std::nullopt if there is none
+   */
+  [[nodiscard]]
+  static std::optional<std::pair<std::size_t, std::size_t>>
+  row_range(const SeriesExtrema &extrema, std::time_t begin, std::time_t end);
+
+  /*
+   * return the first row of series at or after time, series.size() if there is none.
+   * Binary search over single-row windows, so on-demand series read O(log n) rows.
+   */
+  [[nodiscard]]
+  static std::size_t lower_row(const CandleSeries &series, std::time_t time);
+
+  /*
+   * read the rows appended to SWMR series since the last refresh, return how many
+   */
+  std::size_t Refresh();
 
  private:
   std::unique_ptr<H5::H5File> file_;
@@ -209,51 +670,506 @@ class iridium::data::TradeData::DataImpl {
 
   std::vector<DataFreq> freqs_;
 
-  std::map<std::string, std::shared_ptr<std::vector<int>>> time_indices_;
+  std::map<std::string, std::shared_ptr<CandleSeries>> series_;
+
+  std::map<DataFreq, std::vector<std::shared_ptr<CandleSeries>>> dense_series_;
+
+  bool lock_free_ = true;
+
+  std::size_t load_threads_;
+
+  LoadProgressCallback progress_;
+
+  bool fixed_point_;
+
+  std::optional<TimeRange> range_;
+
+  std::size_t warm_up_bars_;
+
+  std::size_t stream_block_rows_;
+
+  bool resampled_;
+
+  bool swmr_read_;
+
+  std::mutex load_mutex_;
+
+  std::size_t loaded_ = 0;
+
+  std::size_t load_total_ = 0;
+
+  std::shared_ptr<ChunkCache> chunk_cache_;
 
-  std::map<std::string, std::shared_ptr<H5::DataSet>> datasets_;
+  std::map<DataFreq, std::vector<std::shared_ptr<QuoteSeries>>> dense_quotes_;
+
+  std::map<std::string, std::unique_ptr<SeriesExtrema>> extrema_;
+
+  /*
+   * load every dataset at construction, reporting progress
+   */
+  void LoadEager(
+      const std::string &file_name,
+      StorageBackend backend,
+      const std::vector<DataFreq> &stored_freqs,
+      const TradeDataOptions &options);
+
+  void OpenHdf5(const std::string &file_name, const std::vector<DataFreq> &freqs, LoadMode load_mode);
+
+  void OpenNative(const std::string &directory, const std::vector<DataFreq> &freqs);
+
+  void OpenSharedMemory(const std::string &prefix, const std::vector<DataFreq> &freqs);
+
+  void OpenPartitioned(const std::string &directory, const std::vector<DataFreq> &freqs, LoadMode load_mode);
+
+  /*
+   * open the HDF5 file for SWMR reading and keep it open for Refresh
+   */
+  void OpenSwmr(const std::string &file_name, const std::vector<DataFreq> &freqs);
+
+  /*
+   * load the quote datasets of the HDF5 file, instruments without quotes are skipped
+   */
+  void LoadQuotes(const std::vector<DataFreq> &freqs);
+
+  /*
+   * derive every frequency but M1 from the M1 series
+   */
+  void Resample(const std::string &region, LoadMode load_mode);
+
+  /*
+   * register a series per instrument/frequency that opens its dataset on first access
+   */
+  void OpenLazy(
+      const std::string &file_name,
+      StorageBackend backend,
+      const std::vector<DataFreq> &stored_freqs,
+      const TradeDataOptions &options);
+
+  /*
+   * build the series of an open HDF5 dataset according to load_mode
+   */
+  std::shared_ptr<CandleSeries> LoadHdf5(
+      std::shared_ptr<H5::DataSet> dataset,
+      const Instrument &instrument,
+      DataFreq freq,
+      LoadMode load_mode) const;
 
-  H5::CompType candlestick_type_;
+  /*
+   * rows to read of a partition
+   */
+  struct PartitionRead {
+    Partition partition;
+    RowRange rows;
+  };
+
+  /*
+   * return the rows of the partitions of an instrument/frequency overlapping the range and the warm-up
+   * rows before it, partitions without rows to read are left out
+   */
+  std::vector<PartitionRead> partition_reads(
+      const PartitionManifest &manifest,
+      const Instrument &instrument,
+      DataFreq freq) const;
+
+  /*
+   * read the partitions of an instrument/frequency one after another, used when already on a loading
+   * thread or a reader thread
+   */
+  std::shared_ptr<CandleSeries> LoadPartitions(
+      const PartitionManifest &manifest,
+      const Instrument &instrument,
+      DataFreq freq,
+      LoadMode load_mode) const;
+
+  /*
+   * concatenate the columns of partitions sorted by ascending time
+   */
+  static std::shared_ptr<CandleColumns> ConcatColumns(std::vector<std::shared_ptr<CandleColumns>> parts);
+
+  /*
+   * times and warm-up rows to load at freq
+   */
+  struct LoadScope {
+    std::time_t begin;
+    std::time_t end;
+    std::size_t warm_up;
+  };
+
+  /*
+   * return the scope of the range at freq, std::nullopt without a range
+   */
+  std::optional<LoadScope> load_scope(DataFreq freq) const;
+
+  /*
+   * rows of an HDF5 dataset at freq covering the range with its warm-up, std::nullopt without a range
+   */
+  std::optional<RowRange> scoped_rows(const H5::DataSet &dataset, DataFreq freq) const;
+
+  /*
+   * build the in-memory series of columns according to load_mode
+   */
+  static std::shared_ptr<CandleSeries> MemorySeries(
+      std::shared_ptr<CandleColumns> columns,
+      const Instrument &instrument,
+      DataFreq freq,
+      LoadMode load_mode);
+
+  static std::shared_ptr<CandleSeries> ResampleSeries(
+      const CandleColumnsView &m1,
+      const std::shared_ptr<const std::vector<std::time_t>> &trade_starts,
+      const Instrument &instrument,
+      DataFreq freq,
+      LoadMode load_mode);
+
+  /*
+   * run task(0) ... task(count - 1) on the load thread pool, rethrow the first failure
+   */
+  void ParallelFor(std::size_t count, const std::function<void(std::size_t)> &task) const;
+
+  /*
+   * store a loaded series and report progress, safe to call from the load threads
+   */
+  void AddSeries(
+      const std::string &name,
+      std::shared_ptr<CandleSeries> series,
+      std::chrono::steady_clock::time_point start);
 };
 
 iridium::data::TradeData::DataImpl::DataImpl(
     const std::string &file_name,
     const iridium::InstrumentList &instruments,
-    const std::vector<DataFreq> &freqs) :
+    const std::vector<DataFreq> &freqs,
+    const TradeDataOptions &options) :
     instruments_(instruments),
-    freqs_(freqs) {
+    freqs_(freqs),
+    load_threads_(options.load_threads > 0 ? options.load_threads : std::thread::hardware_concurrency()),
+    progress_(options.progress),
+    fixed_point_(options.load_mode == LoadMode::kFixedPoint),
+    range_(options.range),
+    warm_up_bars_(options.warm_up_bars),
+    stream_block_rows_(options.stream_block_rows),
+    resampled_(options.resample_region.has_value()),
+    swmr_read_(options.swmr_read) {
+  if (options.load_mode == LoadMode::kStreaming && options.resample_region) {
+    throw std::invalid_argument("Streaming does not resample, store every frequency");
+  }
+  if (options.load_mode == LoadMode::kStreaming && options.warm_up_bars == 0) {
+    throw std::invalid_argument("Streaming buffers warm_up_bars bars behind the clock, set it to the largest lookback");
+  }
+  auto backend = options.backend;
+  if (backend == StorageBackend::kAutoDetect) {
+    backend = PartitionManifest::Exists(file_name) ? StorageBackend::kPartitioned
+        : boost::filesystem::is_directory(file_name) ? StorageBackend::kNative : StorageBackend::kHdf5;
+  }
+  if (backend == StorageBackend::kPartitioned &&
+      (options.load_mode == LoadMode::kOnDemand || options.load_mode == LoadMode::kStreaming)) {
+    throw std::invalid_argument("Partitions load in memory, use kInMemory, kCompressed or kFixedPoint");
+  }
+  if (swmr_read_ && (backend != StorageBackend::kHdf5 || options.resample_region || options.range ||
+      options.quotes || options.lazy_open ||
+      (options.load_mode != LoadMode::kOnDemand && options.load_mode != LoadMode::kInMemory))) {
+    throw std::invalid_argument("SWMR reads load whole HDF5 datasets in memory without resampling, range or quotes");
+  }
+  if (options.cache_bytes > 0) {
+    chunk_cache_ = std::make_shared<ChunkCache>(options.cache_bytes);
+  }
+  auto stored_freqs = options.resample_region ? std::vector<DataFreq>{DataFreq::m1} : freqs_;
+  if (options.lazy_open) {
+    OpenLazy(file_name, backend, stored_freqs, options);
+  } else {
+    LoadEager(file_name, backend, stored_freqs, options);
+  }
+  if (options.quotes) {
+    if (backend != StorageBackend::kHdf5) {
+      throw std::invalid_argument("Quotes are only stored in HDF5 files");
+    }
+    LoadQuotes(stored_freqs);
+  }
+  for (auto &freq : freqs_) {
+    auto &dense = dense_series_[freq];
+    for (auto &instrument : instruments_) {
+      dense.push_back(series(instrument->name(), freq));
+      lock_free_ = lock_free_ && dense.back()->lock_free();
+      extrema_[dataset_name(instrument->name(), freq)] = std::make_unique<SeriesExtrema>();
+    }
+  }
+}
+
+void iridium::data::TradeData::DataImpl::LoadEager(
+    const std::string &file_name,
+    iridium::data::StorageBackend backend,
+    const std::vector<DataFreq> &stored_freqs,
+    const iridium::data::TradeDataOptions &options) {
+  load_total_ = instruments_.size() * stored_freqs.size();
+  if (options.resample_region) {
+    load_total_ += instruments_.size() *
+        std::count_if(freqs_.begin(), freqs_.end(), [](auto freq) { return freq != DataFreq::m1; });
+  }
+  if (backend == StorageBackend::kNative) {
+    OpenNative(file_name, stored_freqs);
+  } else if (backend == StorageBackend::kSharedMemory) {
+    OpenSharedMemory(file_name, stored_freqs);
+  } else if (backend == StorageBackend::kPartitioned) {
+    OpenPartitioned(file_name, stored_freqs, options.load_mode);
+  } else if (swmr_read_) {
+    OpenSwmr(file_name, stored_freqs);
+  } else {
+    OpenHdf5(file_name, stored_freqs, options.load_mode);
+  }
+  if (options.resample_region) {
+    Resample(options.resample_region.value(), options.load_mode);
+  }
+}
+
+void iridium::data::TradeData::DataImpl::OpenLazy(
+    const std::string &file_name,
+    iridium::data::StorageBackend backend,
+    const std::vector<DataFreq> &stored_freqs,
+    const iridium::data::TradeDataOptions &options) {
+  auto load_mode = options.load_mode;
+  if (backend == StorageBackend::kHdf5) {
+    std::lock_guard<std::mutex> lock(hdf5_mutex());
+    file_ = std::make_unique<H5::H5File>(file_name, H5F_ACC_RDONLY);
+  }
+  auto manifest = backend == StorageBackend::kPartitioned
+      ? std::make_shared<const PartitionManifest>(file_name) : nullptr;
+  for (auto &instrument : instruments_) {
+    for (auto &freq : stored_freqs) {
+      auto name = dataset_name(instrument->name(), freq);
+      if (backend == StorageBackend::kNative) {
+        auto path = (boost::filesystem::path(file_name) / candle_file_name(instrument->name(), freq)).string();
+        series_[name] = std::make_shared<LazySeries>([path]() -> std::shared_ptr<CandleSeries> {
+          return std::make_shared<MappedCandleSeries>(path);
+        });
+        continue;
+      }
+      if (backend == StorageBackend::kSharedMemory) {
+        series_[name] = std::make_shared<LazySeries>([file_name, instrument, freq]() -> std::shared_ptr<CandleSeries> {
+          return AttachShmSeries(file_name, instrument->name(), freq);
+        });
+        continue;
+      }
+      if (manifest) {
+        series_[name] = std::make_shared<LazySeries>([this, manifest, instrument, freq, load_mode] {
+          return LoadPartitions(*manifest, *instrument, freq, load_mode);
+        });
+        continue;
+      }
+      series_[name] = std::make_shared<LazySeries>([this, instrument, freq, name, load_mode] {
+        return LoadHdf5(OpenCandleDataSet(*file_, name), *instrument, freq, load_mode);
+      });
+    }
+  }
+  if (!options.resample_region) {
+    return;
+  }
+  auto region = options.resample_region.value();
+  for (auto &instrument : instruments_) {
+    auto m1_series = series(instrument->name(), DataFreq::m1);
+    for (auto &freq : freqs_) {
+      if (freq == DataFreq::m1) continue;
+      series_[dataset_name(instrument->name(), freq)] = std::make_shared<LazySeries>(
+          [m1_series, instrument, freq, region, load_mode]() -> std::shared_ptr<CandleSeries> {
+            auto m1 = m1_series->window(0, m1_series->size());
+            CandleColumnsView columns{m1.times(), m1.opens(), m1.closes(), m1.highs(), m1.lows(), m1.volumes()};
+            return ResampleSeries(columns, trade_start_times(columns.times, region), *instrument, freq, load_mode);
+          });
+    }
+  }
+}
+
+std::shared_ptr<iridium::data::CandleSeries>
+iridium::data::TradeData::DataImpl::LoadHdf5(
+    std::shared_ptr<H5::DataSet> dataset,
+    const iridium::Instrument &instrument,
+    iridium::data::DataFreq freq,
+    iridium::data::LoadMode load_mode) const {
+  auto rows = scoped_rows(*dataset, freq);
+  if (load_mode == LoadMode::kOnDemand) {
+    return std::make_shared<Hdf5Series>(std::move(dataset), freq, chunk_cache_, rows);
+  }
+  if (load_mode == LoadMode::kStreaming) {
+    return std::make_shared<StreamingSeries>(std::move(dataset), freq, warm_up_bars_, stream_block_rows_, rows);
+  }
+  auto columns = rows ? ReadColumns(*dataset, *rows) : ReadColumns(*dataset);
+  {
+    std::lock_guard<std::mutex> lock(hdf5_mutex());
+    dataset.reset();
+  }
+  return MemorySeries(std::move(columns), instrument, freq, load_mode);
+}
+
+std::vector<iridium::data::TradeData::DataImpl::PartitionRead>
+iridium::data::TradeData::DataImpl::partition_reads(
+    const iridium::data::PartitionManifest &manifest,
+    const iridium::Instrument &instrument,
+    iridium::data::DataFreq freq) const {
+  auto partitions = manifest.partitions(instrument.name(), freq);
+  if (partitions.empty()) {
+    throw std::runtime_error(
+        "No partitions of " + dataset_name(instrument.name(), freq) + " in " + manifest.directory());
+  }
+  // rows to read of each partition, partitions outside the range and its warm-up are never opened
+  std::vector<std::optional<RowRange>> rows(partitions.size());
+  auto scope = load_scope(freq);
+  if (!scope) {
+    for (std::size_t i = 0; i < partitions.size(); ++i) rows[i] = RowRange{0, partitions[i].rows};
+  } else {
+    auto first = static_cast<std::size_t>(std::find_if(partitions.begin(), partitions.end(), [&scope](const auto &p) {
+      return p.last_time >= scope->begin;
+    }) - partitions.begin());
+    auto need = scope->warm_up;
+    for (auto i = first; i < partitions.size() && partitions[i].first_time <= scope->end; ++i) {
+      PartitionReader reader(manifest, partitions[i]);
+      auto range = FindRowRange(reader.dataset(), scope->begin, scope->end, 0);
+      if (i == first) {
+        auto warm_up = std::min(need, range.first);
+        range = {range.first - warm_up, range.count + warm_up};
+        need -= warm_up;
+      }
+      rows[i] = range;
+    }
+    for (auto i = first; i-- > 0 && need > 0;) {
+      auto warm_up = std::min(need, partitions[i].rows);
+      rows[i] = RowRange{partitions[i].rows - warm_up, warm_up};
+      need -= warm_up;
+    }
+  }
+  std::vector<PartitionRead> reads;
+  for (std::size_t i = 0; i < partitions.size(); ++i) {
+    if (rows[i] && rows[i]->count > 0) {
+      reads.push_back({partitions[i], *rows[i]});
+    }
+  }
+  return reads;
+}
+
+std::shared_ptr<iridium::data::CandleSeries>
+iridium::data::TradeData::DataImpl::LoadPartitions(
+    const iridium::data::PartitionManifest &manifest,
+    const iridium::Instrument &instrument,
+    iridium::data::DataFreq freq,
+    iridium::data::LoadMode load_mode) const {
+  std::vector<std::shared_ptr<CandleColumns>> parts;
+  for (const auto &read : partition_reads(manifest, instrument, freq)) {
+    PartitionReader reader(manifest, read.partition);
+    parts.push_back(ReadColumns(reader.dataset(), read.rows));
+  }
+  return MemorySeries(ConcatColumns(std::move(parts)), instrument, freq, load_mode);
+}
+
+std::shared_ptr<iridium::data::CandleColumns>
+iridium::data::TradeData::DataImpl::ConcatColumns(std::vector<std::shared_ptr<CandleColumns>> parts) {
+  if (parts.size() == 1) {
+    return std::move(parts.front());
+  }
+  auto columns = std::make_shared<CandleColumns>();
+  std::size_t size = 0;
+  for (const auto &part : parts) size += part->size();
+  columns->reserve(size);
+  for (const auto &part : parts) {
+    auto append = [](auto &to, const auto &from) { to.insert(to.end(), from.begin(), from.end()); };
+    append(columns->times, part->times);
+    append(columns->opens, part->opens);
+    append(columns->closes, part->closes);
+    append(columns->highs, part->highs);
+    append(columns->lows, part->lows);
+    append(columns->volumes, part->volumes);
+  }
+  return columns;
+}
+
+std::shared_ptr<iridium::data::CandleSeries>
+iridium::data::TradeData::DataImpl::MemorySeries(
+    std::shared_ptr<CandleColumns> columns,
+    const iridium::Instrument &instrument,
+    iridium::data::DataFreq freq,
+    iridium::data::LoadMode load_mode) {
+  if (load_mode == LoadMode::kCompressed) {
+    return std::make_shared<CompressedCandleSeries>(*columns, freq, pip_point(instrument) + 1);
+  }
+  if (load_mode == LoadMode::kFixedPoint) {
+    return std::make_shared<FixedPointSeries>(*columns, freq, PriceScale(instrument));
+  }
+  return std::make_shared<ColumnSeries>(std::move(columns), freq);
+}
+
+std::size_t iridium::data::TradeData::DataImpl::lower_row(
+    const iridium::data::CandleSeries &series,
+    std::time_t time) {
+  std::size_t first = 0;
+  std::size_t count = series.size();
+  while (count > 0) {
+    auto step = count / 2;
+    if (series.window(first + step, 1).times()[0] < time) {
+      first += step + 1;
+      count -= step + 1;
+    } else {
+      count = step;
+    }
+  }
+  return first;
+}
+
+std::optional<iridium::data::TradeData::DataImpl::LoadScope>
+iridium::data::TradeData::DataImpl::load_scope(iridium::data::DataFreq freq) const {
+  if (!range_) {
+    return std::nullopt;
+  }
+  if (!resampled_) {
+    return LoadScope{range_->begin, range_->end, warm_up_bars_};
+  }
+  // a bar of the coarsest frequency holds at most coarsest / freq stored bars, one more covers a partial bar
+  auto coarsest = *std::max_element(freqs_.begin(), freqs_.end());
+  return LoadScope{range_->begin, range_->end + coarsest,
+                   (warm_up_bars_ + 1) * static_cast<std::size_t>(coarsest / freq)};
+}
+
+std::optional<iridium::data::RowRange>
+iridium::data::TradeData::DataImpl::scoped_rows(const H5::DataSet &dataset, iridium::data::DataFreq freq) const {
+  auto scope = load_scope(freq);
+  if (!scope) {
+    return std::nullopt;
+  }
+  return FindRowRange(dataset, scope->begin, scope->end, scope->warm_up);
+}
+
+std::shared_ptr<iridium::data::CandleSeries>
+iridium::data::TradeData::DataImpl::ResampleSeries(
+    const iridium::data::CandleColumnsView &m1,
+    const std::shared_ptr<const std::vector<std::time_t>> &trade_starts,
+    const iridium::Instrument &instrument,
+    iridium::data::DataFreq freq,
+    iridium::data::LoadMode load_mode) {
+  return MemorySeries(Resampler(freq, trade_starts).Resample(m1), instrument, freq, load_mode);
+}
+
+void iridium::data::TradeData::DataImpl::OpenHdf5(
+    const std::string &file_name,
+    const std::vector<DataFreq> &freqs,
+    iridium::data::LoadMode load_mode) {
   using H5::H5File;
-  using H5::CompType;
-  using H5::PredType;
   using H5::DataSet;
   using H5::FileIException;
   using H5::DataSetIException;
 
   try {
     file_ = std::make_unique<H5File>(file_name, H5F_ACC_RDONLY);
-    // Dataset & time indices in memory
-    CompType time_index_type(sizeof(int));
-    time_index_type.insertMember("time", 0, PredType::NATIVE_INT);
-    for (auto &instrument : instruments) {
+    // opening is metadata only and stays on this thread, reads and decoding run on the pool
+    std::vector<std::shared_ptr<DataSet>> datasets;
+    for (auto &instrument : instruments_) {
       for (auto &freq : freqs) {
-        auto name = instrument->name() + "_" + DataFreqToString(freq);
-        auto dataset_name = "/instruments/" + name;
-        auto dataset = std::make_shared<DataSet>(file_->openDataSet(dataset_name));
-        datasets_[name] = dataset;
-        auto size = dataset->getSpace().getSimpleExtentNpoints();
-        auto times = std::make_shared<std::vector<int>>(size);
-        dataset->read(times->data(), time_index_type);
-        time_indices_[name] = times;
+        auto name = dataset_name(instrument->name(), freq);
+        datasets.push_back(OpenCandleDataSet(*file_, name));
       }
     }
-    // CompType candlestick history data
-    candlestick_type_ = CompType(sizeof(Candlestick));
-    candlestick_type_.insertMember("time", HOFFSET(Candlestick, time), PredType::NATIVE_INT);
-    candlestick_type_.insertMember("open", HOFFSET(Candlestick, open), PredType::NATIVE_DOUBLE);
-    candlestick_type_.insertMember("close", HOFFSET(Candlestick, close), PredType::NATIVE_DOUBLE);
-    candlestick_type_.insertMember("high", HOFFSET(Candlestick, high), PredType::NATIVE_DOUBLE);
-    candlestick_type_.insertMember("low", HOFFSET(Candlestick, low), PredType::NATIVE_DOUBLE);
-    candlestick_type_.insertMember("volume", HOFFSET(Candlestick, volume), PredType::NATIVE_INT);
+    ParallelFor(datasets.size(), [&](std::size_t i) {
+      auto start = std::chrono::steady_clock::now();
+      const auto &instrument = instruments_[i / freqs.size()];
+      auto freq = freqs[i % freqs.size()];
+      auto name = dataset_name(instrument->name(), freq);
+      AddSeries(name, LoadHdf5(std::move(datasets[i]), *instrument, freq, load_mode), start);
+    });
   } catch (FileIException const &err) {
     throw err;
   } catch (DataSetIException const &err) {
@@ -261,6 +1177,184 @@ iridium::data::TradeData::DataImpl::DataImpl(
   }
 }
 
+void iridium::data::TradeData::DataImpl::OpenNative(
+    const std::string &directory,
+    const std::vector<DataFreq> &freqs) {
+  ParallelFor(instruments_.size() * freqs.size(), [&](std::size_t i) {
+    auto start = std::chrono::steady_clock::now();
+    const auto &instrument = instruments_[i / freqs.size()];
+    auto freq = freqs[i % freqs.size()];
+    auto path = boost::filesystem::path(directory) / candle_file_name(instrument->name(), freq);
+    AddSeries(dataset_name(instrument->name(), freq), std::make_shared<MappedCandleSeries>(path.string()), start);
+  });
+}
+
+void iridium::data::TradeData::DataImpl::OpenSharedMemory(
+    const std::string &prefix,
+    const std::vector<DataFreq> &freqs) {
+  ParallelFor(instruments_.size() * freqs.size(), [&](std::size_t i) {
+    auto start = std::chrono::steady_clock::now();
+    const auto &instrument = instruments_[i / freqs.size()];
+    auto freq = freqs[i % freqs.size()];
+    AddSeries(dataset_name(instrument->name(), freq), AttachShmSeries(prefix, instrument->name(), freq), start);
+  });
+}
+
+void iridium::data::TradeData::DataImpl::OpenPartitioned(
+    const std::string &directory,
+    const std::vector<DataFreq> &freqs,
+    iridium::data::LoadMode load_mode) {
+  PartitionManifest manifest(directory);
+  auto start = std::chrono::steady_clock::now();
+  auto count = instruments_.size() * freqs.size();
+  std::vector<std::vector<PartitionRead>> reads(count);
+  ParallelFor(count, [&](std::size_t i) {
+    reads[i] = partition_reads(manifest, *instruments_[i / freqs.size()], freqs[i % freqs.size()]);
+  });
+  // partitions are separate files, every partition of every instrument/frequency is one task of a single pool
+  std::vector<std::vector<std::shared_ptr<CandleColumns>>> parts(count);
+  std::vector<std::pair<std::size_t, std::size_t>> tasks;
+  for (std::size_t i = 0; i < count; ++i) {
+    parts[i].resize(reads[i].size());
+    for (std::size_t j = 0; j < reads[i].size(); ++j) tasks.emplace_back(i, j);
+  }
+  ParallelFor(tasks.size(), [&](std::size_t task) {
+    auto [i, j] = tasks[task];
+    PartitionReader reader(manifest, reads[i][j].partition);
+    parts[i][j] = ReadColumns(reader.dataset(), reads[i][j].rows);
+  });
+  ParallelFor(count, [&](std::size_t i) {
+    const auto &instrument = instruments_[i / freqs.size()];
+    auto freq = freqs[i % freqs.size()];
+    auto series = MemorySeries(ConcatColumns(std::move(parts[i])), *instrument, freq, load_mode);
+    AddSeries(dataset_name(instrument->name(), freq), std::move(series), start);
+  });
+}
+
+void iridium::data::TradeData::DataImpl::OpenSwmr(
+    const std::string &file_name,
+    const std::vector<DataFreq> &freqs) {
+  {
+    std::lock_guard<std::mutex> lock(hdf5_mutex());
+    file_ = std::make_unique<H5::H5File>(file_name, H5F_ACC_RDONLY | H5F_ACC_SWMR_READ);
+  }
+  ParallelFor(instruments_.size() * freqs.size(), [&](std::size_t i) {
+    auto start = std::chrono::steady_clock::now();
+    const auto &instrument = instruments_[i / freqs.size()];
+    auto freq = freqs[i % freqs.size()];
+    auto name = dataset_name(instrument->name(), freq);
+    AddSeries(name, std::make_shared<SwmrSeries>(OpenCandleDataSet(*file_, name), freq), start);
+  });
+}
+
+std::size_t iridium::data::TradeData::DataImpl::Refresh() {
+  if (!swmr_read_) {
+    throw std::logic_error("Refresh needs TradeDataOptions::swmr_read");
+  }
+  std::size_t rows = 0;
+  for (auto &[name, series] : series_) {
+    auto added = std::static_pointer_cast<SwmrSeries>(series)->Refresh();
+    if (added == 0) continue;
+    rows += added;
+    // the next range query rebuilds the pyramid over every bar
+    auto extrema = extrema_.find(name);
+    if (extrema != extrema_.end()) {
+      extrema->second = std::make_unique<SeriesExtrema>();
+    }
+  }
+  return rows;
+}
+
+void iridium::data::TradeData::DataImpl::LoadQuotes(const std::vector<DataFreq> &freqs) {
+  std::vector<std::shared_ptr<H5::DataSet>> datasets(instruments_.size() * freqs.size());
+  {
+    std::lock_guard<std::mutex> lock(hdf5_mutex());
+    if (H5Lexists(file_->getId(), "/quotes", H5P_DEFAULT) <= 0) {
+      return;
+    }
+    for (std::size_t i = 0; i < datasets.size(); ++i) {
+      auto path = quote_dataset_path(dataset_name(instruments_[i / freqs.size()]->name(), freqs[i % freqs.size()]));
+      if (H5Lexists(file_->getId(), path.c_str(), H5P_DEFAULT) > 0) {
+        datasets[i] = std::make_shared<H5::DataSet>(file_->openDataSet(path));
+      }
+    }
+  }
+  for (auto &freq : freqs) {
+    dense_quotes_[freq].resize(instruments_.size());
+  }
+  ParallelFor(datasets.size(), [&](std::size_t i) {
+    if (!datasets[i]) return;
+    const auto &instrument = instruments_[i / freqs.size()];
+    auto freq = freqs[i % freqs.size()];
+    auto quotes = ReadQuotes(*datasets[i]);
+    {
+      std::lock_guard<std::mutex> lock(hdf5_mutex());
+      datasets[i].reset();
+    }
+    dense_quotes_.at(freq)[i / freqs.size()] = std::make_shared<QuoteSeries>(
+        quotes.first, quotes.second, freq, pip_point(*instrument) + 1);
+  });
+}
+
+void iridium::data::TradeData::DataImpl::Resample(
+    const std::string &region,
+    iridium::data::LoadMode load_mode) {
+  ParallelFor(instruments_.size(), [&](std::size_t i) {
+    auto start = std::chrono::steady_clock::now();
+    const auto &instrument = instruments_[i];
+    std::shared_ptr<CandleSeries> m1_series;
+    {
+      std::lock_guard<std::mutex> lock(load_mutex_);
+      m1_series = series(instrument->name(), DataFreq::m1);
+    }
+    auto m1 = m1_series->window(0, m1_series->size());
+    CandleColumnsView columns{m1.times(), m1.opens(), m1.closes(), m1.highs(), m1.lows(), m1.volumes()};
+    auto trade_starts = trade_start_times(columns.times, region);
+    for (auto &freq : freqs_) {
+      if (freq == DataFreq::m1) continue;
+      AddSeries(dataset_name(instrument->name(), freq),
+                ResampleSeries(columns, trade_starts, *instrument, freq, load_mode), start);
+      start = std::chrono::steady_clock::now();
+    }
+  });
+}
+
+void iridium::data::TradeData::DataImpl::ParallelFor(
+    std::size_t count,
+    const std::function<void(std::size_t)> &task) const {
+  std::exception_ptr error = nullptr;
+  std::mutex error_mutex;
+  boost::asio::thread_pool pool(std::max<std::size_t>(std::min(load_threads_, count), 1));
+  for (std::size_t i = 0; i < count; ++i) {
+    boost::asio::post(pool, [&, i]() {
+      try {
+        task(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) error = std::current_exception();
+      }
+    });
+  }
+  pool.join();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void iridium::data::TradeData::DataImpl::AddSeries(
+    const std::string &name,
+    std::shared_ptr<CandleSeries> series,
+    std::chrono::steady_clock::time_point start) {
+  auto rows = series->size();
+  std::lock_guard<std::mutex> lock(load_mutex_);
+  series_[name] = std::move(series);
+  ++loaded_;
+  if (progress_) {
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    progress_({name, loaded_, load_total_, rows, elapsed.count()});
+  }
+}
+
 std::string
 iridium::data::TradeData::DataImpl::dataset_name(
     const std::string &instrument_name,
@@ -268,137 +1362,240 @@ iridium::data::TradeData::DataImpl::dataset_name(
   return instrument_name + "_" + DataFreqToString(freq);
 }
 
-std::shared_ptr<H5::DataSet>
-iridium::data::TradeData::DataImpl::instrument_dataset(
+std::shared_ptr<iridium::data::CandleSeries>
+iridium::data::TradeData::DataImpl::series(
     const std::string &instrument_name,
     iridium::data::DataFreq freq) const {
-  return datasets_.at(dataset_name(instrument_name, freq));
+  return series_.at(dataset_name(instrument_name, freq));
 }
 
-std::shared_ptr<std::vector<int>>
-iridium::data::TradeData::DataImpl::time_indices(
+const iridium::data::CandleSeries *
+iridium::data::TradeData::DataImpl::find_series(
     const std::string &instrument_name,
     iridium::data::DataFreq freq) const {
-  return time_indices_.at(dataset_name(instrument_name, freq));
+  auto it = series_.find(dataset_name(instrument_name, freq));
+  return it == series_.end() ? nullptr : it->second.get();
+}
+
+const std::vector<std::shared_ptr<iridium::data::CandleSeries>> &
+iridium::data::TradeData::DataImpl::dense_series(iridium::data::DataFreq freq) const {
+  return dense_series_.at(freq);
+}
+
+const std::vector<std::shared_ptr<iridium::data::QuoteSeries>> *
+iridium::data::TradeData::DataImpl::dense_quotes(iridium::data::DataFreq freq) const {
+  auto it = dense_quotes_.find(freq);
+  return it == dense_quotes_.end() ? nullptr : &it->second;
+}
+
+const std::vector<std::shared_ptr<iridium::Instrument>> &
+iridium::data::TradeData::DataImpl::instruments() const noexcept {
+  return instruments_;
+}
+
+bool iridium::data::TradeData::DataImpl::lock_free() const noexcept {
+  return lock_free_;
+}
+
+bool iridium::data::TradeData::DataImpl::fixed_point() const noexcept {
+  return fixed_point_;
 }
 
 int iridium::data::TradeData::DataImpl::time_index(
     const std::string &instrument_name,
     std::time_t time,
     iridium::data::DataFreq freq) const {
-  using iridium::algorithm::BinarySearch;
-  auto index = BinarySearch(
-      *(time_indices(instrument_name, freq).get()),
-      static_cast<int>(time),
-      true);
-  if (index == -1) {
+  return series(instrument_name, freq)->row_index(time);
+}
+
+iridium::data::HistoryWindow
+iridium::data::TradeData::DataImpl::history_window_(
+    const std::string &instrument_name,
+    int end_index,
+    int count,
+    iridium::data::DataFreq freq) const {
+  auto begin_index = end_index - count + 1;
+  if (end_index == kNoBar || begin_index < 0) {
     throw std::out_of_range("Candlestick Data Not Found");
-  } else {
-    return index;
   }
+  return series(instrument_name, freq)->window(begin_index, count);
 }
 
-std::shared_ptr<iridium::data::DataList>
-iridium::data::TradeData::DataImpl::history_data_(
+const iridium::data::TradeData::DataImpl::SeriesExtrema &
+iridium::data::TradeData::DataImpl::series_extrema(
     const std::string &instrument_name,
+    iridium::data::DataFreq freq) const {
+  auto &extrema = *extrema_.at(dataset_name(instrument_name, freq));
+  std::call_once(extrema.once, [&] {
+    auto series = this->series(instrument_name, freq);
+    // a whole window views the stored columns, kCompressed decodes them, disk reads would load everything
+    if (!series->in_memory()) {
+      throw std::logic_error("Range queries need bars held in memory, not read with kOnDemand or kStreaming");
+    }
+    extrema.window = series->window(0, series->size());
+    extrema.extrema = std::make_unique<RangeExtrema>(extrema.window.highs(), extrema.window.lows());
+  });
+  return extrema;
+}
+
+std::optional<std::pair<std::size_t, std::size_t>>
+iridium::data::TradeData::DataImpl::row_range(
+    const iridium::data::TradeData::DataImpl::SeriesExtrema &extrema,
     std::time_t begin,
-    int count,
-    iridium::data::DataFreq freq,
-    bool reversed = false) const {
-  using H5::DataSpace;
-  auto begin_index = time_index(instrument_name, begin, freq);
-  hsize_t data_start[] =
-      {static_cast<hsize_t>(reversed ? begin_index : begin_index - count + 1)};
-  hsize_t data_count[] = {static_cast<hsize_t>(count)};
-  hsize_t data_stride[] = {1};
-  hsize_t data_block[] = {1};
-  auto dataset = instrument_dataset(instrument_name, freq);
-  auto fspace = dataset->getSpace();
-  fspace.selectHyperslab(
-      H5S_SELECT_SET,
-      data_count,
-      data_start,
-      data_stride,
-      data_block);
-  auto candles = std::make_shared<std::vector<data::Candlestick>>(count);
-  hsize_t m_dim[1] = {static_cast<hsize_t>(count)};
-  DataSpace mspace(1, m_dim);
-  dataset->read(
-      candles->data(),
-      candlestick_type_,
-      mspace,
-      fspace);
-  std::sort(std::begin(*candles),
-            std::end(*candles),
-            [](auto c1, auto c2) {
-              return c1.time < c2.time;
-            });
-  return candles;
+    std::time_t end) {
+  auto times = extrema.window.times();
+  auto first = static_cast<std::size_t>(std::lower_bound(times.begin(), times.end(), begin) - times.begin());
+  auto last = static_cast<std::size_t>(std::upper_bound(times.begin(), times.end(), end) - times.begin());
+  if (first >= last) {
+    return std::nullopt;
+  }
+  return std::make_pair(first, last - 1);
 }
 
 // TradeData public methods
 iridium::data::TradeData::TradeData(
     const std::string &file_name,
     const InstrumentList &instruments,
-    const std::vector<DataFreq> &freqs) :
-    pimpl_(std::move(std::make_unique<DataImpl>(file_name, instruments, freqs))) {}
+    const std::vector<DataFreq> &freqs,
+    const TradeDataOptions &options) :
+    pimpl_(std::move(std::make_unique<DataImpl>(file_name, instruments, freqs, options))) {}
 
 iridium::data::TradeData::~TradeData() = default;
 
+bool iridium::data::TradeData::lock_free_reads() const noexcept {
+  return pimpl_->lock_free();
+}
+
+std::size_t iridium::data::TradeData::Refresh() {
+  return pimpl_->Refresh();
+}
+
+bool iridium::data::TradeData::has_bar(
+    const std::string &instrument_name,
+    std::time_t time,
+    iridium::data::DataFreq freq) const {
+  auto series = pimpl_->find_series(instrument_name, freq);
+  return series != nullptr && series->has_bar(time);
+}
+
 std::optional<iridium::data::Candlestick>
-iridium::data::TradeData::candlestick_data(
+iridium::data::TradeData::try_candle(
     const std::string &instrument_name,
     std::time_t time,
     iridium::data::DataFreq freq) const {
-  try {
-    return history_data(instrument_name, time, 1, freq)->front();
-  } catch (...) {
+  auto series = pimpl_->find_series(instrument_name, freq);
+  if (series == nullptr) {
     return std::nullopt;
   }
+  auto index = series->row_index(time);
+  if (index == kNoBar) {
+    return std::nullopt;
+  }
+  return series->window(index, 1).front();
 }
 
-std::shared_ptr<iridium::data::TickDataMap>
+std::optional<iridium::data::Candlestick>
 iridium::data::TradeData::candlestick_data(
-    const iridium::InstrumentList &instruments,
+    const std::string &instrument_name,
     std::time_t time,
     iridium::data::DataFreq freq) const {
-  auto data_map =
-      std::make_shared<std::map<std::string, std::optional<iridium::data::Candlestick>>>();
-  for (const auto &instrument : instruments) {
-    data_map->insert(
-        {instrument->name(),
-         candlestick_data(instrument->name(), time, freq)});
+  return try_candle(instrument_name, time, freq);
+}
+
+iridium::data::MarketSnapshot iridium::data::TradeData::market_snapshot() const {
+  return MarketSnapshot(pimpl_->instruments(), pimpl_->fixed_point());
+}
+
+void iridium::data::TradeData::FillSnapshot(
+    std::time_t time,
+    iridium::data::DataFreq freq,
+    iridium::data::MarketSnapshot &snapshot) const {
+  const auto &instruments = pimpl_->instruments();
+  const auto &dense = pimpl_->dense_series(freq);
+  const auto *quotes = pimpl_->dense_quotes(freq);
+  snapshot.Reset(time);
+  for (std::size_t id = 0; id < snapshot.size(); ++id) {
+    const auto &instrument = snapshot.instruments()[id];
+    if (id < instruments.size() && instruments[id] == instrument) {
+      if (auto index = dense[id]->row_index(time); index != kNoBar) {
+        snapshot.Set(static_cast<int>(id), dense[id]->window(index, 1).front());
+      }
+      if (quotes && (*quotes)[id]) {
+        if (auto row = (*quotes)[id]->row_index(time); row != kNoBar) {
+          snapshot.SetQuote(static_cast<int>(id), (*quotes)[id]->quote(row));
+        }
+      }
+    } else if (auto candle = candlestick_data(instrument->name(), time, freq)) {
+      snapshot.Set(static_cast<int>(id), *candle);
+    }
   }
-  return data_map;
 }
 
-std::shared_ptr<iridium::data::DataList>
-iridium::data::TradeData::history_data_date_range(
+iridium::data::HistoryWindow
+iridium::data::TradeData::history_window(
+    const std::string &instrument_name,
+    std::time_t end,
+    int count,
+    iridium::data::DataFreq freq) const {
+  return pimpl_->history_window_(
+      instrument_name,
+      pimpl_->time_index(instrument_name, end, freq),
+      count,
+      freq);
+}
+
+iridium::data::HistoryWindow
+iridium::data::TradeData::history_window_date_range(
     const std::string &instrument_name,
     std::time_t begin,
     std::time_t end,
     iridium::data::DataFreq freq) const {
   auto begin_index = pimpl_->time_index(instrument_name, begin, freq);
   auto end_index = pimpl_->time_index(instrument_name, end, freq);
-  return pimpl_->history_data_(
+  if (begin_index == kNoBar) {
+    throw std::out_of_range("Candlestick Data Not Found");
+  }
+  return pimpl_->history_window_(
       instrument_name,
-      begin,
-      begin_index - end_index + 1,
+      end_index,
+      end_index - begin_index + 1,
       freq);
 }
 
+iridium::data::HistoryWindowList
+iridium::data::TradeData::history_windows(
+    const InstrumentList &instruments,
+    std::time_t end,
+    int count,
+    iridium::data::DataFreq freq) const {
+  HistoryWindowList windows;
+  windows.reserve(instruments.size());
+  for (const auto &instrument : instruments) {
+    auto end_index = pimpl_->time_index(instrument->name(), end, freq);
+    if (end_index == kNoBar) {
+      throw std::out_of_range("Candlestick Data Not Found");
+    }
+    windows.push_back(pimpl_->history_window_(instrument->name(), end_index - 1, count, freq));
+  }
+  return windows;
+}
+
+std::shared_ptr<iridium::data::DataList>
+iridium::data::TradeData::history_data_date_range(
+    const std::string &instrument_name,
+    std::time_t begin,
+    std::time_t end,
+    iridium::data::DataFreq freq) const {
+  return history_window_date_range(instrument_name, begin, end, freq).data_list();
+}
+
 std::shared_ptr<iridium::data::DataList>
 iridium::data::TradeData::history_data(
     const std::string &instrument_name,
     std::time_t end,
     int count,
     iridium::data::DataFreq freq) const {
-  return pimpl_->history_data_(
-      instrument_name,
-      end,
-      count,
-      freq,
-      true);
+  return history_window(instrument_name, end, count, freq).data_list();
 }
 
 std::shared_ptr<iridium::data::DataListMap>
@@ -408,10 +1605,108 @@ iridium::data::TradeData::history_data(
     int count,
     iridium::data::DataFreq freq) const {
   auto hist_data_map = std::make_shared<DataListMap>();
-  for (const auto &instrument : instruments) {
-    auto hist_data = history_data(instrument->name(), end, count + 1, freq);
-    hist_data->pop_back();
-    hist_data_map->insert({instrument->name(), hist_data});
+  auto windows = history_windows(instruments, end, count, freq);
+  for (std::size_t i = 0; i < instruments.size(); ++i) {
+    hist_data_map->insert({instruments.at(i)->name(), windows.at(i).data_list()});
   }
   return hist_data_map;
 }
+
+iridium::data::Panel
+iridium::data::TradeData::panel(
+    const InstrumentList &instruments,
+    std::time_t begin,
+    std::time_t end,
+    iridium::data::DataFreq freq,
+    iridium::data::CandleField field,
+    bool forward_fill) const {
+  // one window per instrument, one row earlier to seed the forward fill
+  std::vector<HistoryWindow> windows;
+  std::vector<std::optional<double>> seeds(instruments.size());
+  windows.reserve(instruments.size());
+  std::vector<std::time_t> times;
+  for (std::size_t i = 0; i < instruments.size(); ++i) {
+    auto series = pimpl_->series(instruments[i]->name(), freq);
+    auto first = DataImpl::lower_row(*series, begin);
+    auto last = end < std::numeric_limits<std::time_t>::max() ? DataImpl::lower_row(*series, end + 1) : series->size();
+    HistoryWindow window;
+    if (forward_fill && first > 0 && first <= last) {
+      window = series->window(first - 1, last - first + 1);
+      seeds[i] = candle_field(window.front(), field);
+      window = window.sub_window(1, last - first);
+    } else if (last > first) {
+      window = series->window(first, last - first);
+    }
+    std::vector<std::time_t> merged;
+    merged.reserve(times.size() + window.size());
+    std::set_union(times.begin(), times.end(), window.times().begin(), window.times().end(),
+                   std::back_inserter(merged));
+    times.swap(merged);
+    windows.push_back(std::move(window));
+  }
+  Panel panel(std::move(times), instruments.size());
+  for (std::size_t i = 0; i < windows.size(); ++i) {
+    panel.FillColumn(i, windows[i], field, forward_fill, seeds[i]);
+  }
+  return panel;
+}
+
+std::optional<double>
+iridium::data::TradeData::highest_high(
+    const std::string &instrument_name,
+    std::time_t begin,
+    std::time_t end,
+    iridium::data::DataFreq freq) const {
+  const auto &extrema = pimpl_->series_extrema(instrument_name, freq);
+  auto rows = DataImpl::row_range(extrema, begin, end);
+  if (!rows) {
+    return std::nullopt;
+  }
+  return extrema.extrema->max_high(rows->first, rows->second);
+}
+
+std::optional<double>
+iridium::data::TradeData::lowest_low(
+    const std::string &instrument_name,
+    std::time_t begin,
+    std::time_t end,
+    iridium::data::DataFreq freq) const {
+  const auto &extrema = pimpl_->series_extrema(instrument_name, freq);
+  auto rows = DataImpl::row_range(extrema, begin, end);
+  if (!rows) {
+    return std::nullopt;
+  }
+  return extrema.extrema->min_low(rows->first, rows->second);
+}
+
+std::optional<std::time_t>
+iridium::data::TradeData::first_high_at_or_above(
+    const std::string &instrument_name,
+    std::time_t after,
+    double price,
+    iridium::data::DataFreq freq) const {
+  const auto &extrema = pimpl_->series_extrema(instrument_name, freq);
+  auto times = extrema.window.times();
+  auto first = static_cast<std::size_t>(std::upper_bound(times.begin(), times.end(), after) - times.begin());
+  auto row = extrema.extrema->first_high_at_or_above(first, price);
+  if (row == times.size()) {
+    return std::nullopt;
+  }
+  return times[row];
+}
+
+std::optional<std::time_t>
+iridium::data::TradeData::first_low_at_or_below(
+    const std::string &instrument_name,
+    std::time_t after,
+    double price,
+    iridium::data::DataFreq freq) const {
+  const auto &extrema = pimpl_->series_extrema(instrument_name, freq);
+  auto times = extrema.window.times();
+  auto first = static_cast<std::size_t>(std::upper_bound(times.begin(), times.end(), after) - times.begin());
+  auto row = extrema.extrema->first_low_at_or_below(first, price);
+  if (row == times.size()) {
+    return std::nullopt;
+  }
+  return times[row];
+}
@@ -0,0 +1,67 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <iridium/fixed_point_store.hpp>
+#include <stdexcept>
+
+iridium::data::FixedPointSeries::FixedPointSeries(
+    const iridium::data::CandleColumns &columns,
+    iridium::data::DataFreq freq,
+    const iridium::data::PriceScale &scale) :
+    scale_(scale),
+    time_index_(columns.times, freq) {
+  auto rounded = std::make_shared<CandleColumns>();
+  rounded->times = columns.times;
+  rounded->volumes = columns.volumes;
+  auto pipettes = [this](const std::vector<double> &prices, std::vector<double> &rounded_prices) {
+    std::vector<Pipettes> column(prices.size());
+    rounded_prices.resize(prices.size());
+    for (std::size_t i = 0; i < prices.size(); ++i) {
+      column[i] = scale_.pipettes(prices[i]);
+      rounded_prices[i] = scale_.price(column[i]);
+    }
+    return column;
+  };
+  opens_ = pipettes(columns.opens, rounded->opens);
+  closes_ = pipettes(columns.closes, rounded->closes);
+  highs_ = pipettes(columns.highs, rounded->highs);
+  lows_ = pipettes(columns.lows, rounded->lows);
+  columns_ = rounded;
+}
+
+std::size_t iridium::data::FixedPointSeries::size() const {
+  return columns_->size();
+}
+
+int iridium::data::FixedPointSeries::row_index(std::time_t time) const {
+  return time_index_.row(time);
+}
+
+iridium::data::HistoryWindow
+iridium::data::FixedPointSeries::window(std::size_t first, std::size_t count) const {
+  if (first + count > size()) throw std::out_of_range("Candlestick Data Not Found");
+  return HistoryWindow(columns_, first, count);
+}
+
+iridium::data::FixedCandlestick
+iridium::data::FixedPointSeries::fixed_candlestick(std::size_t row) const noexcept {
+  return {columns_->times[row], opens_[row], closes_[row], highs_[row], lows_[row], columns_->volumes[row]};
+}
+
+const iridium::data::PriceScale &iridium::data::FixedPointSeries::price_scale() const noexcept {
+  return scale_;
+}
+
+std::size_t iridium::data::FixedPointSeries::memory_usage() const noexcept {
+  return size() * (sizeof(std::time_t) + 4 * sizeof(Pipettes) + 4 * sizeof(double) + sizeof(int)) +
+      time_index_.memory_usage();
+}
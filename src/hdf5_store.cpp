@@ -0,0 +1,713 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <iridium/hdf5_store.hpp>
+#include <zlib.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+/*
+ * Row count and time order of a candlestick dataset, stored by descending time unless created
+ * by CreateAppendableCandles
+ */
+struct StoredRows {
+  std::size_t size;
+  bool ascending;
+
+  /*
+   * return the first stored row of ascending rows
+   */
+  [[nodiscard]]
+  std::size_t start(iridium::data::RowRange rows) const {
+    return ascending ? rows.first : size - rows.first - rows.count;
+  }
+};
+
+/*
+ * the caller holds hdf5_mutex
+ */
+static StoredRows GetStoredRows(const H5::DataSet &dataset) {
+  return {static_cast<std::size_t>(dataset.getSpace().getSimpleExtentNpoints()),
+          H5Aexists(dataset.getId(), iridium::data::kAscendingAttribute) > 0};
+}
+
+/*
+ * read a single compound member of rows of a dataset
+ */
+template<typename T>
+static std::vector<T> ReadMember(
+    const H5::DataSet &dataset,
+    const std::string &member,
+    const H5::PredType &type,
+    StoredRows stored,
+    iridium::data::RowRange rows) {
+  H5::CompType member_type(sizeof(T));
+  member_type.insertMember(member, 0, type);
+  std::vector<T> column(rows.count);
+  if (rows.count == 0) {
+    return column;
+  }
+  if (rows.first == 0 && rows.count == stored.size) {
+    dataset.read(column.data(), member_type);
+  } else {
+    auto fspace = dataset.getSpace();
+    hsize_t start[] = {static_cast<hsize_t>(stored.start(rows))};
+    hsize_t count[] = {static_cast<hsize_t>(rows.count)};
+    fspace.selectHyperslab(H5S_SELECT_SET, count, start);
+    H5::DataSpace mspace(1, count);
+    dataset.read(column.data(), member_type, mspace, fspace);
+  }
+  if (!stored.ascending) {
+    std::reverse(column.begin(), column.end());
+  }
+  return column;
+}
+
+/*
+ * return the first of rows whose time is not before bound, or after it if upper. The rows are halved with
+ * single time reads until kTimeSearchRows remain, those are read at once. The caller holds hdf5_mutex.
+ */
+static std::size_t TimeBound(
+    const H5::DataSet &dataset,
+    StoredRows stored,
+    iridium::data::RowRange rows,
+    std::time_t bound,
+    bool upper) {
+  auto before = [bound, upper](std::time_t time) {
+    return upper ? time <= bound : time < bound;
+  };
+  auto first = rows.first;
+  auto last = rows.first + rows.count;
+  while (last - first > iridium::data::kTimeSearchRows) {
+    auto middle = first + (last - first) / 2;
+    auto time = ReadMember<std::time_t>(dataset, "time", H5::PredType::NATIVE_INT64, stored, {middle, 1});
+    if (before(time.front())) {
+      first = middle + 1;
+    } else {
+      last = middle;
+    }
+  }
+  auto times = ReadMember<std::time_t>(dataset, "time", H5::PredType::NATIVE_INT64, stored, {first, last - first});
+  return first + static_cast<std::size_t>(std::partition_point(times.begin(), times.end(), before) - times.begin());
+}
+
+/*
+ * Rows per block when a dataset is read as whole rows
+ */
+constexpr std::size_t kRowBlockRows = 65536;
+
+/*
+ * file layout of a chunked candlestick dataset the direct chunk path can decode
+ */
+struct DirectChunkLayout {
+  std::size_t chunk_rows;
+  std::size_t row_size;
+  // offsets of time, open, close, high, low and volume in a row
+  std::size_t offsets[6];
+  std::vector<H5Z_filter_t> filters;
+};
+
+/*
+ * return the layout of a dataset the direct chunk path can decode, std::nullopt otherwise,
+ * the caller holds hdf5_mutex
+ */
+static std::optional<DirectChunkLayout> FindDirectChunkLayout(const H5::DataSet &dataset) {
+  if (H5Tget_order(H5T_NATIVE_DOUBLE) != H5T_ORDER_LE || H5Tget_order(H5T_NATIVE_INT64) != H5T_ORDER_LE) {
+    return std::nullopt;
+  }
+  auto plist = dataset.getCreatePlist();
+  if (plist.getLayout() != H5D_CHUNKED || plist.getChunk(0, nullptr) != 1) {
+    return std::nullopt;
+  }
+  DirectChunkLayout layout{};
+  hsize_t chunk_rows;
+  plist.getChunk(1, &chunk_rows);
+  layout.chunk_rows = static_cast<std::size_t>(chunk_rows);
+  for (int i = 0; i < plist.getNfilters(); ++i) {
+    unsigned int flags, filter_config;
+    std::size_t cd_nelmts = 0;
+    char name[64];
+    auto filter = plist.getFilter(i, flags, cd_nelmts, nullptr, sizeof(name), name, filter_config);
+    if (filter != H5Z_FILTER_DEFLATE && filter != H5Z_FILTER_SHUFFLE && filter != H5Z_FILTER_FLETCHER32) {
+      return std::nullopt;
+    }
+    layout.filters.push_back(filter);
+  }
+  if (dataset.getTypeClass() != H5T_COMPOUND) {
+    return std::nullopt;
+  }
+  auto type = dataset.getCompType();
+  layout.row_size = type.getSize();
+  const char *members[] = {"time", "open", "close", "high", "low", "volume"};
+  for (int i = 0; i < 6; ++i) {
+    auto index = H5Tget_member_index(type.getId(), members[i]);
+    if (index < 0) {
+      return std::nullopt;
+    }
+    auto member_class = type.getMemberClass(index);
+    auto member_type = type.getMemberDataType(index);
+    auto expected_class = i == 0 || i == 5 ? H5T_INTEGER : H5T_FLOAT;
+    auto expected_size = i == 5 ? sizeof(int) : std::size_t{8};
+    if (member_class != expected_class || member_type.getSize() != expected_size ||
+        H5Tget_order(member_type.getId()) != H5T_ORDER_LE) {
+      return std::nullopt;
+    }
+    layout.offsets[i] = type.getMemberOffset(index);
+  }
+  return layout;
+}
+
+/*
+ * undo the filters of a raw chunk, last to first, skipping those the filter mask marks as not applied
+ */
+static void DecodeChunk(
+    std::vector<std::uint8_t> &chunk,
+    std::uint32_t filter_mask,
+    const DirectChunkLayout &layout,
+    std::vector<std::uint8_t> &scratch) {
+  for (auto i = layout.filters.size(); i-- > 0;) {
+    if (filter_mask & (1u << i)) continue;
+    switch (layout.filters[i]) {
+      case H5Z_FILTER_FLETCHER32:
+        // the checksum trails the chunk
+        if (chunk.size() < 4) throw std::runtime_error("Truncated HDF5 chunk");
+        chunk.resize(chunk.size() - 4);
+        break;
+      case H5Z_FILTER_DEFLATE: {
+        scratch.resize(layout.chunk_rows * layout.row_size);
+        auto size = static_cast<uLongf>(scratch.size());
+        if (uncompress(scratch.data(), &size, chunk.data(), static_cast<uLong>(chunk.size())) != Z_OK) {
+          throw std::runtime_error("Unable to inflate HDF5 chunk");
+        }
+        scratch.resize(size);
+        chunk.swap(scratch);
+        break;
+      }
+      case H5Z_FILTER_SHUFFLE: {
+        // byte b of every row is stored together, trailing bytes of a partial row are not shuffled
+        auto rows = chunk.size() / layout.row_size;
+        scratch.resize(chunk.size());
+        for (std::size_t b = 0; b < layout.row_size; ++b) {
+          const auto *from = chunk.data() + b * rows;
+          for (std::size_t r = 0; r < rows; ++r) {
+            scratch[r * layout.row_size + b] = from[r];
+          }
+        }
+        std::copy(chunk.begin() + rows * layout.row_size, chunk.end(), scratch.begin() + rows * layout.row_size);
+        chunk.swap(scratch);
+        break;
+      }
+      default:
+        throw std::runtime_error("Unsupported HDF5 filter");
+    }
+  }
+}
+
+/*
+ * read rows of a chunked dataset chunk by chunk, only H5Dread_chunk holds hdf5_mutex
+ */
+static void ReadChunksDirect(
+    const H5::DataSet &dataset,
+    StoredRows stored,
+    iridium::data::RowRange rows,
+    const DirectChunkLayout &layout,
+    iridium::data::CandleColumns &columns) {
+  // ascending row a is stored at size - 1 - a by descending time
+  auto lo = stored.start(rows);
+  auto hi = lo + rows.count;
+  std::vector<std::uint8_t> chunk, scratch;
+  for (auto c = lo / layout.chunk_rows; c * layout.chunk_rows < hi; ++c) {
+    hsize_t offset[] = {static_cast<hsize_t>(c * layout.chunk_rows)};
+    std::uint32_t filter_mask = 0;
+    {
+      std::lock_guard<std::mutex> lock(iridium::data::hdf5_mutex());
+      hsize_t bytes = 0;
+      if (H5Dget_chunk_storage_size(dataset.getId(), offset, &bytes) < 0) {
+        throw std::runtime_error("Unable to locate HDF5 chunk");
+      }
+      chunk.resize(bytes);
+      if (bytes > 0 && H5Dread_chunk(dataset.getId(), H5P_DEFAULT, offset, &filter_mask, chunk.data()) < 0) {
+        throw std::runtime_error("Unable to read HDF5 chunk");
+      }
+    }
+    auto first = std::max(lo, c * layout.chunk_rows);
+    auto last = std::min(hi, (c + 1) * layout.chunk_rows);
+    if (chunk.empty()) {
+      // chunks never written hold the fill value
+      chunk.assign(layout.chunk_rows * layout.row_size, 0);
+    } else {
+      DecodeChunk(chunk, filter_mask, layout, scratch);
+    }
+    if (chunk.size() < (last - c * layout.chunk_rows) * layout.row_size) {
+      throw std::runtime_error("Truncated HDF5 chunk");
+    }
+    for (auto j = first; j < last; ++j) {
+      const auto *row = chunk.data() + (j - c * layout.chunk_rows) * layout.row_size;
+      auto a = stored.ascending ? j - rows.first : stored.size - 1 - j - rows.first;
+      std::memcpy(&columns.times[a], row + layout.offsets[0], sizeof(std::time_t));
+      std::memcpy(&columns.opens[a], row + layout.offsets[1], sizeof(double));
+      std::memcpy(&columns.closes[a], row + layout.offsets[2], sizeof(double));
+      std::memcpy(&columns.highs[a], row + layout.offsets[3], sizeof(double));
+      std::memcpy(&columns.lows[a], row + layout.offsets[4], sizeof(double));
+      std::memcpy(&columns.volumes[a], row + layout.offsets[5], sizeof(int));
+    }
+  }
+}
+
+/*
+ * read rows of a dataset as whole rows in blocks, the caller holds hdf5_mutex
+ */
+static void ReadRowBlocks(
+    const H5::DataSet &dataset,
+    StoredRows stored,
+    iridium::data::RowRange rows,
+    iridium::data::CandleColumns &columns) {
+  auto type = iridium::data::candlestick_type();
+  std::vector<iridium::data::Candlestick> block;
+  auto fspace = dataset.getSpace();
+  for (std::size_t done = 0; done < rows.count;) {
+    auto count = std::min(kRowBlockRows, rows.count - done);
+    // by descending time, the block of ascending rows first + done ... is stored in reverse
+    // ending at size - 1 - first - done
+    hsize_t start[] = {static_cast<hsize_t>(stored.start({rows.first + done, count}))};
+    hsize_t counts[] = {static_cast<hsize_t>(count)};
+    fspace.selectHyperslab(H5S_SELECT_SET, counts, start);
+    H5::DataSpace mspace(1, counts);
+    block.resize(count);
+    dataset.read(block.data(), type, mspace, fspace);
+    for (std::size_t i = 0; i < count; ++i) {
+      const auto &candle = block[stored.ascending ? i : count - 1 - i];
+      auto a = done + i;
+      columns.times[a] = candle.time;
+      columns.opens[a] = candle.open;
+      columns.closes[a] = candle.close;
+      columns.highs[a] = candle.high;
+      columns.lows[a] = candle.low;
+      columns.volumes[a] = candle.volume;
+    }
+    done += count;
+  }
+}
+
+/*
+ * create a dataset holding rows, chunked and packed with a layout, replacing one of the same path,
+ * the caller holds hdf5_mutex
+ */
+template<typename Row>
+static void WriteRows(
+    H5::H5File &file,
+    const std::string &group,
+    const std::string &path,
+    const std::vector<Row> &rows,
+    const H5::CompType &type,
+    H5::CompType file_type,
+    const std::optional<iridium::data::ChunkLayout> &layout) {
+  if (H5Lexists(file.getId(), group.c_str(), H5P_DEFAULT) <= 0) {
+    file.createGroup(group);
+  }
+  if (H5Lexists(file.getId(), path.c_str(), H5P_DEFAULT) > 0) {
+    file.unlink(path);
+  }
+  hsize_t dims[1] = {static_cast<hsize_t>(rows.size())};
+  if (!layout) {
+    H5::DataSpace space(1, dims);
+    auto dataset = file.createDataSet(path, type, space);
+    if (!rows.empty()) dataset.write(rows.data(), type);
+    return;
+  }
+  // unlimited, so chunked datasets can be appended to
+  hsize_t max_dims[1] = {H5S_UNLIMITED};
+  H5::DataSpace space(1, dims, max_dims);
+  H5::DSetCreatPropList plist;
+  hsize_t chunk[1] = {static_cast<hsize_t>(std::max<std::size_t>(layout->chunk_rows, 1))};
+  plist.setChunk(1, chunk);
+  if (layout->shuffle) plist.setShuffle();
+  if (layout->deflate_level > 0) plist.setDeflate(layout->deflate_level);
+  file_type.pack();
+  auto dataset = file.createDataSet(path, file_type, space, plist);
+  if (!rows.empty()) dataset.write(rows.data(), type);
+}
+
+/*
+ * row layout of quote datasets
+ */
+struct QuoteRow {
+  std::int64_t time;
+  double bid_open;
+  double bid_close;
+  double bid_high;
+  double bid_low;
+  double ask_open;
+  double ask_close;
+  double ask_high;
+  double ask_low;
+  int volume;
+};
+
+static H5::CompType QuoteRowType() {
+  using H5::PredType;
+  H5::CompType type(sizeof(QuoteRow));
+  type.insertMember("time", HOFFSET(QuoteRow, time), PredType::NATIVE_INT64);
+  type.insertMember("bid_open", HOFFSET(QuoteRow, bid_open), PredType::NATIVE_DOUBLE);
+  type.insertMember("bid_close", HOFFSET(QuoteRow, bid_close), PredType::NATIVE_DOUBLE);
+  type.insertMember("bid_high", HOFFSET(QuoteRow, bid_high), PredType::NATIVE_DOUBLE);
+  type.insertMember("bid_low", HOFFSET(QuoteRow, bid_low), PredType::NATIVE_DOUBLE);
+  type.insertMember("ask_open", HOFFSET(QuoteRow, ask_open), PredType::NATIVE_DOUBLE);
+  type.insertMember("ask_close", HOFFSET(QuoteRow, ask_close), PredType::NATIVE_DOUBLE);
+  type.insertMember("ask_high", HOFFSET(QuoteRow, ask_high), PredType::NATIVE_DOUBLE);
+  type.insertMember("ask_low", HOFFSET(QuoteRow, ask_low), PredType::NATIVE_DOUBLE);
+  type.insertMember("volume", HOFFSET(QuoteRow, volume), PredType::NATIVE_INT);
+  return type;
+}
+
+std::string iridium::data::instrument_dataset_path(const std::string &dataset_name) {
+  return "/instruments/" + dataset_name;
+}
+
+std::string iridium::data::quote_dataset_path(const std::string &dataset_name) {
+  return "/quotes/" + dataset_name;
+}
+
+/*
+ * return the names of the objects of a group of the file, none if the group does not exist
+ */
+static std::vector<std::string> ListGroup(const H5::H5File &file, const std::string &group_name) {
+  std::vector<std::string> names;
+  if (H5Lexists(file.getId(), group_name.c_str(), H5P_DEFAULT) <= 0) {
+    return names;
+  }
+  auto group = file.openGroup(group_name);
+  for (hsize_t i = 0; i < group.getNumObjs(); ++i) {
+    names.push_back(group.getObjnameByIdx(i));
+  }
+  return names;
+}
+
+std::vector<std::string> iridium::data::ListCandleDataSets(const H5::H5File &file) {
+  return ListGroup(file, "/instruments");
+}
+
+std::vector<std::string> iridium::data::ListQuoteDataSets(const H5::H5File &file) {
+  return ListGroup(file, "/quotes");
+}
+
+std::optional<std::pair<std::string, iridium::data::DataFreq>>
+iridium::data::SplitDataSetName(const std::string &dataset_name) {
+  auto sep = dataset_name.rfind('_');
+  if (sep == std::string::npos) {
+    return std::nullopt;
+  }
+  return std::make_pair(dataset_name.substr(0, sep), StringToDataFreq(dataset_name.substr(sep + 1)));
+}
+
+std::mutex &iridium::data::hdf5_mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+H5::CompType iridium::data::candlestick_type() {
+  using H5::CompType;
+  using H5::PredType;
+  CompType type(sizeof(Candlestick));
+  type.insertMember("time", HOFFSET(Candlestick, time), PredType::NATIVE_INT64);
+  type.insertMember("open", HOFFSET(Candlestick, open), PredType::NATIVE_DOUBLE);
+  type.insertMember("close", HOFFSET(Candlestick, close), PredType::NATIVE_DOUBLE);
+  type.insertMember("high", HOFFSET(Candlestick, high), PredType::NATIVE_DOUBLE);
+  type.insertMember("low", HOFFSET(Candlestick, low), PredType::NATIVE_DOUBLE);
+  type.insertMember("volume", HOFFSET(Candlestick, volume), PredType::NATIVE_INT);
+  return type;
+}
+
+std::shared_ptr<H5::DataSet>
+iridium::data::OpenCandleDataSet(const H5::H5File &file, const std::string &dataset_name) {
+  std::lock_guard<std::mutex> lock(hdf5_mutex());
+  auto path = instrument_dataset_path(dataset_name);
+  auto dataset = std::make_shared<H5::DataSet>(file.openDataSet(path));
+  auto plist = dataset->getCreatePlist();
+  if (plist.getLayout() != H5D_CHUNKED || plist.getChunk(0, nullptr) != 1) {
+    return dataset;
+  }
+  hsize_t chunk_rows;
+  plist.getChunk(1, &chunk_rows);
+  auto chunk_bytes = static_cast<std::size_t>(chunk_rows) * dataset->getDataType().getSize();
+  H5::DSetAccPropList access;
+  // a prime number of hash slots, about 100 per cached chunk
+  access.setChunkCache(1601, kCachedChunks * chunk_bytes, 1.0);
+  dataset->close();
+  return std::make_shared<H5::DataSet>(file.openDataSet(path, access));
+}
+
+iridium::data::RowRange iridium::data::FindRowRange(
+    const H5::DataSet &dataset,
+    std::time_t begin,
+    std::time_t end,
+    std::size_t warm_up) {
+  std::lock_guard<std::mutex> lock(hdf5_mutex());
+  auto stored = GetStoredRows(dataset);
+  auto size = stored.size;
+  if (size == 0 || end < begin) {
+    return {0, 0};
+  }
+  auto first = TimeBound(dataset, stored, {0, size}, begin, false);
+  auto last = TimeBound(dataset, stored, {0, size}, end, true);
+  first = first > warm_up ? first - warm_up : 0;
+  return {first, last > first ? last - first : 0};
+}
+
+std::size_t iridium::data::FindRow(
+    const H5::DataSet &dataset,
+    iridium::data::RowRange rows,
+    std::time_t time) {
+  std::lock_guard<std::mutex> lock(hdf5_mutex());
+  return TimeBound(dataset, GetStoredRows(dataset), rows, time, false);
+}
+
+std::shared_ptr<iridium::data::CandleColumns>
+iridium::data::ReadColumns(const H5::DataSet &dataset) {
+  std::size_t size;
+  {
+    std::lock_guard<std::mutex> lock(hdf5_mutex());
+    size = dataset.getSpace().getSimpleExtentNpoints();
+  }
+  return ReadColumns(dataset, {0, size});
+}
+
+std::shared_ptr<iridium::data::CandleColumns>
+iridium::data::ReadColumns(const H5::DataSet &dataset, iridium::data::RowRange rows) {
+  auto columns = std::make_shared<CandleColumns>();
+  columns->times.resize(rows.count);
+  columns->opens.resize(rows.count);
+  columns->closes.resize(rows.count);
+  columns->highs.resize(rows.count);
+  columns->lows.resize(rows.count);
+  columns->volumes.resize(rows.count);
+  std::unique_lock<std::mutex> lock(hdf5_mutex());
+  auto stored = GetStoredRows(dataset);
+  if (rows.first + rows.count > stored.size) {
+    throw std::out_of_range("Candlestick rows out of range");
+  }
+  if (rows.count == 0) {
+    return columns;
+  }
+  auto layout = FindDirectChunkLayout(dataset);
+  if (!layout) {
+    ReadRowBlocks(dataset, stored, rows, *columns);
+    return columns;
+  }
+  lock.unlock();
+  ReadChunksDirect(dataset, stored, rows, *layout, *columns);
+  return columns;
+}
+
+std::pair<iridium::data::CandleColumns, iridium::data::CandleColumns>
+iridium::data::ReadQuotes(const H5::DataSet &dataset) {
+  std::vector<QuoteRow> rows;
+  {
+    std::lock_guard<std::mutex> lock(hdf5_mutex());
+    rows.resize(dataset.getSpace().getSimpleExtentNpoints());
+    dataset.read(rows.data(), QuoteRowType());
+  }
+  std::pair<CandleColumns, CandleColumns> quotes;
+  quotes.first.reserve(rows.size());
+  quotes.second.reserve(rows.size());
+  for (auto row = rows.rbegin(); row != rows.rend(); ++row) {
+    quotes.first.push_back({row->time, row->bid_open, row->bid_close, row->bid_high, row->bid_low, row->volume});
+    quotes.second.push_back({row->time, row->ask_open, row->ask_close, row->ask_high, row->ask_low, row->volume});
+  }
+  return quotes;
+}
+
+void iridium::data::WriteCandles(
+    H5::H5File &file,
+    const std::string &dataset_name,
+    const iridium::data::CandleColumns &columns,
+    std::optional<ChunkLayout> layout) {
+  std::vector<Candlestick> rows;
+  rows.reserve(columns.size());
+  for (auto i = columns.size(); i-- > 0;) {
+    rows.push_back(columns.candlestick(i));
+  }
+  std::lock_guard<std::mutex> lock(hdf5_mutex());
+  WriteRows(file, "/instruments", instrument_dataset_path(dataset_name), rows,
+            candlestick_type(), candlestick_type(), layout);
+}
+
+void iridium::data::CreateAppendableCandles(
+    H5::H5File &file,
+    const std::string &dataset_name,
+    const iridium::data::ChunkLayout &layout) {
+  std::lock_guard<std::mutex> lock(hdf5_mutex());
+  auto path = instrument_dataset_path(dataset_name);
+  WriteRows(file, "/instruments", path, std::vector<Candlestick>(), candlestick_type(), candlestick_type(), layout);
+  auto dataset = file.openDataSet(path);
+  std::uint8_t ascending = 1;
+  auto attribute = dataset.createAttribute(kAscendingAttribute, H5::PredType::NATIVE_UINT8, H5::DataSpace(H5S_SCALAR));
+  attribute.write(H5::PredType::NATIVE_UINT8, &ascending);
+}
+
+std::size_t iridium::data::AppendCandles(
+    const H5::DataSet &dataset,
+    const iridium::data::CandleColumns &columns) {
+  std::vector<Candlestick> rows;
+  rows.reserve(columns.size());
+  for (std::size_t i = 0; i < columns.size(); ++i) {
+    rows.push_back(columns.candlestick(i));
+  }
+  std::lock_guard<std::mutex> lock(hdf5_mutex());
+  auto stored = GetStoredRows(dataset);
+  if (!stored.ascending) {
+    throw std::invalid_argument("Candlesticks are only appended to datasets stored by ascending time");
+  }
+  if (rows.empty()) {
+    return stored.size;
+  }
+  hsize_t dims[] = {static_cast<hsize_t>(stored.size + rows.size())};
+  if (H5Dset_extent(dataset.getId(), dims) < 0) {
+    throw std::runtime_error("Unable to extend candlestick dataset");
+  }
+  auto fspace = dataset.getSpace();
+  hsize_t start[] = {static_cast<hsize_t>(stored.size)};
+  hsize_t count[] = {static_cast<hsize_t>(rows.size())};
+  fspace.selectHyperslab(H5S_SELECT_SET, count, start);
+  H5::DataSpace mspace(1, count);
+  dataset.write(rows.data(), candlestick_type(), mspace, fspace);
+  if (H5Dflush(dataset.getId()) < 0) {
+    throw std::runtime_error("Unable to flush appended candlesticks");
+  }
+  return stored.size + rows.size();
+}
+
+void iridium::data::WriteQuotes(
+    H5::H5File &file,
+    const std::string &dataset_name,
+    const iridium::data::CandleColumns &bid,
+    const iridium::data::CandleColumns &ask,
+    std::optional<ChunkLayout> layout) {
+  std::vector<QuoteRow> rows;
+  rows.reserve(bid.size());
+  for (auto i = bid.size(); i-- > 0;) {
+    rows.push_back({bid.times[i], bid.opens[i], bid.closes[i], bid.highs[i], bid.lows[i],
+                    ask.opens[i], ask.closes[i], ask.highs[i], ask.lows[i], bid.volumes[i]});
+  }
+  std::lock_guard<std::mutex> lock(hdf5_mutex());
+  WriteRows(file, "/quotes", quote_dataset_path(dataset_name), rows, QuoteRowType(), QuoteRowType(), layout);
+}
+
+// Hdf5Series
+iridium::data::Hdf5Series::Hdf5Series(
+    std::shared_ptr<H5::DataSet> dataset,
+    iridium::data::DataFreq freq,
+    std::shared_ptr<ChunkCache> cache,
+    std::optional<RowRange> rows) :
+    dataset_(std::move(dataset)),
+    candlestick_type_(candlestick_type()),
+    cache_(std::move(cache)),
+    cache_id_(ChunkCache::NextSeriesId()) {
+  std::vector<std::time_t> times;
+  {
+    std::lock_guard<std::mutex> lock(hdf5_mutex());
+    auto stored = GetStoredRows(*dataset_);
+    dataset_size_ = stored.size;
+    ascending_ = stored.ascending;
+    auto range = rows.value_or(RowRange{0, dataset_size_});
+    first_row_ = range.first;
+    size_ = range.count;
+    times = ReadMember<std::time_t>(*dataset_, "time", H5::PredType::NATIVE_INT64, stored, range);
+  }
+  time_index_ = TimeIndex(times, freq);
+}
+
+std::size_t iridium::data::Hdf5Series::size() const {
+  return size_;
+}
+
+int iridium::data::Hdf5Series::row_index(std::time_t time) const {
+  return time_index_.row(time);
+}
+
+iridium::data::HistoryWindow
+iridium::data::Hdf5Series::window(std::size_t first, std::size_t count) const {
+  if (first + count > size()) throw std::out_of_range("Candlestick Data Not Found");
+  if (!cache_) {
+    return HistoryWindow(ReadRows(first, count));
+  }
+  auto first_chunk = first / kChunkRows;
+  auto last_chunk = count == 0 ? first_chunk : (first + count - 1) / kChunkRows;
+  std::vector<std::shared_ptr<const CandleColumns>> chunks;
+  for (auto chunk = first_chunk; chunk <= last_chunk && chunk * kChunkRows < size(); ++chunk) {
+    chunks.push_back(cache_->Get(cache_id_, chunk, [this, chunk] {
+      auto chunk_first = chunk * kChunkRows;
+      auto rows = ReadRows(chunk_first, std::min(kChunkRows, size() - chunk_first));
+      auto columns = std::make_shared<CandleColumns>();
+      columns->reserve(rows.size());
+      for (const auto &row : rows) columns->push_back(row);
+      return columns;
+    }));
+  }
+  if (chunks.size() <= 1) {
+    auto chunk = chunks.empty() ? std::make_shared<const CandleColumns>() : chunks.front();
+    return HistoryWindow(chunk, count == 0 ? 0 : first - first_chunk * kChunkRows, count);
+  }
+  // window spans chunks, copy its rows into one set of columns
+  auto columns = std::make_shared<CandleColumns>();
+  columns->reserve(count);
+  for (auto row = first; row < first + count; ++row) {
+    const auto &chunk = *chunks[row / kChunkRows - first_chunk];
+    columns->push_back(chunk.candlestick(row % kChunkRows));
+  }
+  return HistoryWindow(columns, 0, count);
+}
+
+std::vector<iridium::data::Candlestick>
+iridium::data::Hdf5Series::ReadRows(std::size_t first, std::size_t count) const {
+  using H5::DataSpace;
+  hsize_t data_start[] = {static_cast<hsize_t>(StoredRows{dataset_size_, ascending_}.start({first_row_ + first, count}))};
+  hsize_t data_count[] = {static_cast<hsize_t>(count)};
+  hsize_t data_stride[] = {1};
+  hsize_t data_block[] = {1};
+  std::vector<Candlestick> candles(count);
+  if (count == 0) {
+    return candles;
+  }
+  {
+    std::lock_guard<std::mutex> lock(hdf5_mutex());
+    auto fspace = dataset_->getSpace();
+    fspace.selectHyperslab(
+        H5S_SELECT_SET,
+        data_count,
+        data_start,
+        data_stride,
+        data_block);
+    hsize_t m_dim[1] = {static_cast<hsize_t>(count)};
+    DataSpace mspace(1, m_dim);
+    dataset_->read(
+        candles.data(),
+        candlestick_type_,
+        mspace,
+        fspace);
+  }
+  std::sort(std::begin(candles),
+            std::end(candles),
+            [](auto c1, auto c2) {
+              return c1.time < c2.time;
+            });
+  return candles;
+}
+
+bool iridium::data::Hdf5Series::lock_free() const noexcept {
+  return false;
+}
+
+bool iridium::data::Hdf5Series::in_memory() const {
+  return false;
+}
@@ -41,6 +41,10 @@ int iridium::pip_point(const iridium::Instrument &instrument) noexcept {
   return instrument.quote_name() == "JPY" ? 2 : 4;
 }
 
+double iridium::pip_size(const iridium::Instrument &instrument) noexcept {
+  return instrument.quote_name() == "JPY" ? 0.01 : 0.0001;
+}
+
 std::shared_ptr<iridium::InstrumentList>
 iridium::instrument_list(const std::initializer_list<std::string> &names) {
   auto instruments_ptr = std::make_shared<InstrumentList>();
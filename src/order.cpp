@@ -171,6 +171,14 @@ const std::shared_ptr<iridium::Instrument>
   return instrument_ptr_;
 }
 
+std::optional<int> iridium::LimitOrder::instrument_id() const noexcept {
+  return instrument_id_;
+}
+
+void iridium::LimitOrder::set_instrument_id(int id) noexcept {
+  instrument_id_ = id;
+}
+
 const std::shared_ptr<iridium::TakeProfitDetails>
 &iridium::LimitOrder::take_profit_details_ptr() const noexcept {
   return take_profit_details_ptr_;
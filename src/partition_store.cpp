@@ -0,0 +1,204 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <iridium/partition_store.hpp>
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+/*
+ * merge two sets of rows sorted by ascending time, rows of update win over rows of the same time in base
+ */
+static iridium::data::CandleColumns MergeCandles(
+    const iridium::data::CandleColumns &base,
+    const iridium::data::CandleColumns &update) {
+  iridium::data::CandleColumns merged;
+  merged.reserve(base.size() + update.size());
+  std::size_t i = 0, j = 0;
+  while (i < base.size() || j < update.size()) {
+    if (j == update.size() || (i < base.size() && base.times[i] < update.times[j])) {
+      merged.push_back(base.candlestick(i++));
+      continue;
+    }
+    if (i < base.size() && base.times[i] == update.times[j]) ++i;
+    merged.push_back(update.candlestick(j++));
+  }
+  return merged;
+}
+
+std::string iridium::data::partition_file_name(const std::string &instrument_name, DataFreq freq, int year) {
+  return instrument_name + "_" + DataFreqToString(freq) + "/" + std::to_string(year) + ".h5";
+}
+
+int iridium::data::utc_year(std::time_t time) {
+  std::tm tm{};
+  gmtime_r(&time, &tm);
+  return tm.tm_year + 1900;
+}
+
+// PartitionManifest
+iridium::data::PartitionManifest::PartitionManifest(std::string directory) : directory_(std::move(directory)) {
+  auto path = boost::filesystem::path(directory_) / kManifestFileName;
+  if (!boost::filesystem::exists(path)) {
+    return;
+  }
+  std::ifstream file(path.string());
+  std::string line;
+  std::getline(file, line);
+  while (std::getline(file, line)) {
+    if (line.empty()) continue;
+    std::vector<std::string> fields;
+    boost::split(fields, line, boost::is_any_of(","));
+    if (fields.size() != 6) {
+      throw std::runtime_error("Malformed partition manifest line: " + line);
+    }
+    partitions_.push_back({fields[0], StringToDataFreq(fields[1]), std::stoi(fields[2]),
+                           std::stoll(fields[3]), std::stoll(fields[4]), std::stoul(fields[5])});
+  }
+}
+
+const std::string &iridium::data::PartitionManifest::directory() const noexcept {
+  return directory_;
+}
+
+std::vector<iridium::data::Partition>
+iridium::data::PartitionManifest::partitions(const std::string &instrument_name, DataFreq freq) const {
+  std::vector<Partition> partitions;
+  std::copy_if(partitions_.begin(), partitions_.end(), std::back_inserter(partitions), [&](const auto &partition) {
+    return partition.instrument == instrument_name && partition.freq == freq;
+  });
+  std::sort(partitions.begin(), partitions.end(), [](const auto &a, const auto &b) { return a.year < b.year; });
+  return partitions;
+}
+
+const std::vector<iridium::data::Partition> &iridium::data::PartitionManifest::all() const noexcept {
+  return partitions_;
+}
+
+std::string iridium::data::PartitionManifest::path(const iridium::data::Partition &partition) const {
+  return (boost::filesystem::path(directory_) /
+      partition_file_name(partition.instrument, partition.freq, partition.year)).string();
+}
+
+void iridium::data::PartitionManifest::Update(const iridium::data::Partition &partition) {
+  auto it = std::find_if(partitions_.begin(), partitions_.end(), [&partition](const auto &p) {
+    return p.instrument == partition.instrument && p.freq == partition.freq && p.year == partition.year;
+  });
+  if (it == partitions_.end()) {
+    partitions_.push_back(partition);
+  } else {
+    *it = partition;
+  }
+}
+
+void iridium::data::PartitionManifest::Save() const {
+  auto path = boost::filesystem::path(directory_) / kManifestFileName;
+  auto tmp_path = path;
+  tmp_path += ".tmp";
+  {
+    std::ofstream file(tmp_path.string(), std::ios::trunc);
+    file << "instrument,freq,year,first_time,last_time,rows\n";
+    for (const auto &p : partitions_) {
+      file << p.instrument << "," << DataFreqToString(p.freq) << "," << p.year << ","
+           << p.first_time << "," << p.last_time << "," << p.rows << "\n";
+    }
+    if (!file.flush()) {
+      throw std::runtime_error("Unable to write partition manifest: " + tmp_path.string());
+    }
+  }
+  boost::filesystem::rename(tmp_path, path);
+}
+
+bool iridium::data::PartitionManifest::Exists(const std::string &directory) {
+  return boost::filesystem::exists(boost::filesystem::path(directory) / kManifestFileName);
+}
+
+// PartitionReader
+iridium::data::PartitionReader::PartitionReader(
+    const iridium::data::PartitionManifest &manifest,
+    const iridium::data::Partition &partition) {
+  std::lock_guard<std::mutex> lock(hdf5_mutex());
+  try {
+    file_ = std::make_unique<H5::H5File>(manifest.path(partition), H5F_ACC_RDONLY);
+    auto dataset_name = partition.instrument + "_" + DataFreqToString(partition.freq);
+    dataset_ = std::make_shared<H5::DataSet>(file_->openDataSet(instrument_dataset_path(dataset_name)));
+  } catch (...) {
+    file_.reset();
+    throw;
+  }
+}
+
+iridium::data::PartitionReader::~PartitionReader() {
+  std::lock_guard<std::mutex> lock(hdf5_mutex());
+  dataset_.reset();
+  file_.reset();
+}
+
+const H5::DataSet &iridium::data::PartitionReader::dataset() const noexcept {
+  return *dataset_;
+}
+
+void iridium::data::WritePartitions(
+    iridium::data::PartitionManifest &manifest,
+    const std::string &instrument_name,
+    iridium::data::DataFreq freq,
+    const iridium::data::CandleColumns &columns,
+    std::optional<ChunkLayout> layout) {
+  if (std::adjacent_find(columns.times.begin(), columns.times.end(), std::greater_equal<>()) != columns.times.end()) {
+    throw std::invalid_argument("Partition rows must ascend strictly: " + instrument_name);
+  }
+  auto dataset_name = instrument_name + "_" + DataFreqToString(freq);
+  auto existing = manifest.partitions(instrument_name, freq);
+  for (std::size_t first = 0; first < columns.size();) {
+    auto year = utc_year(columns.times[first]);
+    auto last = first;
+    while (last < columns.size() && utc_year(columns.times[last]) == year) ++last;
+    CandleColumns rows;
+    rows.reserve(last - first);
+    for (auto i = first; i < last; ++i) rows.push_back(columns.candlestick(i));
+    Partition partition{instrument_name, freq, year, 0, 0, 0};
+    auto path = boost::filesystem::path(manifest.path(partition));
+    auto stored = std::find_if(existing.begin(), existing.end(), [year](const auto &p) { return p.year == year; });
+    if (stored != existing.end() && boost::filesystem::exists(path)) {
+      std::shared_ptr<CandleColumns> base;
+      {
+        PartitionReader reader(manifest, *stored);
+        base = ReadColumns(reader.dataset());
+      }
+      rows = MergeCandles(*base, rows);
+    }
+    boost::filesystem::create_directories(path.parent_path());
+    auto tmp_path = path;
+    tmp_path += ".tmp";
+    {
+      std::unique_ptr<H5::H5File> file;
+      {
+        std::lock_guard<std::mutex> lock(hdf5_mutex());
+        file = std::make_unique<H5::H5File>(tmp_path.string(), H5F_ACC_TRUNC);
+      }
+      WriteCandles(*file, dataset_name, rows, layout);
+      std::lock_guard<std::mutex> lock(hdf5_mutex());
+      file.reset();
+    }
+    boost::filesystem::rename(tmp_path, path);
+    partition.first_time = rows.times.front();
+    partition.last_time = rows.times.back();
+    partition.rows = rows.size();
+    manifest.Update(partition);
+    first = last;
+  }
+  manifest.Save();
+}
@@ -0,0 +1,91 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <iridium/prefetch.hpp>
+#include <algorithm>
+
+iridium::data::WindowPrefetcher::WindowPrefetcher(
+    const iridium::data::TradeData &data,
+    const iridium::InstrumentList &instruments,
+    std::vector<std::time_t> ticks,
+    int count,
+    iridium::data::DataFreq freq,
+    std::size_t depth) :
+    data_(data),
+    instruments_(instruments),
+    ticks_(std::move(ticks)),
+    count_(count),
+    freq_(freq),
+    ring_(std::max<std::size_t>(depth, 1)),
+    head_(0),
+    tail_(0),
+    stopped_(false),
+    worker_(&WindowPrefetcher::Run, this) {}
+
+iridium::data::WindowPrefetcher::~WindowPrefetcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  not_full_.notify_all();
+  worker_.join();
+}
+
+iridium::data::HistoryWindowList iridium::data::WindowPrefetcher::windows(std::time_t tick) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    // head_ and tail_ count slots ever read and written, the ring index is modulo its size
+    not_empty_.wait(lock, [this] { return head_ != tail_ || tail_ == ticks_.size(); });
+    if (head_ == tail_) {
+      break;
+    }
+    auto &slot = ring_[head_ % ring_.size()];
+    if (slot.tick > tick) {
+      break;
+    }
+    auto windows = std::move(slot.windows);
+    auto error = slot.error;
+    auto slot_tick = slot.tick;
+    ++head_;
+    lock.unlock();
+    not_full_.notify_one();
+    if (slot_tick == tick) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+      return windows;
+    }
+    lock.lock();
+  }
+  lock.unlock();
+  return data_.history_windows(instruments_, tick, count_, freq_);
+}
+
+void iridium::data::WindowPrefetcher::Run() {
+  for (auto tick : ticks_) {
+    Slot slot{tick, {}, nullptr};
+    try {
+      slot.windows = data_.history_windows(instruments_, tick, count_, freq_);
+    } catch (...) {
+      slot.error = std::current_exception();
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this] { return stopped_ || tail_ - head_ < ring_.size(); });
+    if (stopped_) {
+      return;
+    }
+    ring_[tail_ % ring_.size()] = std::move(slot);
+    ++tail_;
+    lock.unlock();
+    not_empty_.notify_one();
+  }
+}
@@ -0,0 +1,45 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <iridium/price.hpp>
+#include <iridium/data.hpp>
+
+iridium::data::PriceScale::PriceScale(int price_decimals) :
+    decimals_(price_decimals),
+    scale_(std::pow(10.0, price_decimals)) {}
+
+iridium::data::PriceScale::PriceScale(const iridium::Instrument &instrument) :
+    PriceScale(pip_point(instrument) + 1) {}
+
+int iridium::data::PriceScale::decimals() const noexcept {
+  return decimals_;
+}
+
+iridium::data::FixedCandlestick
+iridium::data::PriceScale::pipettes(const iridium::data::Candlestick &candlestick) const noexcept {
+  return {candlestick.time,
+          pipettes(candlestick.open),
+          pipettes(candlestick.close),
+          pipettes(candlestick.high),
+          pipettes(candlestick.low),
+          candlestick.volume};
+}
+
+iridium::data::Candlestick
+iridium::data::PriceScale::candlestick(const iridium::data::FixedCandlestick &candlestick) const noexcept {
+  return {candlestick.time,
+          price(candlestick.open),
+          price(candlestick.close),
+          price(candlestick.high),
+          price(candlestick.low),
+          candlestick.volume};
+}
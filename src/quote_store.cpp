@@ -0,0 +1,121 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <iridium/quote_store.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+// QuoteSeries
+iridium::data::QuoteSeries::QuoteSeries(
+    const iridium::data::CandleColumns &bid,
+    const iridium::data::CandleColumns &ask,
+    iridium::data::DataFreq freq,
+    int price_decimals) :
+    scale_(price_decimals),
+    bid_(bid),
+    time_index_(bid.times, freq) {
+  if (bid.times != ask.times) {
+    throw std::invalid_argument("Bid and ask bars should have the same times");
+  }
+  auto spreads = [this](const std::vector<double> &bids, const std::vector<double> &asks) {
+    std::vector<Pipettes> spreads(bids.size());
+    for (std::size_t i = 0; i < bids.size(); ++i) {
+      spreads[i] = scale_.pipettes(asks[i] - bids[i]);
+    }
+    return spreads;
+  };
+  open_spreads_ = spreads(bid.opens, ask.opens);
+  close_spreads_ = spreads(bid.closes, ask.closes);
+  high_spreads_ = spreads(bid.highs, ask.highs);
+  low_spreads_ = spreads(bid.lows, ask.lows);
+}
+
+std::size_t iridium::data::QuoteSeries::size() const noexcept {
+  return bid_.size();
+}
+
+int iridium::data::QuoteSeries::row_index(std::time_t time) const {
+  return time_index_.row(time);
+}
+
+iridium::data::Quote iridium::data::QuoteSeries::quote(std::size_t row) const {
+  auto bid = bid_.candlestick(row);
+  auto ask = bid;
+  ask.open += scale_.price(open_spreads_[row]);
+  ask.close += scale_.price(close_spreads_[row]);
+  ask.high += scale_.price(high_spreads_[row]);
+  ask.low += scale_.price(low_spreads_[row]);
+  return {bid, ask};
+}
+
+std::size_t iridium::data::QuoteSeries::memory_usage() const noexcept {
+  auto row_bytes = sizeof(std::time_t) + 4 * sizeof(double) + sizeof(int) + 4 * sizeof(Pipettes);
+  return size() * row_bytes + time_index_.memory_usage();
+}
+
+// QuoteTickReader
+iridium::data::QuoteTickReader::QuoteTickReader(std::istream &input) :
+    input_(input),
+    lines_(0) {}
+
+std::optional<iridium::data::Quote> iridium::data::QuoteTickReader::Next() {
+  std::string line;
+  while (std::getline(input_, line)) {
+    ++lines_;
+    if (line.empty() || !std::isdigit(static_cast<unsigned char>(line.front()))) {
+      continue;
+    }
+    const char *begin = line.c_str();
+    char *end = nullptr;
+    std::time_t time = std::strtoll(begin, &end, 10);
+    // every field must parse and be followed by the delimiter before the next one is read
+    double prices[2];
+    auto parsed = end != begin;
+    for (auto &price : prices) {
+      if (!parsed || *end != ',') {
+        parsed = false;
+        break;
+      }
+      begin = end + 1;
+      price = std::strtod(begin, &end);
+      parsed = end != begin;
+    }
+    if (!parsed) {
+      throw std::runtime_error("Malformed tick at line " + std::to_string(lines_) + ": " + line);
+    }
+    auto bid = prices[0], ask = prices[1];
+    auto bar_time = time / DataFreq::m1 * DataFreq::m1;
+    if (forming_bar_ && forming_bar_->bid.time == bar_time) {
+      auto &bar = *forming_bar_;
+      bar.bid.close = bid;
+      bar.bid.high = std::max(bar.bid.high, bid);
+      bar.bid.low = std::min(bar.bid.low, bid);
+      bar.ask.close = ask;
+      bar.ask.high = std::max(bar.ask.high, ask);
+      bar.ask.low = std::min(bar.ask.low, ask);
+      ++bar.bid.volume;
+      ++bar.ask.volume;
+      continue;
+    }
+    auto completed = forming_bar_;
+    forming_bar_ = Quote{{bar_time, bid, bid, bid, bid, 1}, {bar_time, ask, ask, ask, ask, 1}};
+    if (completed) {
+      return completed;
+    }
+  }
+  auto completed = forming_bar_;
+  forming_bar_.reset();
+  return completed;
+}
@@ -0,0 +1,147 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <iridium/range_query.hpp>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+/*
+ * level 0 holds the extreme of every block, level k of every run of 2^k blocks
+ */
+template<typename Better>
+static std::vector<std::vector<double>> BuildLevels(iridium::algorithm::ColumnView<double> column, Better better) {
+  using iridium::data::kExtremaBlockRows;
+  auto blocks = (column.size() + kExtremaBlockRows - 1) / kExtremaBlockRows;
+  std::vector<std::vector<double>> levels;
+  if (blocks == 0) {
+    return levels;
+  }
+  auto &base = levels.emplace_back(blocks);
+  for (std::size_t b = 0; b < blocks; ++b) {
+    auto first = column.begin() + b * kExtremaBlockRows;
+    auto last = column.begin() + std::min(column.size(), (b + 1) * kExtremaBlockRows);
+    base[b] = *std::min_element(first, last, better);
+  }
+  for (std::size_t span = 2; span <= blocks; span *= 2) {
+    const auto &below = levels.back();
+    std::vector<double> level(blocks - span + 1);
+    for (std::size_t b = 0; b < level.size(); ++b) {
+      level[b] = better(below[b + span / 2], below[b]) ? below[b + span / 2] : below[b];
+    }
+    levels.push_back(std::move(level));
+  }
+  return levels;
+}
+
+template<typename Better>
+static double Extreme(
+    iridium::algorithm::ColumnView<double> column,
+    const std::vector<std::vector<double>> &levels,
+    std::size_t first,
+    std::size_t last,
+    Better better) {
+  using iridium::data::kExtremaBlockRows;
+  if (first > last || last >= column.size()) {
+    throw std::out_of_range("Extrema range out of range");
+  }
+  auto first_block = first / kExtremaBlockRows;
+  auto last_block = last / kExtremaBlockRows;
+  if (first_block == last_block) {
+    return *std::min_element(column.begin() + first, column.begin() + last + 1, better);
+  }
+  // partial blocks at both ends, whole blocks in between from two overlapping pyramid entries
+  auto extreme = *std::min_element(column.begin() + first, column.begin() + (first_block + 1) * kExtremaBlockRows, better);
+  auto tail = *std::min_element(column.begin() + last_block * kExtremaBlockRows, column.begin() + last + 1, better);
+  extreme = better(tail, extreme) ? tail : extreme;
+  if (first_block + 1 < last_block) {
+    auto blocks = last_block - first_block - 1;
+    std::size_t k = 0;
+    while ((std::size_t{2} << k) <= blocks) ++k;
+    auto left = levels[k][first_block + 1];
+    auto right = levels[k][last_block - (std::size_t{1} << k)];
+    extreme = better(left, extreme) ? left : extreme;
+    extreme = better(right, extreme) ? right : extreme;
+  }
+  return extreme;
+}
+
+/*
+ * first row from first on whose value is at least as extreme as price
+ */
+template<typename Better>
+static std::size_t FirstTouch(
+    iridium::algorithm::ColumnView<double> column,
+    const std::vector<std::vector<double>> &levels,
+    std::size_t first,
+    double price,
+    Better better) {
+  using iridium::data::kExtremaBlockRows;
+  auto touches = [&](double value) { return !better(price, value); };
+  if (first >= column.size()) {
+    return column.size();
+  }
+  auto block = first / kExtremaBlockRows;
+  auto block_end = std::min(column.size(), (block + 1) * kExtremaBlockRows);
+  for (auto row = first; row < block_end; ++row) {
+    if (touches(column[row])) return row;
+  }
+  // skip runs of untouched blocks from the largest run down
+  auto blocks = levels.empty() ? 0 : levels[0].size();
+  ++block;
+  for (auto k = levels.size(); k-- > 0;) {
+    auto span = std::size_t{1} << k;
+    if (block + span <= blocks && !touches(levels[k][block])) {
+      block += span;
+    }
+  }
+  if (block >= blocks) {
+    return column.size();
+  }
+  block_end = std::min(column.size(), (block + 1) * kExtremaBlockRows);
+  for (auto row = block * kExtremaBlockRows; row < block_end; ++row) {
+    if (touches(column[row])) return row;
+  }
+  return column.size();
+}
+
+iridium::data::RangeExtrema::RangeExtrema(
+    iridium::algorithm::ColumnView<double> highs,
+    iridium::algorithm::ColumnView<double> lows) :
+    highs_(highs),
+    lows_(lows),
+    high_levels_(BuildLevels(highs, std::greater<double>())),
+    low_levels_(BuildLevels(lows, std::less<double>())) {
+  if (highs.size() != lows.size()) {
+    throw std::invalid_argument("Highs and lows differ in size");
+  }
+}
+
+std::size_t iridium::data::RangeExtrema::size() const noexcept {
+  return highs_.size();
+}
+
+double iridium::data::RangeExtrema::max_high(std::size_t first, std::size_t last) const {
+  return Extreme(highs_, high_levels_, first, last, std::greater<double>());
+}
+
+double iridium::data::RangeExtrema::min_low(std::size_t first, std::size_t last) const {
+  return Extreme(lows_, low_levels_, first, last, std::less<double>());
+}
+
+std::size_t iridium::data::RangeExtrema::first_high_at_or_above(std::size_t first, double price) const {
+  return FirstTouch(highs_, high_levels_, first, price, std::greater<double>());
+}
+
+std::size_t iridium::data::RangeExtrema::first_low_at_or_below(std::size_t first, double price) const {
+  return FirstTouch(lows_, low_levels_, first, price, std::less<double>());
+}
@@ -0,0 +1,65 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <iridium/recorder.hpp>
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <iridium/storage.hpp>
+
+iridium::data::CandleRecorder::CandleRecorder(const std::string &directory, iridium::data::DataFreq freq) :
+    directory_(directory),
+    freq_(freq) {
+  boost::filesystem::create_directories(directory_);
+}
+
+iridium::data::DataFreq iridium::data::CandleRecorder::freq() const noexcept {
+  return freq_;
+}
+
+std::size_t iridium::data::CandleRecorder::Record(
+    const std::string &instrument_name,
+    const iridium::data::DataList &candlesticks) {
+  CandleColumns columns;
+  columns.reserve(candlesticks.size());
+  for (const auto &candlestick : candlesticks) {
+    columns.push_back(candlestick);
+  }
+  return AppendCandleFile(path(instrument_name), instrument_name, freq_, columns);
+}
+
+std::optional<std::time_t>
+iridium::data::CandleRecorder::last_time(const std::string &instrument_name) const {
+  auto file = path(instrument_name);
+  if (!boost::filesystem::exists(file)) {
+    return std::nullopt;
+  }
+  MappedCandleSeries series(file);
+  if (series.size() == 0) {
+    return std::nullopt;
+  }
+  return series.columns().times[series.size() - 1];
+}
+
+std::shared_ptr<iridium::data::DataList>
+iridium::data::CandleRecorder::tail(const std::string &instrument_name, std::size_t count) const {
+  auto file = path(instrument_name);
+  if (!boost::filesystem::exists(file)) {
+    return std::make_shared<DataList>();
+  }
+  MappedCandleSeries series(file);
+  count = std::min(count, series.size());
+  return series.window(series.size() - count, count).data_list();
+}
+
+std::string iridium::data::CandleRecorder::path(const std::string &instrument_name) const {
+  return (boost::filesystem::path(directory_) / candle_file_name(instrument_name, freq_)).string();
+}
@@ -0,0 +1,101 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <iridium/resample.hpp>
+#include <iridium/calendar.hpp>
+#include <algorithm>
+
+iridium::data::Resampler::Resampler(
+    iridium::data::DataFreq freq,
+    std::shared_ptr<const std::vector<std::time_t>> trade_starts) :
+    freq_(freq),
+    trade_starts_(std::move(trade_starts)),
+    day_(0) {}
+
+iridium::data::DataFreq iridium::data::Resampler::freq() const noexcept {
+  return freq_;
+}
+
+std::time_t iridium::data::Resampler::bar_time(std::time_t time) const noexcept {
+  const auto &starts = *trade_starts_;
+  // M1 candlesticks mostly arrive in the same trading day as the previous one
+  if (day_ >= starts.size() || time < starts[day_] || time >= starts[day_] + DataFreq::d) {
+    auto it = std::upper_bound(starts.begin(), starts.end(), time);
+    if (it == starts.begin()) {
+      return -1;
+    }
+    day_ = static_cast<std::size_t>(std::distance(starts.begin(), it) - 1);
+    if (time >= starts[day_] + DataFreq::d) {
+      return -1;
+    }
+  }
+  return starts[day_] + (time - starts[day_]) / freq_ * freq_;
+}
+
+std::optional<iridium::data::Candlestick>
+iridium::data::Resampler::Add(const iridium::data::Candlestick &candlestick) {
+  auto time = bar_time(candlestick.time);
+  if (time == -1) {
+    return std::nullopt;
+  }
+  if (forming_bar_ && forming_bar_->time == time) {
+    forming_bar_->close = candlestick.close;
+    forming_bar_->high = std::max(forming_bar_->high, candlestick.high);
+    forming_bar_->low = std::min(forming_bar_->low, candlestick.low);
+    forming_bar_->volume += candlestick.volume;
+    return std::nullopt;
+  }
+  auto completed = forming_bar_;
+  forming_bar_ = candlestick;
+  forming_bar_->time = time;
+  return completed;
+}
+
+const std::optional<iridium::data::Candlestick> &
+iridium::data::Resampler::forming_bar() const noexcept {
+  return forming_bar_;
+}
+
+std::shared_ptr<iridium::data::CandleColumns>
+iridium::data::Resampler::Resample(const iridium::data::CandleColumnsView &columns) {
+  auto bars = std::make_shared<CandleColumns>();
+  bars->reserve(columns.times.size() * DataFreq::m1 / freq_ + 1);
+  for (std::size_t i = 0; i < columns.times.size(); ++i) {
+    if (auto bar = Add({columns.times[i], columns.opens[i], columns.closes[i],
+                        columns.highs[i], columns.lows[i], columns.volumes[i]})) {
+      bars->push_back(*bar);
+    }
+  }
+  if (forming_bar_) {
+    bars->push_back(*forming_bar_);
+    forming_bar_.reset();
+  }
+  return bars;
+}
+
+std::shared_ptr<const std::vector<std::time_t>>
+iridium::data::trade_start_times(
+    const iridium::algorithm::ColumnView<std::time_t> &times,
+    const std::string &region) {
+  if (times.empty()) {
+    return std::make_shared<const std::vector<std::time_t>>();
+  }
+  // one day of margin on both sides covers every region offset
+  auto begin = static_cast<std::time_t>(times.front() - DataFreq::d);
+  auto end = static_cast<std::time_t>(times.back() + DataFreq::d);
+  auto begin_date = boost::posix_time::from_time_t(begin).date();
+  auto end_date = boost::posix_time::from_time_t(end).date();
+  return calendar::trade_start_times_ptr(
+      begin_date.year(), begin_date.month(), begin_date.day(),
+      end_date.year(), end_date.month(), end_date.day(),
+      region);
+}
@@ -0,0 +1,102 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <iridium/shm_store.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+std::string iridium::data::shm_segment_name(
+    const std::string &prefix,
+    const std::string &instrument_name,
+    iridium::data::DataFreq freq) {
+  return "/" + prefix + "_" + instrument_name + "_" + DataFreqToString(freq);
+}
+
+// ShmPublisher
+iridium::data::ShmPublisher::ShmPublisher(std::string prefix) :
+    prefix_(std::move(prefix)) {}
+
+iridium::data::ShmPublisher::~ShmPublisher() {
+#ifndef _WIN32
+  for (const auto &segment : segments_) {
+    ::shm_unlink(segment.c_str());
+  }
+#endif
+}
+
+void iridium::data::ShmPublisher::Publish(
+    const std::string &instrument_name,
+    iridium::data::DataFreq freq,
+    const iridium::data::CandleColumns &columns) {
+  auto name = shm_segment_name(prefix_, instrument_name, freq);
+#ifdef _WIN32
+  throw std::runtime_error("Shared memory candles are not supported on Windows: " + name);
+#else
+  auto header = candle_file_header(instrument_name, freq, columns.size(), columns.size());
+  auto size = candle_file_size(header);
+  // a fresh object, so processes attached to the previous one keep a consistent copy
+  ::shm_unlink(name.c_str());
+  auto fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd == -1) {
+    throw std::runtime_error("Unable to create shared memory: " + name);
+  }
+  if (::ftruncate(fd, static_cast<off_t>(size)) == -1) {
+    ::close(fd);
+    ::shm_unlink(name.c_str());
+    throw std::runtime_error("Unable to size shared memory: " + name);
+  }
+  auto addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) {
+    ::shm_unlink(name.c_str());
+    throw std::runtime_error("Unable to map shared memory: " + name);
+  }
+  CopyCandleFile(header, columns, static_cast<std::uint8_t *>(addr));
+  ::munmap(addr, size);
+  if (std::find(segments_.begin(), segments_.end(), name) == segments_.end()) {
+    segments_.push_back(name);
+  }
+#endif
+}
+
+const std::vector<std::string> &iridium::data::ShmPublisher::segments() const noexcept {
+  return segments_;
+}
+
+std::shared_ptr<iridium::data::MappedCandleSeries>
+iridium::data::AttachShmSeries(
+    const std::string &prefix,
+    const std::string &instrument_name,
+    iridium::data::DataFreq freq) {
+  auto name = shm_segment_name(prefix, instrument_name, freq);
+#ifdef _WIN32
+  throw std::runtime_error("Shared memory candles are not supported on Windows: " + name);
+#else
+  auto fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd == -1) {
+    throw std::runtime_error("Shared memory candles not published: " + name);
+  }
+  std::shared_ptr<MappedFile> file;
+  try {
+    file = std::make_shared<MappedFile>(fd, name);
+  } catch (...) {
+    ::close(fd);
+    throw;
+  }
+  ::close(fd);
+  return std::make_shared<MappedCandleSeries>(std::move(file), name);
+#endif
+}
@@ -0,0 +1,611 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <iridium/storage.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static int PopCount(std::uint64_t word) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_popcountll(word);
+#else
+  int count = 0;
+  for (; word != 0; word &= word - 1) ++count;
+  return count;
+#endif
+}
+
+// TimeIndex
+iridium::data::TimeIndex::TimeIndex(
+    const iridium::algorithm::ColumnView<std::time_t> &times,
+    iridium::data::DataFreq freq) :
+    freq_(freq),
+    size_(times.size()) {
+  for (std::size_t i = 0; i < times.size(); ++i) {
+    if (i == 0 || times[i] - times[i - 1] != freq_) {
+      run_times_.push_back(times[i]);
+      run_rows_.push_back(i);
+    }
+  }
+  run_times_.shrink_to_fit();
+  run_rows_.shrink_to_fit();
+  if (times.size() == 0) {
+    return;
+  }
+  // presence bitmap over the grid, skipped if a time is off the grid or the bitmap would outgrow
+  // the times themselves, i.e. more than 64 slots per bar beyond a fixed 8KB allowance
+  auto step = std::min<std::time_t>(freq_, DataFreq::h1);
+  auto origin = times[0];
+  auto slots = static_cast<std::size_t>((times[times.size() - 1] - origin) / step) + 1;
+  if (slots > 64 * times.size() + (std::size_t{1} << 16) || slots > (std::size_t{1} << 32)) {
+    return;
+  }
+  std::vector<std::uint64_t> present((slots + 63) / 64, 0);
+  for (std::size_t i = 0; i < times.size(); ++i) {
+    if ((times[i] - origin) % step != 0) {
+      return;
+    }
+    auto slot = static_cast<std::size_t>((times[i] - origin) / step);
+    present[slot >> 6] |= std::uint64_t{1} << (slot & 63);
+  }
+  ranks_.resize(present.size());
+  std::uint32_t rank = 0;
+  for (std::size_t w = 0; w < present.size(); ++w) {
+    ranks_[w] = rank;
+    rank += static_cast<std::uint32_t>(PopCount(present[w]));
+  }
+  present_ = std::move(present);
+  origin_ = origin;
+  step_ = step;
+}
+
+int iridium::data::TimeIndex::row(std::time_t time) const noexcept {
+  if (step_ == 0) {
+    return run_row(time);
+  }
+  if (time < origin_ || (time - origin_) % step_ != 0) {
+    return kNoBar;
+  }
+  auto slot = static_cast<std::size_t>((time - origin_) / step_);
+  if ((slot >> 6) >= present_.size()) {
+    return kNoBar;
+  }
+  auto word = present_[slot >> 6];
+  auto bit = std::uint64_t{1} << (slot & 63);
+  if ((word & bit) == 0) {
+    return kNoBar;
+  }
+  return static_cast<int>(ranks_[slot >> 6] + PopCount(word & (bit - 1)));
+}
+
+void iridium::data::TimeIndex::Append(const iridium::algorithm::ColumnView<std::time_t> &times) {
+  if (times.size() == 0) {
+    return;
+  }
+  if (size_ == 0) {
+    *this = TimeIndex(times, static_cast<DataFreq>(freq_));
+    return;
+  }
+  auto last = run_times_.back() + static_cast<std::time_t>(size_ - 1 - run_rows_.back()) * freq_;
+  if (times[0] <= last) {
+    throw std::invalid_argument("Appended times must follow the indexed times");
+  }
+  for (std::size_t i = 0; i < times.size(); ++i) {
+    if (times[i] - (i == 0 ? last : times[i - 1]) != freq_) {
+      run_times_.push_back(times[i]);
+      run_rows_.push_back(size_ + i);
+    }
+  }
+  size_ += times.size();
+  if (step_ == 0) {
+    return;
+  }
+  // same bounds as the constructor, the index falls back to the runs once they are exceeded
+  auto slots = static_cast<std::size_t>((times[times.size() - 1] - origin_) / step_) + 1;
+  auto on_grid = std::all_of(times.begin(), times.end(), [this](auto time) { return (time - origin_) % step_ == 0; });
+  if (!on_grid || slots > 64 * size_ + (std::size_t{1} << 16) || slots > (std::size_t{1} << 32)) {
+    step_ = 0;
+    present_.clear();
+    ranks_.clear();
+    return;
+  }
+  auto first_word = static_cast<std::size_t>((times[0] - origin_) / step_) >> 6;
+  present_.resize((slots + 63) / 64, 0);
+  ranks_.resize(present_.size());
+  for (std::size_t i = 0; i < times.size(); ++i) {
+    auto slot = static_cast<std::size_t>((times[i] - origin_) / step_);
+    present_[slot >> 6] |= std::uint64_t{1} << (slot & 63);
+  }
+  // words before first_word keep their ranks, first_word itself starts with the rows before it
+  std::uint32_t rank = first_word > 0
+      ? ranks_[first_word - 1] + static_cast<std::uint32_t>(PopCount(present_[first_word - 1]))
+      : 0;
+  for (auto w = first_word; w < present_.size(); ++w) {
+    ranks_[w] = rank;
+    rank += static_cast<std::uint32_t>(PopCount(present_[w]));
+  }
+}
+
+bool iridium::data::TimeIndex::contains(std::time_t time) const noexcept {
+  return row(time) != kNoBar;
+}
+
+std::size_t iridium::data::TimeIndex::run_count() const noexcept {
+  return run_times_.size();
+}
+
+bool iridium::data::TimeIndex::has_bitmap() const noexcept {
+  return step_ != 0;
+}
+
+std::size_t iridium::data::TimeIndex::memory_usage() const noexcept {
+  return run_times_.capacity() * sizeof(std::time_t) + run_rows_.capacity() * sizeof(std::size_t) +
+      present_.capacity() * sizeof(std::uint64_t) + ranks_.capacity() * sizeof(std::uint32_t);
+}
+
+int iridium::data::TimeIndex::run_row(std::time_t time) const noexcept {
+  auto it = std::upper_bound(run_times_.begin(), run_times_.end(), time);
+  if (it == run_times_.begin()) {
+    return kNoBar;
+  }
+  auto run = static_cast<std::size_t>(std::distance(run_times_.begin(), it) - 1);
+  auto offset = time - run_times_[run];
+  if (offset % freq_ != 0) {
+    return kNoBar;
+  }
+  auto row = run_rows_[run] + static_cast<std::size_t>(offset / freq_);
+  auto run_end = run + 1 < run_rows_.size() ? run_rows_[run + 1] : size_;
+  return row < run_end ? static_cast<int>(row) : kNoBar;
+}
+
+// ColumnSeries
+iridium::data::ColumnSeries::ColumnSeries(
+    std::shared_ptr<const CandleColumns> columns,
+    iridium::data::DataFreq freq) :
+    columns_(std::move(columns)),
+    time_index_(columns_->times, freq) {}
+
+std::size_t iridium::data::ColumnSeries::size() const {
+  return columns_->size();
+}
+
+int iridium::data::ColumnSeries::row_index(std::time_t time) const {
+  return time_index_.row(time);
+}
+
+iridium::data::HistoryWindow
+iridium::data::ColumnSeries::window(std::size_t first, std::size_t count) const {
+  if (first + count > size()) throw std::out_of_range("Candlestick Data Not Found");
+  return HistoryWindow(columns_, first, count);
+}
+
+const std::shared_ptr<const iridium::data::CandleColumns> &
+iridium::data::ColumnSeries::columns() const noexcept {
+  return columns_;
+}
+
+// LazySeries
+iridium::data::LazySeries::LazySeries(std::function<std::shared_ptr<CandleSeries>()> open) :
+    open_(std::move(open)),
+    opened_(false) {}
+
+std::size_t iridium::data::LazySeries::size() const {
+  return series().size();
+}
+
+int iridium::data::LazySeries::row_index(std::time_t time) const {
+  return series().row_index(time);
+}
+
+iridium::data::HistoryWindow
+iridium::data::LazySeries::window(std::size_t first, std::size_t count) const {
+  return series().window(first, count);
+}
+
+bool iridium::data::LazySeries::lock_free() const noexcept {
+  return false;
+}
+
+bool iridium::data::LazySeries::in_memory() const {
+  return series().in_memory();
+}
+
+bool iridium::data::LazySeries::opened() const noexcept {
+  return opened_;
+}
+
+const iridium::data::CandleSeries &iridium::data::LazySeries::series() const {
+  // a failed open leaves the flag unset and is retried on the next access
+  std::call_once(once_, [this] {
+    series_ = open_();
+    opened_ = true;
+  });
+  return *series_;
+}
+
+// ChunkCache
+iridium::data::ChunkCache::ChunkCache(std::size_t budget_bytes) :
+    budget_bytes_(budget_bytes),
+    cached_bytes_(0),
+    hits_(0),
+    misses_(0) {}
+
+std::shared_ptr<const iridium::data::CandleColumns>
+iridium::data::ChunkCache::Get(
+    std::uint64_t series_id,
+    std::size_t chunk,
+    const iridium::data::ChunkCache::Loader &load) {
+  Key key{series_id, chunk};
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (auto it = index_.find(key); it != index_.end()) {
+      entries_.splice(entries_.begin(), entries_, it->second);
+      ++hits_;
+      return it->second->columns;
+    }
+    ++misses_;
+  }
+  // load outside the lock, two threads missing the same chunk both read it
+  auto columns = load();
+  auto bytes = columns->size() * (sizeof(std::time_t) + 4 * sizeof(double) + sizeof(int));
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (auto it = index_.find(key); it != index_.end()) {
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return it->second->columns;
+  }
+  entries_.push_front({key, columns, bytes});
+  index_[key] = entries_.begin();
+  cached_bytes_ += bytes;
+  while (cached_bytes_ > budget_bytes_ && !entries_.empty()) {
+    auto &last = entries_.back();
+    cached_bytes_ -= last.bytes;
+    index_.erase(last.key);
+    entries_.pop_back();
+  }
+  return columns;
+}
+
+std::size_t iridium::data::ChunkCache::budget_bytes() const noexcept {
+  return budget_bytes_;
+}
+
+std::size_t iridium::data::ChunkCache::cached_bytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cached_bytes_;
+}
+
+std::size_t iridium::data::ChunkCache::hits() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hits_;
+}
+
+std::size_t iridium::data::ChunkCache::misses() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return misses_;
+}
+
+std::uint64_t iridium::data::ChunkCache::NextSeriesId() {
+  static std::atomic<std::uint64_t> next_id{0};
+  return next_id++;
+}
+
+// MappedFile
+#ifndef _WIN32
+/*
+ * closes the file descriptor when leaving scope
+ */
+struct FileDescriptor {
+  int fd;
+
+  ~FileDescriptor() {
+    if (fd != -1) {
+      ::close(fd);
+    }
+  }
+};
+
+/*
+ * map a whole file read-only, size receives its size
+ */
+static const std::uint8_t *MapWholeFile(int fd, const std::string &name, std::size_t &size) {
+  struct stat st{};
+  if (::fstat(fd, &st) == -1 || st.st_size == 0) {
+    throw std::runtime_error("Unable to map empty file: " + name);
+  }
+  size = static_cast<std::size_t>(st.st_size);
+  auto addr = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) {
+    throw std::runtime_error("Unable to map file: " + name);
+  }
+  return static_cast<const std::uint8_t *>(addr);
+}
+#endif
+
+iridium::data::MappedFile::MappedFile(const std::string &path) : data_(nullptr), size_(0) {
+#ifdef _WIN32
+  throw std::runtime_error("Memory mapped candle files are not supported on Windows: " + path);
+#else
+  FileDescriptor file{::open(path.c_str(), O_RDONLY)};
+  if (file.fd == -1) {
+    throw std::runtime_error("Unable to open file: " + path);
+  }
+  data_ = MapWholeFile(file.fd, path, size_);
+#endif
+}
+
+iridium::data::MappedFile::MappedFile(int fd, const std::string &name) : data_(nullptr), size_(0) {
+#ifdef _WIN32
+  throw std::runtime_error("Memory mapped candle files are not supported on Windows: " + name);
+#else
+  data_ = MapWholeFile(fd, name, size_);
+#endif
+}
+
+iridium::data::MappedFile::~MappedFile() {
+#ifndef _WIN32
+  if (data_ != nullptr) {
+    ::munmap(const_cast<std::uint8_t *>(data_), size_);
+  }
+#endif
+}
+
+const std::uint8_t *iridium::data::MappedFile::data() const noexcept {
+  return data_;
+}
+
+std::size_t iridium::data::MappedFile::size() const noexcept {
+  return size_;
+}
+
+#ifndef _WIN32
+static void ReadAt(int fd, void *data, std::size_t size, std::uint64_t offset, const std::string &path) {
+  if (::pread(fd, data, size, static_cast<off_t>(offset)) != static_cast<ssize_t>(size)) {
+    throw std::runtime_error("Unable to read file: " + path);
+  }
+}
+
+static void WriteAt(int fd, const void *data, std::size_t size, std::uint64_t offset, const std::string &path) {
+  if (::pwrite(fd, data, size, static_cast<off_t>(offset)) != static_cast<ssize_t>(size)) {
+    throw std::runtime_error("Unable to write file: " + path);
+  }
+}
+#endif
+
+// MappedCandleSeries
+iridium::data::MappedCandleSeries::MappedCandleSeries(const std::string &path) :
+    MappedCandleSeries(std::make_shared<MappedFile>(path), path) {}
+
+iridium::data::MappedCandleSeries::MappedCandleSeries(
+    std::shared_ptr<MappedFile> file,
+    const std::string &name) :
+    file_(std::move(file)) {
+  if (file_->size() < sizeof(CandleFileHeader)) {
+    throw std::runtime_error("Invalid candle file: " + name);
+  }
+  header_ = reinterpret_cast<const CandleFileHeader *>(file_->data());
+  if (std::memcmp(header_->magic, kCandleFileMagic, sizeof(kCandleFileMagic)) != 0 ||
+      header_->version != kCandleFileVersion ||
+      header_->rows > header_->capacity) {
+    throw std::runtime_error("Invalid candle file: " + name);
+  }
+  const std::size_t column_sizes[] = {
+      sizeof(std::time_t), sizeof(double), sizeof(double), sizeof(double), sizeof(double), sizeof(int)};
+  for (int i = 0; i < 6; ++i) {
+    if (header_->column_offsets[i] + header_->capacity * column_sizes[i] > file_->size()) {
+      throw std::runtime_error("Truncated candle file: " + name);
+    }
+  }
+  auto base = file_->data();
+  auto rows = static_cast<std::size_t>(header_->rows);
+  columns_.times = {reinterpret_cast<const std::time_t *>(base + header_->column_offsets[0]), rows};
+  columns_.opens = {reinterpret_cast<const double *>(base + header_->column_offsets[1]), rows};
+  columns_.closes = {reinterpret_cast<const double *>(base + header_->column_offsets[2]), rows};
+  columns_.highs = {reinterpret_cast<const double *>(base + header_->column_offsets[3]), rows};
+  columns_.lows = {reinterpret_cast<const double *>(base + header_->column_offsets[4]), rows};
+  columns_.volumes = {reinterpret_cast<const int *>(base + header_->column_offsets[5]), rows};
+  time_index_ = TimeIndex(columns_.times, freq());
+}
+
+std::size_t iridium::data::MappedCandleSeries::size() const {
+  return columns_.times.size();
+}
+
+int iridium::data::MappedCandleSeries::row_index(std::time_t time) const {
+  return time_index_.row(time);
+}
+
+iridium::data::HistoryWindow
+iridium::data::MappedCandleSeries::window(std::size_t first, std::size_t count) const {
+  if (first + count > size()) throw std::out_of_range("Candlestick Data Not Found");
+  return HistoryWindow(file_, columns_, first, count);
+}
+
+std::string iridium::data::MappedCandleSeries::instrument_name() const {
+  return std::string(header_->instrument, strnlen(header_->instrument, sizeof(header_->instrument)));
+}
+
+iridium::data::DataFreq iridium::data::MappedCandleSeries::freq() const noexcept {
+  return static_cast<DataFreq>(header_->freq);
+}
+
+const iridium::data::CandleColumnsView &
+iridium::data::MappedCandleSeries::columns() const noexcept {
+  return columns_;
+}
+
+// utility methods
+std::string
+iridium::data::candle_file_name(const std::string &instrument_name, iridium::data::DataFreq freq) {
+  return instrument_name + "_" + DataFreqToString(freq) + kCandleFileExtension;
+}
+
+static constexpr std::uint64_t kCandleColumnSizes[] = {
+    sizeof(std::time_t), sizeof(double), sizeof(double), sizeof(double), sizeof(double), sizeof(int)};
+
+iridium::data::CandleFileHeader iridium::data::candle_file_header(
+    const std::string &instrument_name,
+    iridium::data::DataFreq freq,
+    std::size_t rows,
+    std::size_t capacity) {
+  if (instrument_name.size() >= sizeof(CandleFileHeader::instrument)) {
+    throw std::invalid_argument("Instrument name too long: " + instrument_name);
+  }
+  CandleFileHeader header{};
+  std::memcpy(header.magic, kCandleFileMagic, sizeof(kCandleFileMagic));
+  header.version = kCandleFileVersion;
+  header.freq = static_cast<std::uint32_t>(freq);
+  header.rows = rows;
+  header.capacity = std::max<std::uint64_t>(rows, capacity);
+  std::memcpy(header.instrument, instrument_name.data(), instrument_name.size());
+  std::uint64_t offset = sizeof(CandleFileHeader);
+  for (int i = 0; i < 6; ++i) {
+    offset = (offset + kCandleFileAlignment - 1) / kCandleFileAlignment * kCandleFileAlignment;
+    header.column_offsets[i] = offset;
+    offset += header.capacity * kCandleColumnSizes[i];
+  }
+  return header;
+}
+
+std::size_t iridium::data::candle_file_size(const iridium::data::CandleFileHeader &header) noexcept {
+  return static_cast<std::size_t>(header.column_offsets[5] + header.capacity * kCandleColumnSizes[5]);
+}
+
+void iridium::data::CopyCandleFile(
+    const iridium::data::CandleFileHeader &header,
+    const iridium::data::CandleColumns &columns,
+    std::uint8_t *data) {
+  const void *column_data[] = {
+      columns.times.data(), columns.opens.data(), columns.closes.data(),
+      columns.highs.data(), columns.lows.data(), columns.volumes.data()};
+  for (int i = 0; i < 6; ++i) {
+    std::memcpy(data + header.column_offsets[i], column_data[i], header.rows * kCandleColumnSizes[i]);
+  }
+  // readers validate the magic, so the header goes in once the columns are complete
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(data, &header, sizeof(header));
+}
+
+void iridium::data::WriteCandleFile(
+    const std::string &path,
+    const std::string &instrument_name,
+    iridium::data::DataFreq freq,
+    const iridium::data::CandleColumns &columns,
+    std::size_t capacity) {
+  auto header = candle_file_header(instrument_name, freq, columns.size(), capacity);
+  auto rows = header.rows;
+  const void *column_data[] = {
+      columns.times.data(), columns.opens.data(), columns.closes.data(),
+      columns.highs.data(), columns.lows.data(), columns.volumes.data()};
+
+  std::ofstream file;
+  file.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+  file.open(path, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  std::uint64_t written = sizeof(header);
+  const char padding[kCandleFileAlignment] = {};
+  for (int i = 0; i < 6; ++i) {
+    file.write(padding, static_cast<std::streamsize>(header.column_offsets[i] - written));
+    file.write(static_cast<const char *>(column_data[i]),
+               static_cast<std::streamsize>(rows * kCandleColumnSizes[i]));
+    written = header.column_offsets[i] + rows * kCandleColumnSizes[i];
+  }
+  // spare capacity of the last column
+  for (auto end = candle_file_size(header); written < end;) {
+    auto size = std::min<std::uint64_t>(end - written, kCandleFileAlignment);
+    file.write(padding, static_cast<std::streamsize>(size));
+    written += size;
+  }
+}
+
+std::size_t iridium::data::AppendCandleFile(
+    const std::string &path,
+    const std::string &instrument_name,
+    iridium::data::DataFreq freq,
+    const iridium::data::CandleColumns &columns) {
+#ifdef _WIN32
+  throw std::runtime_error("Appending candle files is not supported on Windows: " + path);
+#else
+  if (::access(path.c_str(), F_OK) != 0) {
+    WriteCandleFile(path, instrument_name, freq, columns, std::max(kCandleFileMinCapacity, columns.size()));
+    return columns.size();
+  }
+  FileDescriptor file{::open(path.c_str(), O_RDWR)};
+  if (file.fd == -1) {
+    throw std::runtime_error("Unable to open file: " + path);
+  }
+  CandleFileHeader header{};
+  ReadAt(file.fd, &header, sizeof(header), 0, path);
+  if (std::memcmp(header.magic, kCandleFileMagic, sizeof(kCandleFileMagic)) != 0 ||
+      header.version != kCandleFileVersion) {
+    throw std::runtime_error("Invalid candle file: " + path);
+  }
+  if (header.freq != static_cast<std::uint32_t>(freq) ||
+      instrument_name != std::string(header.instrument, strnlen(header.instrument, sizeof(header.instrument)))) {
+    throw std::invalid_argument("Candle file holds other candlesticks: " + path);
+  }
+  // skip candlesticks already stored
+  std::size_t first = 0;
+  if (header.rows > 0) {
+    std::time_t last_time;
+    ReadAt(file.fd, &last_time, sizeof(last_time),
+           header.column_offsets[0] + (header.rows - 1) * sizeof(std::time_t), path);
+    first = std::upper_bound(columns.times.begin(), columns.times.end(), last_time) - columns.times.begin();
+  }
+  auto count = columns.size() - first;
+  if (count == 0) {
+    return 0;
+  }
+  if (header.rows + count > header.capacity) {
+    CandleColumns all;
+    {
+      MappedCandleSeries series(path);
+      const auto &view = series.columns();
+      all.reserve(view.times.size() + count);
+      for (std::size_t i = 0; i < view.times.size(); ++i) {
+        all.push_back({view.times[i], view.opens[i], view.closes[i], view.highs[i], view.lows[i], view.volumes[i]});
+      }
+    }
+    for (auto i = first; i < columns.size(); ++i) {
+      all.push_back(columns.candlestick(i));
+    }
+    auto grown_path = path + ".grow";
+    WriteCandleFile(grown_path, instrument_name, freq, all, std::max<std::size_t>(2 * header.capacity, all.size()));
+    if (std::rename(grown_path.c_str(), path.c_str()) != 0) {
+      throw std::runtime_error("Unable to replace file: " + path);
+    }
+    return count;
+  }
+  const std::size_t column_sizes[] = {
+      sizeof(std::time_t), sizeof(double), sizeof(double), sizeof(double), sizeof(double), sizeof(int)};
+  const void *column_data[] = {
+      columns.times.data() + first, columns.opens.data() + first, columns.closes.data() + first,
+      columns.highs.data() + first, columns.lows.data() + first, columns.volumes.data() + first};
+  for (int i = 0; i < 6; ++i) {
+    WriteAt(file.fd, column_data[i], count * column_sizes[i],
+            header.column_offsets[i] + header.rows * column_sizes[i], path);
+  }
+  header.rows += count;
+  WriteAt(file.fd, &header.rows, sizeof(header.rows), offsetof(CandleFileHeader, rows), path);
+  return count;
+#endif
+}
@@ -0,0 +1,150 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <iridium/stream_store.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+/*
+ * append rows first ... last - 1 of from to the columns
+ */
+static void AppendRows(
+    iridium::data::CandleColumns &columns,
+    const iridium::data::CandleColumns &from,
+    std::size_t first,
+    std::size_t last) {
+  auto append = [first, last](auto &to, const auto &column) {
+    to.insert(to.end(), column.begin() + first, column.begin() + last);
+  };
+  append(columns.times, from.times);
+  append(columns.opens, from.opens);
+  append(columns.closes, from.closes);
+  append(columns.highs, from.highs);
+  append(columns.lows, from.lows);
+  append(columns.volumes, from.volumes);
+}
+
+iridium::data::StreamingSeries::StreamingSeries(
+    std::shared_ptr<H5::DataSet> dataset,
+    iridium::data::DataFreq freq,
+    std::size_t lookback,
+    std::size_t block_rows,
+    std::optional<RowRange> rows) :
+    dataset_(std::move(dataset)),
+    freq_(freq),
+    lookback_(lookback),
+    block_rows_(std::max<std::size_t>(block_rows, 1)),
+    buffer_first_(0),
+    reads_(0) {
+  if (!rows) {
+    std::lock_guard<std::mutex> lock(hdf5_mutex());
+    rows = RowRange{0, static_cast<std::size_t>(dataset_->getSpace().getSimpleExtentNpoints())};
+  }
+  first_row_ = rows->first;
+  size_ = rows->count;
+  first_time_ = size_ == 0 ? 0 : ReadColumns(*dataset_, {first_row_, 1})->times.front();
+}
+
+std::size_t iridium::data::StreamingSeries::size() const {
+  return size_;
+}
+
+int iridium::data::StreamingSeries::row_index(std::time_t time) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (size_ == 0 || time < first_time_) {
+    return kNoBar;
+  }
+  if (!buffer_ || time < buffer_->times.front() || time > buffer_->times.back()) {
+    auto row = find_row(time);
+    if (row == size_) {
+      return kNoBar;
+    }
+    if (!buffer_ || time < buffer_->times.front() || row > buffer_end() + block_rows_) {
+      Load(row > lookback_ ? row - lookback_ : 0);
+    }
+  }
+  // walking forward, keep the lookback rows and read the next block
+  while (time > buffer_->times.back() && buffer_end() < size_) {
+    Load(buffer_end() - std::min(lookback_, buffer_end()));
+  }
+  auto row = buffer_index_.row(time);
+  return row == kNoBar ? kNoBar : static_cast<int>(buffer_first_ + row);
+}
+
+iridium::data::HistoryWindow
+iridium::data::StreamingSeries::window(std::size_t first, std::size_t count) const {
+  if (first + count > size()) throw std::out_of_range("Candlestick Data Not Found");
+  if (count == 0) return HistoryWindow();
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto buffered = buffer_ && first >= buffer_first_ && first + count <= buffer_end();
+  if (!buffered && count > lookback_ + 1) {
+    return HistoryWindow(ReadRows(first, count), 0, count);
+  }
+  if (!buffered) {
+    Load(first);
+  }
+  return HistoryWindow(buffer_, first - buffer_first_, count);
+}
+
+bool iridium::data::StreamingSeries::lock_free() const noexcept {
+  return false;
+}
+
+bool iridium::data::StreamingSeries::in_memory() const {
+  return false;
+}
+
+std::size_t iridium::data::StreamingSeries::buffered_rows() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return buffer_ ? buffer_->size() : 0;
+}
+
+std::size_t iridium::data::StreamingSeries::reads() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return reads_;
+}
+
+std::size_t iridium::data::StreamingSeries::find_row(std::time_t time) const {
+  return FindRow(*dataset_, {first_row_, size_}, time) - first_row_;
+}
+
+std::size_t iridium::data::StreamingSeries::buffer_end() const noexcept {
+  return buffer_ ? buffer_first_ + buffer_->size() : 0;
+}
+
+void iridium::data::StreamingSeries::Load(std::size_t first) const {
+  auto last = std::min(size_, first + lookback_ + block_rows_);
+  std::shared_ptr<CandleColumns> columns;
+  if (buffer_ && first >= buffer_first_ && first < buffer_end()) {
+    // the rows still buffered are copied, only the rest is read
+    auto kept = std::min(buffer_end(), last);
+    columns = std::make_shared<CandleColumns>();
+    columns->reserve(last - first);
+    AppendRows(*columns, *buffer_, first - buffer_first_, kept - buffer_first_);
+    if (kept < last) {
+      auto rows = ReadRows(kept, last - kept);
+      AppendRows(*columns, *rows, 0, rows->size());
+    }
+  } else {
+    columns = ReadRows(first, last - first);
+  }
+  buffer_index_ = TimeIndex(columns->times, freq_);
+  buffer_first_ = first;
+  buffer_ = std::move(columns);
+}
+
+std::shared_ptr<iridium::data::CandleColumns>
+iridium::data::StreamingSeries::ReadRows(std::size_t first, std::size_t count) const {
+  ++reads_;
+  return ReadColumns(*dataset_, {first_row_ + first, count});
+}
@@ -0,0 +1,178 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include <iridium/swmr_store.hpp>
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <boost/filesystem.hpp>
+
+static std::string AppendedDataSetName(const std::string &instrument_name, iridium::data::DataFreq freq) {
+  return instrument_name + "_" + iridium::data::DataFreqToString(freq);
+}
+
+// Hdf5Appender
+iridium::data::Hdf5Appender::Hdf5Appender(
+    const std::string &file_name,
+    const iridium::InstrumentList &instruments,
+    const std::vector<DataFreq> &freqs,
+    const iridium::data::ChunkLayout &layout) {
+  {
+    std::lock_guard<std::mutex> lock(hdf5_mutex());
+    H5::FileAccPropList access;
+    // SWMR needs the latest file format
+    access.setLibverBounds(H5F_LIBVER_LATEST, H5F_LIBVER_LATEST);
+    auto flags = boost::filesystem::exists(file_name) ? H5F_ACC_RDWR : H5F_ACC_TRUNC;
+    file_ = std::make_unique<H5::H5File>(file_name, flags, H5::FileCreatPropList::DEFAULT, access);
+  }
+  for (const auto &instrument : instruments) {
+    for (auto freq : freqs) {
+      auto name = AppendedDataSetName(instrument->name(), freq);
+      bool exists;
+      {
+        std::lock_guard<std::mutex> lock(hdf5_mutex());
+        exists = H5Lexists(file_->getId(), "/instruments", H5P_DEFAULT) > 0 &&
+            H5Lexists(file_->getId(), instrument_dataset_path(name).c_str(), H5P_DEFAULT) > 0;
+      }
+      if (!exists) {
+        CreateAppendableCandles(*file_, name, layout);
+      }
+      AppendedDataSet appended{OpenCandleDataSet(*file_, name), std::nullopt};
+      std::size_t size;
+      {
+        std::lock_guard<std::mutex> lock(hdf5_mutex());
+        if (H5Aexists(appended.dataset->getId(), kAscendingAttribute) <= 0) {
+          throw std::invalid_argument(name + " is stored by descending time and cannot be appended to");
+        }
+        size = appended.dataset->getSpace().getSimpleExtentNpoints();
+      }
+      if (size > 0) {
+        appended.last_time = ReadColumns(*appended.dataset, {size - 1, 1})->times[0];
+      }
+      datasets_.emplace(name, std::move(appended));
+    }
+  }
+  std::lock_guard<std::mutex> lock(hdf5_mutex());
+  if (H5Fstart_swmr_write(file_->getId()) < 0) {
+    throw std::runtime_error("Unable to start SWMR writing: " + file_name);
+  }
+}
+
+iridium::data::Hdf5Appender::~Hdf5Appender() {
+  std::lock_guard<std::mutex> lock(hdf5_mutex());
+  datasets_.clear();
+  file_.reset();
+}
+
+std::size_t iridium::data::Hdf5Appender::Append(
+    const std::string &instrument_name,
+    iridium::data::DataFreq freq,
+    const iridium::data::DataList &candlesticks) {
+  auto it = datasets_.find(AppendedDataSetName(instrument_name, freq));
+  if (it == datasets_.end()) {
+    throw std::out_of_range("Not appending " + AppendedDataSetName(instrument_name, freq));
+  }
+  auto &appended = it->second;
+  // skip candlesticks already stored
+  auto first = candlesticks.begin();
+  if (appended.last_time) {
+    auto last_time = *appended.last_time;
+    first = std::upper_bound(candlesticks.begin(), candlesticks.end(), last_time,
+                             [](auto time, const auto &candlestick) { return time < candlestick.time; });
+  }
+  CandleColumns columns;
+  columns.reserve(static_cast<std::size_t>(candlesticks.end() - first));
+  for (auto it = first; it != candlesticks.end(); ++it) {
+    if (columns.size() > 0 && it->time <= columns.times.back()) {
+      throw std::invalid_argument("Candlesticks must be sorted by ascending time");
+    }
+    columns.push_back(*it);
+  }
+  if (columns.size() == 0) {
+    return 0;
+  }
+  AppendCandles(*appended.dataset, columns);
+  appended.last_time = columns.times.back();
+  return columns.size();
+}
+
+std::optional<std::time_t>
+iridium::data::Hdf5Appender::last_time(const std::string &instrument_name, iridium::data::DataFreq freq) const {
+  auto it = datasets_.find(AppendedDataSetName(instrument_name, freq));
+  if (it == datasets_.end()) {
+    throw std::out_of_range("Not appending " + AppendedDataSetName(instrument_name, freq));
+  }
+  return it->second.last_time;
+}
+
+// SwmrSeries
+iridium::data::SwmrSeries::SwmrSeries(
+    std::shared_ptr<H5::DataSet> dataset,
+    iridium::data::DataFreq freq) :
+    dataset_(std::move(dataset)),
+    columns_(ReadColumns(*dataset_)),
+    time_index_(columns_->times, freq) {}
+
+iridium::data::SwmrSeries::~SwmrSeries() {
+  std::lock_guard<std::mutex> lock(hdf5_mutex());
+  dataset_.reset();
+}
+
+std::size_t iridium::data::SwmrSeries::size() const {
+  return columns_->size();
+}
+
+int iridium::data::SwmrSeries::row_index(std::time_t time) const {
+  return time_index_.row(time);
+}
+
+iridium::data::HistoryWindow
+iridium::data::SwmrSeries::window(std::size_t first, std::size_t count) const {
+  if (first + count > size()) throw std::out_of_range("Candlestick Data Not Found");
+  return HistoryWindow(columns_, first, count);
+}
+
+std::size_t iridium::data::SwmrSeries::Refresh() {
+  std::size_t size;
+  {
+    std::lock_guard<std::mutex> lock(hdf5_mutex());
+    if (H5Drefresh(dataset_->getId()) < 0) {
+      throw std::runtime_error("Unable to refresh candlestick dataset");
+    }
+    size = dataset_->getSpace().getSimpleExtentNpoints();
+  }
+  if (size <= columns_->size()) {
+    return 0;
+  }
+  auto added = ReadColumns(*dataset_, {columns_->size(), size - columns_->size()});
+  auto append = [](CandleColumns &columns, const CandleColumns &rows) {
+    auto insert = [](auto &column, const auto &values) { column.insert(column.end(), values.begin(), values.end()); };
+    insert(columns.times, rows.times);
+    insert(columns.opens, rows.opens);
+    insert(columns.closes, rows.closes);
+    insert(columns.highs, rows.highs);
+    insert(columns.lows, rows.lows);
+    insert(columns.volumes, rows.volumes);
+  };
+  time_index_.Append(added->times);
+  if (columns_->times.capacity() < size) {
+    // windows handed out keep the previous columns alive
+    auto grown = std::make_shared<CandleColumns>();
+    grown->reserve(2 * size);
+    append(*grown, *columns_);
+    columns_ = std::move(grown);
+  }
+  append(*columns_, *added);
+  return added->size();
+}
@@ -89,6 +89,14 @@ const std::shared_ptr<iridium::Instrument>
   return instrument_ptr_;
 }
 
+std::optional<int> iridium::Trade::instrument_id() const noexcept {
+  return instrument_id_;
+}
+
+void iridium::Trade::set_instrument_id(int id) noexcept {
+  instrument_id_ = id;
+}
+
 double iridium::Trade::price() const noexcept {
   return price_;
 }
@@ -11,6 +11,7 @@
 #include <optional>
 #include <tuple>
 #include <iridium/algorithm.hpp>
+#include <iridium/range_query.hpp>
 
 namespace iridium::indicator {
 
@@ -23,7 +24,7 @@ enum TradeAction {
 };
 
 std::unique_ptr<std::vector<TA_Real>>
-ema(const std::vector<double> &closes, int period);
+ema(const iridium::algorithm::ColumnView<double> &closes, int period);
 
 /*
   * check moving average crossover & the distance to the last data
@@ -41,28 +42,28 @@ std::tuple<
     std::unique_ptr<std::vector<TA_Real>>,
     std::unique_ptr<std::vector<TA_Real>>>
 macd(
-    const std::vector<double> &closes,
+    const iridium::algorithm::ColumnView<double> &closes,
     int fast_period,
     int slow_period,
     int signal_period);
 
 std::unique_ptr<std::vector<TA_Real>>
 adx(
-    const std::vector<double> &highs,
-    const std::vector<double> &lows,
-    const std::vector<double> &closes,
+    const iridium::algorithm::ColumnView<double> &highs,
+    const iridium::algorithm::ColumnView<double> &lows,
+    const iridium::algorithm::ColumnView<double> &closes,
     int period);
 
 std::unique_ptr<std::vector<TA_Real>>
 rsi(
-    const std::vector<double> &closes,
+    const iridium::algorithm::ColumnView<double> &closes,
     int period);
 
 std::unique_ptr<std::vector<TA_Real>>
 atr(
-    const std::vector<double> &highs,
-    const std::vector<double> &lows,
-    const std::vector<double> &closes,
+    const iridium::algorithm::ColumnView<double> &highs,
+    const iridium::algorithm::ColumnView<double> &lows,
+    const iridium::algorithm::ColumnView<double> &closes,
     int period);
 
 std::optional<double>
@@ -87,6 +88,19 @@ lowest_after_ma_cross(
     const std::vector<double> &lows,
     int ma_cross_distance_to_last);
 
+/*
+  * same over the min/max pyramid of a series kept across ticks, in constant time
+  */
+double
+highest_after_ma_cross(
+    const iridium::data::RangeExtrema &extrema,
+    int ma_cross_distance_to_last);
+
+double
+lowest_after_ma_cross(
+    const iridium::data::RangeExtrema &extrema,
+    int ma_cross_distance_to_last);
+
 std::unique_ptr<std::vector<MarketImpulse>>
 market_impulses(
     const std::vector<double> &closes,
@@ -31,11 +31,23 @@ limitations under the License.
 
 void SimulateTrade(
     const std::string &instrument_name,
+    int instrument_id,
+    std::time_t tick,
+    const iridium::data::HistoryWindow &long_term_hist_data,
+    const iridium::data::HistoryWindow &intermediate_term_hist_data,
+    const iridium::data::HistoryWindow &short_term_hist_data,
+    const iridium::data::MarketSnapshot &snapshot,
+    const std::shared_ptr<iridium::Account> &account_ptr,
+    double spread);
+
+void SimulateTrade(
+    const std::string &instrument_name,
+    int instrument_id,
     std::time_t tick,
     const iridium::data::DataList &long_term_hist_data,
     const iridium::data::DataList &intermediate_term_hist_data,
     const iridium::data::DataList &short_term_hist_data,
-    const iridium::data::TickDataMap &tick_data_map,
+    const iridium::data::MarketSnapshot &snapshot,
     const std::shared_ptr<iridium::Account> &account_ptr,
     double spread);
 
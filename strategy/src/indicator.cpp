@@ -5,7 +5,7 @@
 #include "../include/indicator.hpp"
 
 std::unique_ptr<std::vector<TA_Real>>
-iridium::indicator::ema(const std::vector<double> &closes, int period) {
+iridium::indicator::ema(const iridium::algorithm::ColumnView<double> &closes, int period) {
   auto count = closes.size();
   auto out = std::make_unique<std::vector<TA_Real>>(count);
   TA_Integer out_beg;
@@ -57,7 +57,7 @@ std::tuple<
     std::unique_ptr<std::vector<TA_Real>>,
     std::unique_ptr<std::vector<TA_Real>>>
     iridium::indicator::macd(
-        const std::vector<double> &closes,
+        const iridium::algorithm::ColumnView<double> &closes,
         int fast_period,
         int slow_period,
         int signal_period) {
@@ -87,9 +87,9 @@ std::tuple<
 
 std::unique_ptr<std::vector<TA_Real>>
 iridium::indicator::adx(
-    const std::vector<double> &highs,
-    const std::vector<double> &lows,
-    const std::vector<double> &closes,
+    const iridium::algorithm::ColumnView<double> &highs,
+    const iridium::algorithm::ColumnView<double> &lows,
+    const iridium::algorithm::ColumnView<double> &closes,
     int period) {
   auto count = closes.size();
   auto out = std::make_unique<std::vector<TA_Real>>(count);
@@ -111,7 +111,7 @@ iridium::indicator::adx(
 
 std::unique_ptr<std::vector<TA_Real>>
 iridium::indicator::rsi(
-    const std::vector<double> &closes,
+    const iridium::algorithm::ColumnView<double> &closes,
     int period) {
   auto count = closes.size();
   auto out = std::make_unique<std::vector<TA_Real>>(count);
@@ -130,9 +130,9 @@ iridium::indicator::rsi(
 
 std::unique_ptr<std::vector<TA_Real>>
 iridium::indicator::atr(
-    const std::vector<double> &highs,
-    const std::vector<double> &lows,
-    const std::vector<double> &closes,
+    const iridium::algorithm::ColumnView<double> &highs,
+    const iridium::algorithm::ColumnView<double> &lows,
+    const iridium::algorithm::ColumnView<double> &closes,
     int period) {
   auto count = closes.size();
   auto out = std::make_unique<std::vector<TA_Real>>(count);
@@ -180,18 +180,28 @@ double
 iridium::indicator::highest_after_ma_cross(
     const std::vector<double> &highs,
     int ma_cross_distance_to_last) {
-  auto sliced_highs_after_cross = iridium::algorithm::SliceLastN(highs, ma_cross_distance_to_last);
-  auto highest_after_cross = std::max_element(sliced_highs_after_cross.begin(), sliced_highs_after_cross.end());
-  return *highest_after_cross;
+  return *std::max_element(highs.end() - ma_cross_distance_to_last, highs.end());
 }
 
 double
 iridium::indicator::lowest_after_ma_cross(
     const std::vector<double> &lows,
     int ma_cross_distance_to_last) {
-  auto sliced_lows_after_cross = iridium::algorithm::SliceLastN(lows, ma_cross_distance_to_last);
-  auto lowest_after_cross = std::min_element(sliced_lows_after_cross.begin(), sliced_lows_after_cross.end());
-  return *lowest_after_cross;
+  return *std::min_element(lows.end() - ma_cross_distance_to_last, lows.end());
+}
+
+double
+iridium::indicator::highest_after_ma_cross(
+    const iridium::data::RangeExtrema &extrema,
+    int ma_cross_distance_to_last) {
+  return extrema.max_high(extrema.size() - ma_cross_distance_to_last, extrema.size() - 1);
+}
+
+double
+iridium::indicator::lowest_after_ma_cross(
+    const iridium::data::RangeExtrema &extrema,
+    int ma_cross_distance_to_last) {
+  return extrema.min_low(extrema.size() - ma_cross_distance_to_last, extrema.size() - 1);
 }
 
 std::unique_ptr<std::vector<iridium::indicator::MarketImpulse>>
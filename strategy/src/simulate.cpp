@@ -16,13 +16,14 @@ void ClosePosition(const std::string &instrument,
                    const std::shared_ptr<iridium::Account> &account_ptr,
                    double acc_quote_rate,
                    double current_price,
-                   std::time_t time) {
-  account_ptr->CloserPosition(instrument, acc_quote_rate, current_price, time);
+                   std::time_t time,
+                   const iridium::data::MarketSnapshot &snapshot) {
+  account_ptr->CloserPosition(instrument, acc_quote_rate, current_price, time, snapshot);
 }
 
 int CalculateLimitOrderUnits(
     const std::shared_ptr<iridium::Account> &account_ptr,
-    const iridium::data::TickDataMap &tick_data_map,
+    const iridium::data::MarketSnapshot &snapshot,
     double order_price,
     double stop_loss_price,
     double acc_quote_rate,
@@ -30,8 +31,8 @@ int CalculateLimitOrderUnits(
     int pip_num,
     bool is_short,
     int min_size) {
-  if (auto equity = account_ptr->net_asset_value(tick_data_map);
-      auto margin_used = account_ptr->margin_used(tick_data_map)) {
+  if (auto equity = account_ptr->net_asset_value(snapshot);
+      auto margin_used = account_ptr->margin_used(snapshot)) {
     return CalculatePositionSize(
         *equity,
         *margin_used,
@@ -49,7 +50,7 @@ int CalculateLimitOrderUnits(
 
 int CalculateMarketOrderUnits(
     const std::shared_ptr<iridium::Account> &account_ptr,
-    const iridium::data::TickDataMap &tick_data_map,
+    const iridium::data::MarketSnapshot &snapshot,
     double market_price,
     double stop_loss_price,
     double acc_quote_rate,
@@ -58,8 +59,8 @@ int CalculateMarketOrderUnits(
     bool is_short,
     int min_size,
     double spread) {
-  if (auto equity = account_ptr->net_asset_value(tick_data_map);
-      auto margin_used = account_ptr->margin_used(tick_data_map)) {
+  if (auto equity = account_ptr->net_asset_value(snapshot);
+      auto margin_used = account_ptr->margin_used(snapshot)) {
     auto spread_value = spread * pow(10, -pip_num);
     auto ask = market_price + spread_value / 2.0;
     auto bid = market_price - spread_value / 2.0;
@@ -81,11 +82,34 @@ int CalculateMarketOrderUnits(
 
 void SimulateTrade(
     const std::string &instrument_name,
+    int instrument_id,
     std::time_t tick,
     const iridium::data::DataList &long_term_hist_data,
     const iridium::data::DataList &intermediate_term_hist_data,
     const iridium::data::DataList &short_term_hist_data,
-    const iridium::data::TickDataMap &tick_data_map,
+    const iridium::data::MarketSnapshot &snapshot,
+    const std::shared_ptr<iridium::Account> &account_ptr,
+    double spread) {
+  SimulateTrade(
+      instrument_name,
+      instrument_id,
+      tick,
+      iridium::data::HistoryWindow(long_term_hist_data),
+      iridium::data::HistoryWindow(intermediate_term_hist_data),
+      iridium::data::HistoryWindow(short_term_hist_data),
+      snapshot,
+      account_ptr,
+      spread);
+}
+
+void SimulateTrade(
+    const std::string &instrument_name,
+    int instrument_id,
+    std::time_t tick,
+    const iridium::data::HistoryWindow &long_term_hist_data,
+    const iridium::data::HistoryWindow &intermediate_term_hist_data,
+    const iridium::data::HistoryWindow &short_term_hist_data,
+    const iridium::data::MarketSnapshot &snapshot,
     const std::shared_ptr<iridium::Account> &account_ptr,
     double spread) {
 
@@ -138,28 +162,27 @@ void SimulateTrade(
   auto account_quote_rate_opt = iridium::data::account_currency_rate(
       account_ptr->account_currency(),
       quote,
-      tick_data_map);
-  auto current_price = tick_data_map.at(instrument_name).value().close;
-
-  if (!account_quote_rate_opt.has_value()) return;
+      snapshot);
+  if (!snapshot.has_data(instrument_id) || !account_quote_rate_opt.has_value()) return;
+  auto current_price = snapshot.candlestick(instrument_id).close;
   auto acc_quote_rate = account_quote_rate_opt.value();
 
   // history data
-  auto closes = candlestick_closes(short_term_hist_data);
-  auto highs = candlestick_highs(short_term_hist_data);
-  auto lows = candlestick_lows(short_term_hist_data);
+  auto closes = short_term_hist_data.closes();
+  auto highs = short_term_hist_data.highs();
+  auto lows = short_term_hist_data.lows();
 
   // rsi
-  auto rsi = iridium::indicator::rsi(*closes, kRSIPeriod);
+  auto rsi = iridium::indicator::rsi(closes, kRSIPeriod);
 
   // atr
-  auto atr = iridium::indicator::atr(*highs, *lows, *closes, kATRPeriod);
+  auto atr = iridium::indicator::atr(highs, lows, closes, kATRPeriod);
 
   // moving average
-  auto ema = iridium::indicator::ema(*closes, kFastPeriod);
+  auto ema = iridium::indicator::ema(closes, kFastPeriod);
 
   // macd
-  auto[macd, macd_signal, macd_hist] = iridium::indicator::macd(*closes,
+  auto[macd, macd_signal, macd_hist] = iridium::indicator::macd(closes,
                                                                 kMACDFastPeriod,
                                                                 kMACDSlowPeriod,
                                                                 kMACDSignalPeriod);
@@ -187,7 +210,7 @@ void SimulateTrade(
             auto take_profit_price = order_price + kProfitLossRatio * (order_price - stop_loss_price);
             auto units = CalculateMarketOrderUnits(
                 account_ptr,
-                tick_data_map,
+                snapshot,
                 order_price,
                 stop_loss_price,
                 acc_quote_rate,
@@ -202,6 +225,7 @@ void SimulateTrade(
                   instrument_name,
                   units,
                   order_price,
+                  snapshot,
                   take_profit_price,
                   stop_loss_price);
               logger->info(
@@ -240,7 +264,7 @@ void SimulateTrade(
             auto take_profit_price = order_price - kProfitLossRatio * (stop_loss_price - order_price);
             auto units = CalculateMarketOrderUnits(
                 account_ptr,
-                tick_data_map,
+                snapshot,
                 order_price,
                 stop_loss_price,
                 acc_quote_rate,
@@ -255,6 +279,7 @@ void SimulateTrade(
                   instrument_name,
                   units,
                   order_price,
+                  snapshot,
                   take_profit_price,
                   stop_loss_price);
               logger->info(
@@ -279,7 +304,7 @@ void SimulateTrade(
     auto macd_hist_1 = macd_hist->back();
     if ((macd_hist_0 < 0 && macd_hist_1 > 0 && account_ptr->open_position_size(instrument_name) < 0) ||
         (macd_hist_0 > 0 && macd_hist_1 < 0 && account_ptr->open_position_size(instrument_name) > 0)) {
-      ClosePosition(instrument_name, account_ptr, acc_quote_rate, current_price, tick);
+      ClosePosition(instrument_name, account_ptr, acc_quote_rate, current_price, tick, snapshot);
       logger->info(
           "close position - instrument: {}, time: {}",
           instrument_name,
@@ -0,0 +1,97 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <string>
+#include <iridium/csv_import.hpp>
+#include <iridium/hdf5_store.hpp>
+
+TEST(CsvImportTest, ParseTime) {
+  using iridium::data::ParseCsvTime;
+  EXPECT_EQ(ParseCsvTime("1600000000"), 1600000000);
+  EXPECT_EQ(ParseCsvTime("1600000000123"), 1600000000);
+  EXPECT_EQ(ParseCsvTime("2020-09-13 12:26:40"), 1600000000);
+  EXPECT_EQ(ParseCsvTime("2020.09.13 12:26"), 1600000000 - 40);
+  EXPECT_EQ(ParseCsvTime("2020-09-13T12:26:40.500Z"), 1600000000);
+  EXPECT_EQ(ParseCsvTime("20200913 122640"), 1600000000);
+  EXPECT_EQ(ParseCsvTime("20200913122640"), 1600000000);
+  EXPECT_EQ(ParseCsvTime("\"2020/09/13 12:26:40\""), 1600000000);
+  EXPECT_EQ(ParseCsvTime("1970-01-01"), 0);
+  EXPECT_FALSE(ParseCsvTime("time").has_value());
+  EXPECT_FALSE(ParseCsvTime("2020-13-01 00:00").has_value());
+  EXPECT_FALSE(ParseCsvTime("2020-09-13 12:26x").has_value());
+}
+
+TEST(CsvImportTest, ParallelChunksMatchSingleThread) {
+  std::string text = "Date;Open;High;Low;Close;Volume\r\n";
+  for (int i = 0; i < 300000; ++i) {
+    // a gap every 1000 rows
+    auto time = 1600000020 + 60 * (i + i / 1000);
+    text += std::to_string(time) + ";1.1" + std::to_string(i % 1000) + ";1.2;1.0;1.15;" + std::to_string(i) + "\r\n";
+  }
+  ASSERT_GT(text.size(), 2 * iridium::data::kCsvChunkBytes);
+  iridium::data::CsvFormat format;
+  format.delimiter = ';';
+  auto single = iridium::data::ParseCandleCsv(text, format, 1);
+  auto parallel = iridium::data::ParseCandleCsv(text, format, 4);
+  ASSERT_EQ(single->size(), 300000);
+  ASSERT_EQ(parallel->size(), 300000);
+  EXPECT_EQ(single->times, parallel->times);
+  EXPECT_EQ(single->opens, parallel->opens);
+  EXPECT_EQ(parallel->volumes.back(), 299999);
+  EXPECT_DOUBLE_EQ(parallel->opens[1234], 1.1234);
+  auto validation = iridium::data::ValidateCandles(*parallel, iridium::data::DataFreq::m1);
+  EXPECT_TRUE(validation.ordered());
+  EXPECT_EQ(validation.gaps, 299);
+  EXPECT_EQ(validation.off_grid, 0);
+  EXPECT_EQ(validation.longest_gap, 120);
+
+  text.insert(text.size() - 10, "x");
+  try {
+    (void) iridium::data::ParseCandleCsv(text, format, 4, "dump.csv");
+    FAIL() << "malformed line accepted";
+  } catch (const std::runtime_error &err) {
+    EXPECT_NE(std::string(err.what()).find("dump.csv:300001"), std::string::npos) << err.what();
+  }
+}
+
+TEST(CsvImportTest, SortAndWriteHdf5) {
+  iridium::data::CsvFormat format;
+  format.volume_column = iridium::data::kNoCsvColumn;
+  auto columns = iridium::data::ParseCandleCsv(
+      "2020-09-14 00:02,1.3,1.4,1.2,1.35\n"
+      "2020-09-14 00:00,1.0,1.1,0.9,1.05\n"
+      "2020-09-14 00:01,1.1,1.2,1.0,1.15\n"
+      "2020-09-14 00:02,1.2,1.3,1.1,1.25\n", format);
+  auto validation = iridium::data::ValidateCandles(*columns, iridium::data::DataFreq::m1);
+  EXPECT_EQ(validation.out_of_order, 1);
+  EXPECT_FALSE(validation.ordered());
+  iridium::data::SortCandles(*columns);
+  ASSERT_EQ(columns->size(), 3);
+  EXPECT_TRUE(iridium::data::ValidateCandles(*columns, iridium::data::DataFreq::m1).ordered());
+  EXPECT_EQ(columns->closes.back(), 1.25);
+  EXPECT_EQ(columns->volumes.back(), 0);
+
+  auto path = std::filesystem::temp_directory_path() / "iridium_import_test.h5";
+  {
+    H5::H5File file(path.u8string(), H5F_ACC_TRUNC);
+    iridium::data::WriteCandles(file, "EUR_USD_M1", *columns);
+    // re-importing replaces the dataset
+    iridium::data::WriteCandles(file, "EUR_USD_M1", *columns);
+  }
+  H5::H5File file(path.u8string(), H5F_ACC_RDONLY);
+  auto stored = iridium::data::ReadColumns(file.openDataSet(iridium::data::instrument_dataset_path("EUR_USD_M1")));
+  EXPECT_EQ(stored->times, columns->times);
+  EXPECT_EQ(stored->highs, columns->highs);
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,318 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <thread>
+#include <vector>
+#include <filesystem>
+#include <iridium/calendar.hpp>
+#include <iridium/data.hpp>
+#include <iridium/hdf5_store.hpp>
+#include <iridium/prefetch.hpp>
+
+const auto kDataFilePath = std::filesystem::current_path().parent_path() / "resources" / "history.h5";
+const auto kDataInstrumentName = "EUR_USD";
+const auto kDataFreq = "H4";
+const auto kDataHistCount = 90;
+
+std::unique_ptr<iridium::data::TradeData> LoadTradeData(iridium::data::LoadMode load_mode) {
+  auto instruments = iridium::instrument_list({kDataInstrumentName});
+  auto freqs = iridium::data::data_freq_list({kDataFreq});
+  iridium::data::TradeDataOptions options;
+  options.load_mode = load_mode;
+  return std::make_unique<iridium::data::TradeData>(
+      kDataFilePath.u8string(),
+      *instruments,
+      *freqs,
+      options);
+}
+
+TEST(TradeDataTest, InMemoryMatchesOnDemand) {
+  auto on_demand = LoadTradeData(iridium::data::LoadMode::kOnDemand);
+  auto in_memory = LoadTradeData(iridium::data::LoadMode::kInMemory);
+  auto ticks = iridium::calendar::all_ticks_ptr(
+      2019, 1, 1, 2019, 2, 1, "Australia/Sydney", iridium::data::DataFreq::h4);
+  for (auto tick : *ticks) {
+    auto expected = on_demand->history_data(
+        kDataInstrumentName, tick, kDataHistCount, iridium::data::DataFreq::h4);
+    auto actual = in_memory->history_data(
+        kDataInstrumentName, tick, kDataHistCount, iridium::data::DataFreq::h4);
+    ASSERT_EQ(expected->size(), actual->size());
+    for (std::size_t i = 0; i < expected->size(); ++i) {
+      EXPECT_EQ(expected->at(i).time, actual->at(i).time);
+      EXPECT_EQ(expected->at(i).close, actual->at(i).close);
+      EXPECT_EQ(expected->at(i).volume, actual->at(i).volume);
+    }
+    EXPECT_EQ(actual->back().time, tick);
+  }
+}
+
+TEST(TradeDataTest, MissingCandlestick) {
+  auto in_memory = LoadTradeData(iridium::data::LoadMode::kInMemory);
+  EXPECT_EQ(in_memory->candlestick_data(kDataInstrumentName, 0, iridium::data::DataFreq::h4), std::nullopt);
+}
+
+TEST(TradeDataTest, HasBarMatchesTryCandle) {
+  auto in_memory = LoadTradeData(iridium::data::LoadMode::kInMemory);
+  auto ticks = iridium::calendar::all_ticks_ptr(
+      2019, 1, 1, 2019, 2, 1, "Australia/Sydney", iridium::data::DataFreq::h4);
+  std::size_t bars = 0;
+  // a weekend tick and a tick off the H4 grid have no bar
+  auto gap = std::adjacent_find(ticks->begin(), ticks->end(), [](auto t1, auto t2) {
+    return t2 - t1 > iridium::data::DataFreq::h4;
+  });
+  ASSERT_NE(gap, ticks->end());
+  EXPECT_FALSE(in_memory->has_bar(kDataInstrumentName, *gap + iridium::data::DataFreq::h4, iridium::data::DataFreq::h4));
+  EXPECT_FALSE(in_memory->has_bar(kDataInstrumentName, ticks->front() + 60, iridium::data::DataFreq::h4));
+  for (auto tick = ticks->front(); tick <= ticks->back(); tick += iridium::data::DataFreq::h4) {
+    auto candle = in_memory->try_candle(kDataInstrumentName, tick, iridium::data::DataFreq::h4);
+    EXPECT_EQ(in_memory->has_bar(kDataInstrumentName, tick, iridium::data::DataFreq::h4), candle.has_value());
+    if (candle) {
+      EXPECT_EQ(candle->time, tick);
+      ++bars;
+    }
+  }
+  EXPECT_GE(bars, ticks->size() - 1);
+  EXPECT_FALSE(in_memory->has_bar("GBP_USD", ticks->front(), iridium::data::DataFreq::h4));
+  EXPECT_FALSE(in_memory->has_bar(kDataInstrumentName, ticks->front(), iridium::data::DataFreq::m1));
+  EXPECT_EQ(in_memory->try_candle("GBP_USD", ticks->front(), iridium::data::DataFreq::h4), std::nullopt);
+}
+
+TEST(TradeDataTest, HistoryWindowMatchesHistoryData) {
+  auto in_memory = LoadTradeData(iridium::data::LoadMode::kInMemory);
+  auto instruments = iridium::instrument_list({kDataInstrumentName});
+  auto ticks = iridium::calendar::all_ticks_ptr(
+      2019, 1, 1, 2019, 1, 10, "Australia/Sydney", iridium::data::DataFreq::h4);
+  for (auto tick : *ticks) {
+    auto window = in_memory->history_window(
+        kDataInstrumentName, tick, kDataHistCount, iridium::data::DataFreq::h4);
+    auto data_list = in_memory->history_data(
+        kDataInstrumentName, tick, kDataHistCount, iridium::data::DataFreq::h4);
+    ASSERT_EQ(window.size(), data_list->size());
+    EXPECT_EQ(window.end_time(), tick);
+    EXPECT_EQ(window.begin_time(), data_list->front().time);
+    EXPECT_EQ(window.closes().back(), data_list->back().close);
+
+    auto windows = in_memory->history_windows(
+        *instruments, tick, kDataHistCount, iridium::data::DataFreq::h4);
+    ASSERT_EQ(windows.size(), 1);
+    EXPECT_EQ(windows.front().size(), kDataHistCount);
+    EXPECT_EQ(windows.front().end_time(), window[window.size() - 2].time);
+  }
+}
+
+TEST(HistoryWindowTest, SubWindow) {
+  iridium::data::DataList data_list;
+  for (int i = 0; i < 5; ++i) {
+    data_list.push_back({i * 60, 1.0 + i, 1.5 + i, 2.0 + i, 0.5 + i, i});
+  }
+  iridium::data::HistoryWindow window(data_list);
+  auto sub_window = window.sub_window(1, 3);
+  EXPECT_EQ(sub_window.size(), 3);
+  EXPECT_EQ(sub_window.begin_time(), 60);
+  EXPECT_EQ(sub_window.end_time(), 180);
+  EXPECT_EQ(sub_window.highs().front(), 3.0);
+  EXPECT_EQ(sub_window.data_list()->back().volume, 3);
+}
+
+TEST(PanelTest, FillColumnAlignsAndForwardFills) {
+  iridium::data::Panel panel({60, 120, 180, 240}, 2);
+  iridium::data::HistoryWindow first({{60, 1.0, 1.1, 1.2, 0.9, 5}, {180, 2.0, 2.1, 2.2, 1.9, 6}});
+  iridium::data::HistoryWindow second({{120, 3.0, 3.1, 3.2, 2.9, 7}, {240, 4.0, 4.1, 4.2, 3.9, 8}});
+  panel.FillColumn(0, first, iridium::data::kClosePrice, true);
+  panel.FillColumn(1, second, iridium::data::kVolume, true, 9.0);
+  ASSERT_EQ(panel.rows(), 4);
+  EXPECT_EQ(panel(0, 0), 1.1);
+  EXPECT_EQ(panel(1, 0), 1.1);
+  EXPECT_FALSE(panel.valid(1, 0));
+  EXPECT_EQ(panel(3, 0), 2.1);
+  EXPECT_EQ(panel(0, 1), 9.0);
+  EXPECT_FALSE(panel.valid(0, 1));
+  EXPECT_EQ(panel.row(1)[1], 7.0);
+  EXPECT_TRUE(panel.valid(3, 1));
+  iridium::data::Panel sparse(panel.times(), 1);
+  sparse.FillColumn(0, first, iridium::data::kHighPrice, false);
+  EXPECT_TRUE(std::isnan(sparse(1, 0)));
+  EXPECT_EQ(sparse(2, 0), 2.2);
+  iridium::data::HistoryWindow off_grid({{150, 1.0, 1.1, 1.2, 0.9, 5}});
+  EXPECT_THROW(sparse.FillColumn(0, off_grid, iridium::data::kOpenPrice, false), std::invalid_argument);
+}
+
+TEST(TradeDataTest, PanelMatchesTryCandle) {
+  auto instruments = iridium::instrument_list({"EUR_USD", "USD_JPY"});
+  auto freqs = iridium::data::data_freq_list({"H4"});
+  H5::H5File file(kDataFilePath.u8string(), H5F_ACC_RDONLY);
+  auto jpy_times = iridium::data::ReadColumns(
+      file.openDataSet(iridium::data::instrument_dataset_path("USD_JPY_H4")))->times;
+  auto begin = jpy_times.front() - 7 * 86400;
+  auto end = jpy_times.front() + 14 * 86400;
+  for (auto load_mode : {iridium::data::LoadMode::kInMemory, iridium::data::LoadMode::kOnDemand}) {
+    iridium::data::TradeDataOptions options;
+    options.load_mode = load_mode;
+    iridium::data::TradeData trade_data(kDataFilePath.u8string(), *instruments, *freqs, options);
+    for (auto forward_fill : {false, true}) {
+      auto panel = trade_data.panel(
+          *instruments, begin, end, iridium::data::DataFreq::h4, iridium::data::kClosePrice, forward_fill);
+      ASSERT_EQ(panel.columns(), 2);
+      ASSERT_GT(panel.rows(), 0);
+      EXPECT_GE(panel.times().front(), begin);
+      EXPECT_LE(panel.times().back(), end);
+      EXPECT_TRUE(std::is_sorted(panel.times().begin(), panel.times().end()));
+      std::size_t filled = 0;
+      for (std::size_t row = 0; row < panel.rows(); ++row) {
+        for (std::size_t column = 0; column < panel.columns(); ++column) {
+          auto candle = trade_data.try_candle(
+              instruments->at(column)->name(), panel.times()[row], iridium::data::DataFreq::h4);
+          ASSERT_EQ(panel.valid(row, column), candle.has_value());
+          if (candle) {
+            EXPECT_EQ(panel(row, column), candle->close);
+          } else if (forward_fill && row > 0) {
+            EXPECT_TRUE(std::isnan(panel(row, column)) ? std::isnan(panel(row - 1, column))
+                                                       : panel(row, column) == panel(row - 1, column));
+            ++filled;
+          } else if (!forward_fill) {
+            EXPECT_TRUE(std::isnan(panel(row, column)));
+          }
+        }
+      }
+      if (forward_fill) {
+        EXPECT_GT(filled, 0);
+      }
+    }
+  }
+}
+
+TEST(MarketSnapshotTest, FillSnapshot) {
+  auto instruments = iridium::instrument_list({"EUR_USD", "USD_JPY"});
+  auto freqs = iridium::data::data_freq_list({kDataFreq});
+  iridium::data::TradeData trade_data(kDataFilePath.u8string(), *instruments, *freqs);
+  auto snapshot = trade_data.market_snapshot();
+  ASSERT_EQ(snapshot.size(), 2);
+  EXPECT_EQ(snapshot.instrument_id("USD_JPY"), 1);
+  EXPECT_EQ(snapshot.instrument_id("GBP_USD"), iridium::data::kNoInstrument);
+
+  // USD_JPY H4 only covers 2021
+  auto ticks = iridium::calendar::all_ticks_ptr(
+      2019, 1, 1, 2019, 1, 10, "Australia/Sydney", iridium::data::DataFreq::h4);
+  trade_data.FillSnapshot(ticks->front(), iridium::data::DataFreq::h4, snapshot);
+  EXPECT_EQ(snapshot.time(), ticks->front());
+  ASSERT_TRUE(snapshot.has_data(0));
+  EXPECT_FALSE(snapshot.has_data(1));
+  EXPECT_EQ(snapshot.candlestick(0).close,
+            trade_data.candlestick_data("EUR_USD", ticks->front(), iridium::data::DataFreq::h4)->close);
+  EXPECT_EQ(snapshot.candlestick("USD_JPY"), std::nullopt);
+
+  EXPECT_EQ(iridium::data::account_currency_rate("EUR", "USD", snapshot), snapshot.candlestick(0).close);
+  EXPECT_DOUBLE_EQ(iridium::data::account_currency_rate("USD", "EUR", snapshot).value(),
+                   1.0 / snapshot.candlestick(0).close);
+  EXPECT_EQ(iridium::data::account_currency_rate("USD", "JPY", snapshot), std::nullopt);
+  EXPECT_EQ(iridium::data::account_currency_rate("AUD", "CAD", snapshot), std::nullopt);
+
+  // an instrument list built elsewhere falls back to name lookups
+  iridium::data::MarketSnapshot other(*iridium::instrument_list({"USD_JPY", "EUR_USD"}));
+  trade_data.FillSnapshot(ticks->front(), iridium::data::DataFreq::h4, other);
+  EXPECT_FALSE(other.has_data(0));
+  ASSERT_TRUE(other.has_data(1));
+  EXPECT_EQ(other.candlestick(1).time, snapshot.candlestick(0).time);
+}
+
+TEST(MarketSnapshotTest, TriangulatesCurrencyRates) {
+  iridium::data::MarketSnapshot snapshot(*iridium::instrument_list({"EUR_USD", "USD_JPY", "GBP_USD", "AUD_CAD"}));
+  snapshot.Reset(1600000000);
+  snapshot.Set(0, {1600000000, 1.1, 1.2, 1.3, 1.0, 1});
+  snapshot.Set(1, {1600000000, 105.0, 104.0, 106.0, 103.0, 1});
+  auto eur = snapshot.currency_id("EUR");
+  auto jpy = snapshot.currency_id("JPY");
+  EXPECT_EQ(snapshot.currency_id("CHF"), iridium::data::kNoCurrency);
+  EXPECT_DOUBLE_EQ(snapshot.currency_rate(eur, jpy).value(), 1.2 * 104.0);
+  EXPECT_DOUBLE_EQ(snapshot.currency_rate(jpy, eur).value(), 1.0 / 104.0 / 1.2);
+  EXPECT_EQ(snapshot.currency_rate(eur, eur), 1.0);
+  EXPECT_DOUBLE_EQ(iridium::data::account_currency_rate("EUR", "JPY", snapshot).value(), 1.2 * 104.0);
+  // GBP_USD has no data at this tick, AUD and CAD have no route to EUR
+  EXPECT_EQ(iridium::data::account_currency_rate("GBP", "JPY", snapshot), std::nullopt);
+  EXPECT_EQ(iridium::data::account_currency_rate("EUR", "CAD", snapshot), std::nullopt);
+  EXPECT_EQ(iridium::data::account_currency_rate("EUR", "CHF", snapshot), std::nullopt);
+}
+
+TEST(WindowPrefetcherTest, MatchesHistoryWindows) {
+  auto instruments = iridium::instrument_list({kDataInstrumentName});
+  auto freqs = iridium::data::data_freq_list({kDataFreq});
+  iridium::data::TradeData trade_data(kDataFilePath.u8string(), *instruments, *freqs);
+  auto ticks = iridium::calendar::all_ticks_ptr(
+      2019, 1, 1, 2019, 3, 1, "Australia/Sydney", iridium::data::DataFreq::h4);
+  std::vector<std::time_t> schedule(ticks->begin(), ticks->end());
+  schedule.insert(schedule.begin(), 0);  // fails with out_of_range
+  iridium::data::WindowPrefetcher prefetcher(
+      trade_data, *instruments, schedule, kDataHistCount, iridium::data::DataFreq::h4, 4);
+  EXPECT_THROW(prefetcher.windows(0), std::out_of_range);
+  for (std::size_t i = 1; i < schedule.size(); i += (i % 7 == 0 ? 3 : 1)) {
+    auto expected = trade_data.history_windows(*instruments, schedule[i], kDataHistCount, iridium::data::DataFreq::h4);
+    auto actual = prefetcher.windows(schedule[i]);
+    ASSERT_EQ(actual.size(), 1);
+    EXPECT_EQ(actual[0].begin_time(), expected[0].begin_time());
+    EXPECT_EQ(actual[0].end_time(), expected[0].end_time());
+    EXPECT_EQ(actual[0].closes().to_vector(), expected[0].closes().to_vector());
+  }
+}
+
+TEST(TradeDataTest, ConcurrentReads) {
+  auto on_demand = LoadTradeData(iridium::data::LoadMode::kOnDemand);
+  auto in_memory = LoadTradeData(iridium::data::LoadMode::kInMemory);
+  EXPECT_FALSE(on_demand->lock_free_reads());
+  EXPECT_TRUE(in_memory->lock_free_reads());
+  auto ticks = iridium::calendar::all_ticks_ptr(
+      2019, 1, 1, 2019, 3, 1, "Australia/Sydney", iridium::data::DataFreq::h4);
+  for (const auto *trade_data : {on_demand.get(), in_memory.get()}) {
+    std::vector<std::thread> threads;
+    std::vector<int> mismatches(4, 0);
+    for (std::size_t t = 0; t < mismatches.size(); ++t) {
+      threads.emplace_back([&, t] {
+        for (std::size_t i = t; i < ticks->size(); i += mismatches.size()) {
+          auto window = trade_data->history_window(
+              kDataInstrumentName, (*ticks)[i], kDataHistCount, iridium::data::DataFreq::h4);
+          if (window.end_time() != (*ticks)[i]) ++mismatches[t];
+        }
+      });
+    }
+    for (auto &thread : threads) thread.join();
+    EXPECT_EQ(mismatches, std::vector<int>(4, 0));
+  }
+}
+
+TEST(TradeDataTest, ParallelLoadProgress) {
+  auto instruments = iridium::instrument_list({"EUR_USD", "USD_JPY"});
+  auto freqs = iridium::data::data_freq_list({"M1", "H4"});
+  std::vector<iridium::data::LoadProgress> reports;
+  iridium::data::TradeDataOptions options;
+  options.load_mode = iridium::data::LoadMode::kInMemory;
+  options.load_threads = 3;
+  options.progress = [&reports](const iridium::data::LoadProgress &progress) { reports.push_back(progress); };
+  iridium::data::TradeData trade_data(kDataFilePath.u8string(), *instruments, *freqs, options);
+  ASSERT_EQ(reports.size(), 4);
+  std::set<std::string> datasets;
+  for (std::size_t i = 0; i < reports.size(); ++i) {
+    EXPECT_EQ(reports[i].completed, i + 1);
+    EXPECT_EQ(reports[i].total, 4);
+    EXPECT_GT(reports[i].rows, 0);
+    EXPECT_GE(reports[i].seconds, 0.0);
+    datasets.insert(reports[i].dataset);
+  }
+  EXPECT_EQ(datasets, (std::set<std::string>{"EUR_USD_M1", "EUR_USD_H4", "USD_JPY_M1", "USD_JPY_H4"}));
+
+  options.load_mode = iridium::data::LoadMode::kOnDemand;
+  options.progress = nullptr;
+  auto missing = iridium::data::data_freq_list({"M1", "D"});
+  EXPECT_ANY_THROW(iridium::data::TradeData(kDataFilePath.u8string(), *instruments, *missing, options));
+}
@@ -0,0 +1,107 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <iridium/account.hpp>
+#include <iridium/data.hpp>
+#include <iridium/fixed_point_store.hpp>
+#include <iridium/hdf5_store.hpp>
+#include <iridium/price.hpp>
+
+const auto kPriceFilePath = std::filesystem::current_path().parent_path() / "resources" / "history.h5";
+
+TEST(PriceScaleTest, Pipettes) {
+  iridium::data::PriceScale eur_usd(iridium::Instrument("EUR_USD"));
+  iridium::data::PriceScale usd_jpy(iridium::Instrument("USD_JPY"));
+  EXPECT_EQ(eur_usd.decimals(), 5);
+  EXPECT_EQ(usd_jpy.decimals(), 3);
+  EXPECT_EQ(eur_usd.pipettes(1.10001), 110001);
+  EXPECT_EQ(eur_usd.pipettes(1.1 + 0.00001), 110001);
+  EXPECT_EQ(usd_jpy.pipettes(104.567), 104567);
+  EXPECT_DOUBLE_EQ(eur_usd.price(110001), 1.10001);
+  auto candle = eur_usd.candlestick(eur_usd.pipettes({1600000000, 1.1, 1.10002, 1.10005, 1.09997, 7}));
+  EXPECT_EQ(candle.time, 1600000000);
+  EXPECT_DOUBLE_EQ(candle.close, 1.10002);
+  EXPECT_DOUBLE_EQ(candle.low, 1.09997);
+  EXPECT_EQ(candle.volume, 7);
+}
+
+TEST(FixedPointSeriesTest, TradeDataMatchesInMemory) {
+  auto instruments = iridium::instrument_list({"EUR_USD"});
+  auto freqs = iridium::data::data_freq_list({"M1"});
+  iridium::data::TradeDataOptions in_memory, fixed_point;
+  in_memory.load_mode = iridium::data::LoadMode::kInMemory;
+  fixed_point.load_mode = iridium::data::LoadMode::kFixedPoint;
+  iridium::data::TradeData expected_data(kPriceFilePath.u8string(), *instruments, *freqs, in_memory);
+  iridium::data::TradeData actual_data(kPriceFilePath.u8string(), *instruments, *freqs, fixed_point);
+  EXPECT_TRUE(actual_data.lock_free_reads());
+  H5::H5File file(kPriceFilePath.u8string(), H5F_ACC_RDONLY);
+  auto columns = iridium::data::ReadColumns(
+      file.openDataSet(iridium::data::instrument_dataset_path("EUR_USD_M1")));
+  iridium::data::FixedPointSeries series(*columns, iridium::data::DataFreq::m1, iridium::data::PriceScale(5));
+  EXPECT_LT(series.memory_usage(),
+            columns->size() * (sizeof(iridium::data::Candlestick) + 4 * sizeof(iridium::data::Pipettes)));
+  // windows view the prices converted at construction
+  EXPECT_EQ(series.window(100, 50).closes().data(), series.window(0, 200).closes().data() + 100);
+  auto snapshot = actual_data.market_snapshot();
+  ASSERT_TRUE(snapshot.fixed_point());
+  for (auto row : {std::size_t(500), columns->size() / 2, columns->size() - 1}) {
+    auto expected = expected_data.history_window("EUR_USD", columns->times[row], 200, iridium::data::DataFreq::m1);
+    auto actual = actual_data.history_window("EUR_USD", columns->times[row], 200, iridium::data::DataFreq::m1);
+    ASSERT_EQ(expected.size(), actual.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+      EXPECT_EQ(expected[i].time, actual[i].time);
+      EXPECT_NEAR(expected[i].close, actual[i].close, 5e-6);
+    }
+    actual_data.FillSnapshot(columns->times[row], iridium::data::DataFreq::m1, snapshot);
+    ASSERT_TRUE(snapshot.has_data(0));
+    auto fixed = series.fixed_candlestick(row);
+    EXPECT_EQ(snapshot.fixed_candlestick(0).high, fixed.high);
+    EXPECT_EQ(snapshot.fixed_candlestick(0).low, fixed.low);
+    EXPECT_DOUBLE_EQ(snapshot.candlestick(0).close, series.price_scale().price(fixed.close));
+  }
+}
+
+TEST(FixedPointSeriesTest, AccountComparesPipettes) {
+  auto instruments = iridium::instrument_list({"EUR_USD"});
+  // 1.1 + 0.00001 is one ulp above 1.10001, the quoted ask high
+  auto order_price = 1.1 + 0.00001;
+  iridium::data::Quote quote{{1600000000, 0.0, 0.0, 1.09999, 1.09990, 100},
+                             {1600000000, 0.0, 0.0, 1.10001, 1.09992, 100}};
+  for (auto fixed_point : {false, true}) {
+    iridium::data::MarketSnapshot snapshot(*instruments, fixed_point);
+    snapshot.Reset(1600000000);
+    snapshot.Set(0, {1600000000, 1.0999, 1.09996, 1.1, 1.09991, 100});
+    snapshot.SetQuote(0, quote);
+    iridium::SimulationAccount account("USD", 50, 10000, 1.0);
+    account.CreateLimitOrder(1600000000, "EUR_USD", 1000, order_price);
+    account.ProcessOrders(1600000000, snapshot);
+    EXPECT_EQ(account.trades_ptr()->size(), fixed_point ? 1 : 0);
+  }
+}
+
+TEST(FixedPointSeriesTest, OddSpreadMatchesDoubleMode) {
+  auto instruments = iridium::instrument_list({"EUR_USD"});
+  // a 1.5 pip spread puts the ask high at 1.100075, half a pipette off the pipette grid
+  for (auto fixed_point : {false, true}) {
+    for (auto [order_price, filled] : {std::make_pair(1.10007, true), std::make_pair(1.10008, false)}) {
+      iridium::data::MarketSnapshot snapshot(*instruments, fixed_point);
+      snapshot.Reset(1600000000);
+      snapshot.Set(0, {1600000000, 1.0999, 1.09996, 1.1, 1.09991, 100});
+      iridium::SimulationAccount account("USD", 50, 10000, 1.5);
+      account.CreateLimitOrder(1600000000, "EUR_USD", 1000, order_price);
+      account.ProcessOrders(1600000000, snapshot);
+      EXPECT_EQ(account.trades_ptr()->size(), filled ? 1 : 0);
+    }
+  }
+}
@@ -0,0 +1,129 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <sstream>
+#include <iridium/account.hpp>
+#include <iridium/data.hpp>
+#include <iridium/hdf5_store.hpp>
+#include <iridium/quote_store.hpp>
+
+const auto kQuoteFilePath = std::filesystem::current_path().parent_path() / "resources" / "history.h5";
+
+TEST(QuoteTickReaderTest, BuildsM1Bars) {
+  std::istringstream input(
+      "time,bid,ask\n"
+      "1599999965,1.10010,1.10020\n"
+      "1599999990,1.10030,1.10045\n"
+      "1600000019,1.10000,1.10012\n"
+      "1600000021,1.10050,1.10060\n");
+  iridium::data::QuoteTickReader reader(input);
+  auto first = reader.Next();
+  ASSERT_TRUE(first.has_value());
+  EXPECT_EQ(first->bid.time, 1599999960);
+  EXPECT_DOUBLE_EQ(first->bid.open, 1.10010);
+  EXPECT_DOUBLE_EQ(first->bid.high, 1.10030);
+  EXPECT_DOUBLE_EQ(first->bid.low, 1.10000);
+  EXPECT_DOUBLE_EQ(first->ask.high, 1.10045);
+  EXPECT_DOUBLE_EQ(first->ask.close, 1.10012);
+  EXPECT_EQ(first->ask.volume, 3);
+  auto second = reader.Next();
+  ASSERT_TRUE(second.has_value());
+  EXPECT_EQ(second->bid.time, 1600000020);
+  EXPECT_DOUBLE_EQ(second->ask.open, 1.10060);
+  EXPECT_EQ(second->bid.volume, 1);
+  EXPECT_FALSE(reader.Next().has_value());
+  for (const auto *malformed : {"1600000000\n", "1600000000,1.1\n", "1600000000,x,1.1\n", "1600000000;1.1;1.2\n"}) {
+    std::istringstream malformed_input(std::string("time,bid,ask\n") + malformed);
+    iridium::data::QuoteTickReader malformed_reader(malformed_input);
+    EXPECT_THROW(malformed_reader.Next(), std::runtime_error);
+  }
+}
+
+TEST(QuoteSeriesTest, TradeDataFillsQuotes) {
+  // copy of the history file with bid/ask quotes for EUR_USD M1
+  auto path = std::filesystem::temp_directory_path() / "iridium_quote_test.h5";
+  std::filesystem::copy_file(kQuoteFilePath, path, std::filesystem::copy_options::overwrite_existing);
+  iridium::data::CandleColumns bid, ask;
+  {
+    H5::H5File file(path.u8string(), H5F_ACC_RDWR);
+    auto mid = iridium::data::ReadColumns(
+        file.openDataSet(iridium::data::instrument_dataset_path("EUR_USD_M1")));
+    for (std::size_t i = 0; i < mid->size(); ++i) {
+      auto candle = mid->candlestick(i);
+      auto spread = (i % 7 + 1) * 1e-5;
+      bid.push_back({candle.time, candle.open - spread, candle.close - spread,
+                     candle.high - spread, candle.low - spread, candle.volume});
+      ask.push_back({candle.time, candle.open + spread, candle.close + spread,
+                     candle.high + spread, candle.low + spread, candle.volume});
+    }
+    iridium::data::WriteQuotes(file, "EUR_USD_M1", bid, ask);
+  }
+  iridium::data::QuoteSeries series(bid, ask, iridium::data::DataFreq::m1, 5);
+  EXPECT_LT(series.memory_usage(), 2 * bid.size() * sizeof(iridium::data::Candlestick));
+
+  auto instruments = iridium::instrument_list({"EUR_USD", "USD_JPY"});
+  auto freqs = iridium::data::data_freq_list({"M1"});
+  iridium::data::TradeDataOptions options;
+  options.quotes = true;
+  iridium::data::TradeData trade_data(path.u8string(), *instruments, *freqs, options);
+  auto snapshot = trade_data.market_snapshot();
+  for (auto row : {std::size_t(0), bid.size() / 2, bid.size() - 1}) {
+    trade_data.FillSnapshot(bid.times[row], iridium::data::DataFreq::m1, snapshot);
+    auto id = snapshot.instrument_id("EUR_USD");
+    ASSERT_TRUE(snapshot.has_quote(id));
+    EXPECT_FALSE(snapshot.has_quote(snapshot.instrument_id("USD_JPY")));
+    const auto &quote = snapshot.quote(id);
+    EXPECT_EQ(quote.bid.time, bid.times[row]);
+    EXPECT_NEAR(quote.bid.low, bid.lows[row], 1e-9);
+    EXPECT_NEAR(quote.ask.high, ask.highs[row], 1e-9);
+    EXPECT_NEAR(quote.ask.close, ask.closes[row], 1e-9);
+  }
+  std::filesystem::remove(path);
+}
+
+TEST(QuoteSeriesTest, AccountFillsAtQuotedAsk) {
+  auto instruments = iridium::instrument_list({"EUR_USD"});
+  iridium::data::MarketSnapshot snapshot(*instruments);
+  snapshot.Reset(1600000000);
+  snapshot.Set(0, {1600000000, 1.1000, 1.1005, 1.1010, 1.1000, 100});
+  // a limit buy at 1.1025 is out of reach with the constant 1 pip spread
+  iridium::SimulationAccount constant_spread("USD", 50, 10000, 1.0);
+  constant_spread.CreateLimitOrder(1600000000, "EUR_USD", 1000, 1.1025);
+  constant_spread.ProcessOrders(1600000000, snapshot);
+  EXPECT_TRUE(constant_spread.trades_ptr()->empty());
+  // the quoted ask of the bar reaches it
+  snapshot.SetQuote(0, {{1600000000, 0.0, 0.0, 1.1008, 1.0998, 100},
+                        {1600000000, 0.0, 0.0, 1.1030, 1.1020, 100}});
+  iridium::SimulationAccount quoted("USD", 50, 10000, 1.0);
+  quoted.CreateLimitOrder(1600000000, "EUR_USD", 1000, 1.1025);
+  quoted.ProcessOrders(1600000000, snapshot);
+  ASSERT_EQ(quoted.trades_ptr()->size(), 1);
+  EXPECT_DOUBLE_EQ(quoted.trades_ptr()->front()->price(), 1.1025);
+}
+
+TEST(QuoteSeriesTest, MarketOrderFillsAtQuotedClose) {
+  auto instruments = iridium::instrument_list({"EUR_USD"});
+  iridium::data::MarketSnapshot snapshot(*instruments);
+  snapshot.Reset(1600000000);
+  snapshot.Set(0, {1600000000, 1.1000, 1.1005, 1.1010, 1.1000, 100});
+  snapshot.SetQuote(0, {{1600000000, 0.0, 1.1003, 1.1008, 1.0998, 100},
+                        {1600000000, 0.0, 1.1025, 1.1030, 1.1020, 100}});
+  iridium::SimulationAccount account("USD", 50, 10000, 1.0);
+  account.CreateMarketOrder(1600000000, "EUR_USD", 1000, 1.1005, snapshot);
+  account.ProcessOrders(1600000000, snapshot);
+  ASSERT_EQ(account.trades_ptr()->size(), 1);
+  EXPECT_DOUBLE_EQ(account.trades_ptr()->front()->price(), 1.1025);
+  account.CloserPosition("EUR_USD", 1.0, 1.1005, 1600000060, snapshot);
+  EXPECT_NEAR(account.balance(), 10000 + 1000 * (1.1003 - 1.1025), 1e-9);
+}
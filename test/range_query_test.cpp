@@ -0,0 +1,83 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <vector>
+#include <iridium/data.hpp>
+#include <iridium/hdf5_store.hpp>
+#include <iridium/range_query.hpp>
+
+const auto kRangeFilePath = std::filesystem::current_path().parent_path() / "resources" / "history.h5";
+
+TEST(RangeExtremaTest, MatchesScan) {
+  std::mt19937 gen(7);
+  std::normal_distribution<double> step(0.0, 1e-4);
+  std::vector<double> highs, lows;
+  double price = 1.1;
+  for (int i = 0; i < 10000; ++i) {
+    price += step(gen);
+    highs.push_back(price + 2e-4);
+    lows.push_back(price - 2e-4);
+  }
+  iridium::data::RangeExtrema extrema(highs, lows);
+  ASSERT_EQ(extrema.size(), highs.size());
+  std::uniform_int_distribution<std::size_t> row(0, highs.size() - 1);
+  for (int i = 0; i < 2000; ++i) {
+    auto first = row(gen), last = row(gen);
+    if (first > last) std::swap(first, last);
+    EXPECT_EQ(extrema.max_high(first, last), *std::max_element(highs.begin() + first, highs.begin() + last + 1));
+    EXPECT_EQ(extrema.min_low(first, last), *std::min_element(lows.begin() + first, lows.begin() + last + 1));
+    auto level = lows[last] + (i % 3 - 1) * 1e-3;
+    auto expected_high = std::find_if(highs.begin() + first, highs.end(), [level](double high) { return high >= level; });
+    auto expected_low = std::find_if(lows.begin() + first, lows.end(), [level](double low) { return low <= level; });
+    EXPECT_EQ(extrema.first_high_at_or_above(first, level), expected_high - highs.begin());
+    EXPECT_EQ(extrema.first_low_at_or_below(first, level), expected_low - lows.begin());
+  }
+  EXPECT_EQ(extrema.first_high_at_or_above(0, 100.0), highs.size());
+  EXPECT_EQ(extrema.first_low_at_or_below(highs.size(), 100.0), highs.size());
+  EXPECT_THROW((void) extrema.max_high(5, highs.size()), std::out_of_range);
+}
+
+TEST(RangeExtremaTest, TradeDataQueries) {
+  auto instruments = iridium::instrument_list({"EUR_USD"});
+  auto freqs = iridium::data::data_freq_list({"H4"});
+  iridium::data::TradeData on_demand(kRangeFilePath.u8string(), *instruments, *freqs);
+  EXPECT_THROW((void) on_demand.highest_high("EUR_USD", 0, 1000, iridium::data::DataFreq::h4), std::logic_error);
+  iridium::data::TradeDataOptions options;
+  options.load_mode = iridium::data::LoadMode::kInMemory;
+  iridium::data::TradeData trade_data(kRangeFilePath.u8string(), *instruments, *freqs, options);
+  H5::H5File file(kRangeFilePath.u8string(), H5F_ACC_RDONLY);
+  auto columns = iridium::data::ReadColumns(
+      file.openDataSet(iridium::data::instrument_dataset_path("EUR_USD_H4")));
+  auto first = columns->size() / 4, last = columns->size() / 2;
+  auto begin = columns->times[first] - 1, end = columns->times[last] + 1;
+  EXPECT_EQ(trade_data.highest_high("EUR_USD", begin, end, iridium::data::DataFreq::h4),
+            *std::max_element(columns->highs.begin() + first, columns->highs.begin() + last + 1));
+  EXPECT_EQ(trade_data.lowest_low("EUR_USD", begin, end, iridium::data::DataFreq::h4),
+            *std::min_element(columns->lows.begin() + first, columns->lows.begin() + last + 1));
+  EXPECT_FALSE(trade_data.highest_high("EUR_USD", 0, 1000, iridium::data::DataFreq::h4).has_value());
+  // a stop below the close of a bar is first touched after it
+  auto stop = columns->closes[first] - 0.005;
+  auto touched = std::find_if(columns->lows.begin() + first + 1, columns->lows.end(), [stop](double low) {
+    return low <= stop;
+  });
+  auto touch_time = trade_data.first_low_at_or_below("EUR_USD", columns->times[first], stop, iridium::data::DataFreq::h4);
+  if (touched == columns->lows.end()) {
+    EXPECT_FALSE(touch_time.has_value());
+  } else {
+    EXPECT_EQ(touch_time, columns->times[touched - columns->lows.begin()]);
+  }
+  EXPECT_FALSE(trade_data.first_high_at_or_above("EUR_USD", columns->times[first], 100.0, iridium::data::DataFreq::h4));
+}
@@ -0,0 +1,90 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <iridium/calendar.hpp>
+#include <iridium/data.hpp>
+#include <iridium/resample.hpp>
+
+const auto kResampleFilePath = std::filesystem::current_path().parent_path() / "resources" / "history.h5";
+const auto kResampleRegion = "Australia/Sydney";
+
+iridium::data::CandleColumns MinuteColumns() {
+  auto ticks = iridium::calendar::all_ticks_ptr(
+      2021, 4, 5, 2021, 4, 9, kResampleRegion, iridium::data::DataFreq::m1);
+  iridium::data::CandleColumns columns;
+  for (std::size_t i = 0; i < ticks->size(); ++i) {
+    auto price = 1.2 + (i % 50) * 1e-5;
+    columns.push_back({(*ticks)[i], price, price + 1e-5, price + 3e-5, price - 2e-5, 1});
+  }
+  return columns;
+}
+
+TEST(ResamplerTest, ResampleMatchesCalendar) {
+  auto columns = MinuteColumns();
+  auto view = columns.view();
+  iridium::data::Resampler resampler(
+      iridium::data::DataFreq::m15, iridium::data::trade_start_times(view.times, kResampleRegion));
+  auto bars = resampler.Resample(view);
+  auto ticks = iridium::calendar::all_ticks_ptr(
+      2021, 4, 5, 2021, 4, 9, kResampleRegion, iridium::data::DataFreq::m15);
+  ASSERT_EQ(bars->size(), ticks->size());
+  for (std::size_t i = 0; i < bars->size(); ++i) {
+    EXPECT_EQ(bars->times[i], (*ticks)[i]);
+    EXPECT_EQ(bars->opens[i], columns.opens[i * 15]);
+    EXPECT_EQ(bars->closes[i], columns.closes[i * 15 + 14]);
+    EXPECT_EQ(bars->highs[i], *std::max_element(&columns.highs[i * 15], &columns.highs[i * 15] + 15));
+    EXPECT_EQ(bars->lows[i], *std::min_element(&columns.lows[i * 15], &columns.lows[i * 15] + 15));
+    EXPECT_EQ(bars->volumes[i], 15);
+  }
+}
+
+TEST(ResamplerTest, FormingBar) {
+  auto columns = MinuteColumns();
+  auto view = columns.view();
+  iridium::data::Resampler resampler(
+      iridium::data::DataFreq::h1, iridium::data::trade_start_times(view.times, kResampleRegion));
+  for (std::size_t i = 0; i < 60; ++i) {
+    EXPECT_EQ(resampler.Add(columns.candlestick(i)), std::nullopt);
+    ASSERT_TRUE(resampler.forming_bar());
+    EXPECT_EQ(resampler.forming_bar()->time, columns.times[0]);
+    EXPECT_EQ(resampler.forming_bar()->close, columns.closes[i]);
+    EXPECT_EQ(resampler.forming_bar()->volume, static_cast<int>(i + 1));
+  }
+  auto completed = resampler.Add(columns.candlestick(60));
+  ASSERT_TRUE(completed);
+  EXPECT_EQ(completed->time, columns.times[0]);
+  EXPECT_EQ(completed->volume, 60);
+  EXPECT_EQ(resampler.forming_bar()->time, columns.times[60]);
+  EXPECT_EQ(resampler.bar_time(columns.times[0] - iridium::data::DataFreq::d * 30), -1);
+}
+
+TEST(ResamplerTest, TradeDataResampleFromMinutes) {
+  auto instruments = iridium::instrument_list({"EUR_USD"});
+  auto freqs = iridium::data::data_freq_list({"M1", "H1"});
+  iridium::data::TradeDataOptions options;
+  options.resample_region = kResampleRegion;
+  iridium::data::TradeData resampled(kResampleFilePath.u8string(), *instruments, *freqs, options);
+  iridium::data::TradeData stored(kResampleFilePath.u8string(), *instruments, *freqs);
+  auto ticks = iridium::calendar::all_ticks_ptr(
+      2021, 5, 3, 2021, 5, 7, kResampleRegion, iridium::data::DataFreq::h1);
+  for (auto tick : *ticks) {
+    auto bar = resampled.candlestick_data("EUR_USD", tick, iridium::data::DataFreq::h1);
+    ASSERT_TRUE(bar);
+    auto minutes = stored.history_window_date_range(
+        "EUR_USD", tick, tick + iridium::data::DataFreq::h1 - iridium::data::DataFreq::m1,
+        iridium::data::DataFreq::m1);
+    EXPECT_EQ(bar->open, minutes.front().open);
+    EXPECT_EQ(bar->close, minutes.back().close);
+  }
+}
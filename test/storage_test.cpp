@@ -0,0 +1,687 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <filesystem>
+#include <iridium/data.hpp>
+#include <iridium/storage.hpp>
+#include <iridium/hdf5_store.hpp>
+#include <iridium/compressed_store.hpp>
+#include <iridium/recorder.hpp>
+#include <iridium/shm_store.hpp>
+#include <iridium/stream_store.hpp>
+#include <iridium/partition_store.hpp>
+#include <iridium/swmr_store.hpp>
+#include <sys/wait.h>
+#include <unistd.h>
+
+const auto kStorageFilePath = std::filesystem::current_path().parent_path() / "resources" / "history.h5";
+const auto kStorageDir = std::filesystem::temp_directory_path() / "iridium_storage_test";
+
+iridium::data::CandleColumns SampleColumns(int count) {
+  iridium::data::CandleColumns columns;
+  for (int i = 0; i < count; ++i) {
+    columns.push_back({1600000000 + i * 60, 1.1 + i * 1e-5, 1.2, 1.3, 1.0, i});
+  }
+  return columns;
+}
+
+TEST(CandleFileTest, WriteAndMap) {
+  std::filesystem::create_directories(kStorageDir);
+  auto path = kStorageDir / iridium::data::candle_file_name("EUR_USD", iridium::data::DataFreq::m1);
+  auto columns = SampleColumns(100);
+  iridium::data::WriteCandleFile(path.string(), "EUR_USD", iridium::data::DataFreq::m1, columns);
+
+  iridium::data::MappedCandleSeries series(path.string());
+  EXPECT_EQ(series.size(), 100);
+  EXPECT_EQ(series.instrument_name(), "EUR_USD");
+  EXPECT_EQ(series.freq(), iridium::data::DataFreq::m1);
+  EXPECT_EQ(series.row_index(1600000000 + 42 * 60), 42);
+  EXPECT_EQ(series.row_index(1600000000 + 42 * 60 + 1), -1);
+  auto window = series.window(40, 10);
+  EXPECT_EQ(window.begin_time(), 1600000000 + 40 * 60);
+  EXPECT_EQ(window.end_time(), 1600000000 + 49 * 60);
+  EXPECT_EQ(window.opens()[2], columns.opens[42]);
+  EXPECT_EQ(window.volumes().back(), 49);
+  EXPECT_THROW(series.window(95, 10), std::out_of_range);
+}
+
+TEST(CandleFileTest, NativeBackendMatchesHdf5) {
+  std::filesystem::create_directories(kStorageDir);
+  H5::H5File file(kStorageFilePath.u8string(), H5F_ACC_RDONLY);
+  auto dataset = file.openDataSet(iridium::data::instrument_dataset_path("EUR_USD_H4"));
+  auto columns = iridium::data::ReadColumns(dataset);
+  iridium::data::WriteCandleFile(
+      (kStorageDir / iridium::data::candle_file_name("EUR_USD", iridium::data::DataFreq::h4)).string(),
+      "EUR_USD",
+      iridium::data::DataFreq::h4,
+      *columns);
+
+  auto instruments = iridium::instrument_list({"EUR_USD"});
+  auto freqs = iridium::data::data_freq_list({"H4"});
+  iridium::data::TradeData hdf5_data(kStorageFilePath.u8string(), *instruments, *freqs);
+  iridium::data::TradeData native_data(kStorageDir.u8string(), *instruments, *freqs);
+  auto end = columns->times.at(columns->size() / 2);
+  auto expected = hdf5_data.history_window("EUR_USD", end, 90, iridium::data::DataFreq::h4);
+  auto actual = native_data.history_window("EUR_USD", end, 90, iridium::data::DataFreq::h4);
+  ASSERT_EQ(expected.size(), actual.size());
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(expected[i].time, actual[i].time);
+    EXPECT_EQ(expected[i].high, actual[i].high);
+  }
+}
+
+TEST(CompressedCandleSeriesTest, RoundTrip) {
+  iridium::data::CandleColumns columns;
+  std::time_t time = 1600000000;
+  for (int i = 0; i < 1000; ++i) {
+    time += i % 97 == 0 ? 300 : 60;
+    auto open = 1.1 + (i % 37) * 1e-5;
+    columns.push_back({time, open, open + 2e-5, open + 5e-5, open - 3e-5, i});
+  }
+  iridium::data::CompressedCandleSeries series(columns, iridium::data::DataFreq::m1, 5);
+  EXPECT_EQ(series.size(), columns.size());
+  EXPECT_LT(series.memory_usage() * 3, columns.size() * sizeof(iridium::data::Candlestick));
+  EXPECT_EQ(series.row_index(columns.times[500]), 500);
+  EXPECT_EQ(series.row_index(columns.times[500] + 1), -1);
+  EXPECT_EQ(series.row_index(columns.times[0] - 60), -1);
+
+  auto window = series.window(120, 300);
+  ASSERT_EQ(window.size(), 300);
+  for (std::size_t i = 0; i < window.size(); ++i) {
+    EXPECT_EQ(window[i].time, columns.times[120 + i]);
+    EXPECT_DOUBLE_EQ(window[i].open, columns.opens[120 + i]);
+    EXPECT_DOUBLE_EQ(window[i].low, columns.lows[120 + i]);
+    EXPECT_EQ(window[i].volume, columns.volumes[120 + i]);
+  }
+}
+
+TEST(CompressedCandleSeriesTest, TradeDataMatchesInMemory) {
+  auto instruments = iridium::instrument_list({"EUR_USD"});
+  auto freqs = iridium::data::data_freq_list({"M1"});
+  iridium::data::TradeDataOptions in_memory, compressed;
+  in_memory.load_mode = iridium::data::LoadMode::kInMemory;
+  compressed.load_mode = iridium::data::LoadMode::kCompressed;
+  iridium::data::TradeData expected_data(kStorageFilePath.u8string(), *instruments, *freqs, in_memory);
+  iridium::data::TradeData actual_data(kStorageFilePath.u8string(), *instruments, *freqs, compressed);
+  H5::H5File file(kStorageFilePath.u8string(), H5F_ACC_RDONLY);
+  auto columns = iridium::data::ReadColumns(
+      file.openDataSet(iridium::data::instrument_dataset_path("EUR_USD_M1")));
+  for (auto row : {std::size_t(500), columns->size() / 2, columns->size() - 1}) {
+    auto expected = expected_data.history_window("EUR_USD", columns->times[row], 200, iridium::data::DataFreq::m1);
+    auto actual = actual_data.history_window("EUR_USD", columns->times[row], 200, iridium::data::DataFreq::m1);
+    ASSERT_EQ(expected.size(), actual.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+      EXPECT_EQ(expected[i].time, actual[i].time);
+      EXPECT_NEAR(expected[i].close, actual[i].close, 5e-6);
+    }
+  }
+}
+
+TEST(RowSearchTest, FindRowRange) {
+  H5::H5File file(kStorageFilePath.u8string(), H5F_ACC_RDONLY);
+  auto dataset = file.openDataSet(iridium::data::instrument_dataset_path("EUR_USD_M1"));
+  auto columns = iridium::data::ReadColumns(dataset);
+  const auto &times = columns->times;
+  ASSERT_GT(times.size(), 3 * iridium::data::kTimeSearchRows);
+  for (auto [first, last] : {std::pair<std::size_t, std::size_t>{0, 10},
+                             {iridium::data::kTimeSearchRows - 1, 2 * iridium::data::kTimeSearchRows + 5},
+                             {times.size() / 2, times.size() - 1}}) {
+    auto rows = iridium::data::FindRowRange(dataset, times[first], times[last], 100);
+    EXPECT_EQ(rows.first, first > 100 ? first - 100 : 0);
+    EXPECT_EQ(rows.first + rows.count, last + 1);
+    auto scoped = iridium::data::ReadColumns(dataset, rows);
+    ASSERT_EQ(scoped->size(), rows.count);
+    EXPECT_EQ(scoped->times.front(), times[rows.first]);
+    EXPECT_EQ(scoped->closes.back(), columns->closes[last]);
+  }
+  // bounds between bars and outside the data
+  auto rows = iridium::data::FindRowRange(dataset, times[5] - 1, times[8] + 1, 0);
+  EXPECT_EQ(rows.first, 5);
+  EXPECT_EQ(rows.count, 4);
+  EXPECT_EQ(iridium::data::FindRowRange(dataset, times.back() + 60, times.back() + 600, 10).count, 10);
+  EXPECT_EQ(iridium::data::FindRowRange(dataset, times.front() - 600, times.front() - 60, 10).count, 0);
+  // single rows within a sub-range
+  iridium::data::RowRange sub{100, times.size() - 200};
+  for (auto row : {std::size_t{100}, times.size() / 3, times.size() - 101}) {
+    EXPECT_EQ(iridium::data::FindRow(dataset, sub, times[row]), row);
+    EXPECT_EQ(iridium::data::FindRow(dataset, sub, times[row] + 1), row + 1);
+  }
+  EXPECT_EQ(iridium::data::FindRow(dataset, sub, times.front()), 100);
+  EXPECT_EQ(iridium::data::FindRow(dataset, sub, times.back()), times.size() - 100);
+}
+
+TEST(RowSearchTest, TradeDataRangeMatchesFullLoad) {
+  auto instruments = iridium::instrument_list({"EUR_USD"});
+  auto freqs = iridium::data::data_freq_list({"M1", "H4"});
+  iridium::data::TradeDataOptions full, scoped;
+  full.load_mode = iridium::data::LoadMode::kInMemory;
+  full.resample_region = "Australia/Sydney";
+  scoped = full;
+  H5::H5File file(kStorageFilePath.u8string(), H5F_ACC_RDONLY);
+  auto times = iridium::data::ReadColumns(
+      file.openDataSet(iridium::data::instrument_dataset_path("EUR_USD_M1")))->times;
+  auto begin = times[times.size() / 2] / iridium::data::DataFreq::h4 * iridium::data::DataFreq::h4;
+  scoped.range = iridium::data::TimeRange{begin, begin + 7 * 86400};
+  scoped.warm_up_bars = 20;
+  iridium::data::TradeData expected_data(kStorageFilePath.u8string(), *instruments, *freqs, full);
+  for (auto load_mode : {iridium::data::LoadMode::kInMemory, iridium::data::LoadMode::kOnDemand}) {
+    scoped.load_mode = load_mode;
+    iridium::data::TradeData actual_data(kStorageFilePath.u8string(), *instruments, *freqs, scoped);
+    for (auto time = begin; time <= begin + 7 * 86400; time += iridium::data::DataFreq::h4) {
+      ASSERT_EQ(expected_data.has_bar("EUR_USD", time, iridium::data::DataFreq::h4),
+                actual_data.has_bar("EUR_USD", time, iridium::data::DataFreq::h4));
+      if (!expected_data.has_bar("EUR_USD", time, iridium::data::DataFreq::h4)) {
+        continue;
+      }
+      auto expected = expected_data.history_window("EUR_USD", time, 20, iridium::data::DataFreq::h4);
+      auto actual = actual_data.history_window("EUR_USD", time, 20, iridium::data::DataFreq::h4);
+      ASSERT_EQ(expected.size(), actual.size());
+      for (std::size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(expected[i].time, actual[i].time);
+        EXPECT_EQ(expected[i].close, actual[i].close);
+      }
+    }
+    EXPECT_FALSE(actual_data.has_bar("EUR_USD", times.front(), iridium::data::DataFreq::m1));
+  }
+}
+
+TEST(Hdf5DataSetNamesTest, ListsAndSplits) {
+  H5::H5File file(kStorageFilePath.u8string(), H5F_ACC_RDONLY);
+  auto names = iridium::data::ListCandleDataSets(file);
+  EXPECT_NE(std::find(names.begin(), names.end(), "EUR_USD_M1"), names.end());
+  auto split = iridium::data::SplitDataSetName("EUR_USD_H4");
+  ASSERT_TRUE(split.has_value());
+  EXPECT_EQ(split->first, "EUR_USD");
+  EXPECT_EQ(split->second, iridium::data::DataFreq::h4);
+  EXPECT_FALSE(iridium::data::SplitDataSetName("EURUSD").has_value());
+}
+
+TEST(ShmStoreTest, TradeDataAttachesToPublishedColumns) {
+  auto prefix = "iridium_test_" + std::to_string(::getpid());
+  H5::H5File file(kStorageFilePath.u8string(), H5F_ACC_RDONLY);
+  auto columns = iridium::data::ReadColumns(
+      file.openDataSet(iridium::data::instrument_dataset_path("EUR_USD_H4")));
+  {
+    iridium::data::ShmPublisher publisher(prefix);
+    publisher.Publish("EUR_USD", iridium::data::DataFreq::h4, SampleColumns(10));
+    // republishing replaces the object while attached readers keep theirs
+    auto stale = iridium::data::AttachShmSeries(prefix, "EUR_USD", iridium::data::DataFreq::h4);
+    publisher.Publish("EUR_USD", iridium::data::DataFreq::h4, *columns);
+    EXPECT_EQ(publisher.segments().size(), 1);
+    EXPECT_EQ(stale->size(), 10);
+
+    auto instruments = iridium::instrument_list({"EUR_USD"});
+    auto freqs = iridium::data::data_freq_list({"H4"});
+    iridium::data::TradeDataOptions options;
+    options.backend = iridium::data::StorageBackend::kSharedMemory;
+    iridium::data::TradeData trade_data(prefix, *instruments, *freqs, options);
+    EXPECT_TRUE(trade_data.lock_free_reads());
+    auto window = trade_data.history_window("EUR_USD", columns->times.back(), 50, iridium::data::DataFreq::h4);
+    ASSERT_EQ(window.size(), 50);
+    for (std::size_t i = 0; i < window.size(); ++i) {
+      EXPECT_EQ(window[i].time, columns->times[columns->size() - 50 + i]);
+      EXPECT_EQ(window[i].close, columns->closes[columns->size() - 50 + i]);
+    }
+  }
+  // the publisher unlinks its objects
+  EXPECT_THROW(iridium::data::AttachShmSeries(prefix, "EUR_USD", iridium::data::DataFreq::h4), std::runtime_error);
+}
+
+TEST(StreamingSeriesTest, WalksForwardWithinBoundedBuffer) {
+  H5::H5File file(kStorageFilePath.u8string(), H5F_ACC_RDONLY);
+  auto dataset = std::make_shared<H5::DataSet>(
+      file.openDataSet(iridium::data::instrument_dataset_path("EUR_USD_M1")));
+  auto columns = iridium::data::ReadColumns(*dataset);
+  iridium::data::StreamingSeries series(dataset, iridium::data::DataFreq::m1, 90, 1000);
+  ASSERT_EQ(series.size(), columns->size());
+  for (std::size_t row = 0; row < columns->size(); ++row) {
+    ASSERT_EQ(series.row_index(columns->times[row]), row);
+    if (row >= 89) {
+      auto window = series.window(row - 89, 90);
+      ASSERT_EQ(window.times()[0], columns->times[row - 89]);
+      ASSERT_EQ(window.closes()[89], columns->closes[row]);
+    }
+    ASSERT_LE(series.buffered_rows(), 1090);
+  }
+  EXPECT_EQ(series.reads(), (columns->size() - 90 + 999) / 1000);
+  // seeking back and reading past the buffer
+  auto row = columns->size() / 3;
+  EXPECT_EQ(series.row_index(columns->times[row]), row);
+  EXPECT_EQ(series.row_index(columns->times[row] + 30), iridium::data::kNoBar);
+  EXPECT_EQ(series.row_index(columns->times.front() - 60), iridium::data::kNoBar);
+  EXPECT_EQ(series.row_index(columns->times.back() + 60), iridium::data::kNoBar);
+  auto window = series.window(0, 5000);
+  EXPECT_EQ(window.times()[4999], columns->times[4999]);
+  EXPECT_LE(series.buffered_rows(), 1090);
+}
+
+TEST(StreamingSeriesTest, LookupPastTheEndWithoutLookback) {
+  H5::H5File file(kStorageFilePath.u8string(), H5F_ACC_RDONLY);
+  auto dataset = std::make_shared<H5::DataSet>(
+      file.openDataSet(iridium::data::instrument_dataset_path("EUR_USD_M1")));
+  auto columns = iridium::data::ReadColumns(*dataset);
+  iridium::data::StreamingSeries series(dataset, iridium::data::DataFreq::m1, 0, 16);
+  EXPECT_EQ(series.row_index(columns->times.back() + 60000), iridium::data::kNoBar);
+  EXPECT_EQ(series.buffered_rows(), 0);
+  EXPECT_EQ(series.row_index(columns->times[100]), 100);
+  EXPECT_EQ(series.row_index(columns->times.back() + 60000), iridium::data::kNoBar);
+  EXPECT_EQ(series.row_index(columns->times.back()), columns->size() - 1);
+  EXPECT_EQ(series.window(columns->size(), 0).size(), 0);
+  iridium::data::TradeDataOptions options;
+  options.load_mode = iridium::data::LoadMode::kStreaming;
+  EXPECT_THROW(iridium::data::TradeData(kStorageFilePath.u8string(), *iridium::instrument_list({"EUR_USD"}),
+                                        *iridium::data::data_freq_list({"M1"}), options), std::invalid_argument);
+}
+
+TEST(StreamingSeriesTest, TradeDataMatchesInMemory) {
+  auto instruments = iridium::instrument_list({"EUR_USD", "USD_JPY"});
+  auto freqs = iridium::data::data_freq_list({"M1", "H4"});
+  iridium::data::TradeDataOptions in_memory, streaming;
+  in_memory.load_mode = iridium::data::LoadMode::kInMemory;
+  streaming.load_mode = iridium::data::LoadMode::kStreaming;
+  streaming.warm_up_bars = 90;
+  streaming.stream_block_rows = 2048;
+  iridium::data::TradeData expected_data(kStorageFilePath.u8string(), *instruments, *freqs, in_memory);
+  iridium::data::TradeData actual_data(kStorageFilePath.u8string(), *instruments, *freqs, streaming);
+  EXPECT_FALSE(actual_data.lock_free_reads());
+  H5::H5File file(kStorageFilePath.u8string(), H5F_ACC_RDONLY);
+  auto times = iridium::data::ReadColumns(
+      file.openDataSet(iridium::data::instrument_dataset_path("EUR_USD_M1")))->times;
+  for (std::size_t row = 100; row < times.size(); row += 97) {
+    for (const auto &instrument : *instruments) {
+      auto expected = expected_data.try_candle(instrument->name(), times[row], iridium::data::DataFreq::m1);
+      auto actual = actual_data.try_candle(instrument->name(), times[row], iridium::data::DataFreq::m1);
+      ASSERT_EQ(expected.has_value(), actual.has_value());
+      if (!expected) continue;
+      EXPECT_EQ(expected->close, actual->close);
+      auto expected_window = expected_data.history_window(instrument->name(), times[row], 90, iridium::data::DataFreq::m1);
+      auto actual_window = actual_data.history_window(instrument->name(), times[row], 90, iridium::data::DataFreq::m1);
+      EXPECT_EQ(expected_window.times()[0], actual_window.times()[0]);
+      EXPECT_EQ(expected_window.lows()[89], actual_window.lows()[89]);
+    }
+  }
+  auto h4_times = iridium::data::ReadColumns(
+      file.openDataSet(iridium::data::instrument_dataset_path("EUR_USD_H4")))->times;
+  auto begin = h4_times[10], end = h4_times[h4_times.size() - 10];
+  auto expected = expected_data.history_window_date_range("EUR_USD", begin, end, iridium::data::DataFreq::h4);
+  auto actual = actual_data.history_window_date_range("EUR_USD", begin, end, iridium::data::DataFreq::h4);
+  ASSERT_EQ(expected.size(), actual.size());
+  EXPECT_EQ(expected.highs()[expected.size() / 2], actual.highs()[actual.size() / 2]);
+  iridium::data::TradeDataOptions resampled = streaming;
+  resampled.resample_region = "Australia/Sydney";
+  EXPECT_THROW(iridium::data::TradeData(kStorageFilePath.u8string(), *instruments, *freqs, resampled), std::invalid_argument);
+}
+
+TEST(Hdf5ChunkTest, DirectChunkReadsMatchContiguous) {
+  H5::H5File source(kStorageFilePath.u8string(), H5F_ACC_RDONLY);
+  auto expected = iridium::data::ReadColumns(
+      source.openDataSet(iridium::data::instrument_dataset_path("EUR_USD_M1")));
+  auto path = std::filesystem::temp_directory_path() / "iridium_chunk_test.h5";
+  for (auto layout : {iridium::data::ChunkLayout{1000, 4, true}, iridium::data::ChunkLayout{4096, 0, false}}) {
+    {
+      H5::H5File file(path.u8string(), H5F_ACC_TRUNC);
+      iridium::data::WriteCandles(file, "EUR_USD_M1", *expected, layout);
+    }
+    H5::H5File file(path.u8string(), H5F_ACC_RDONLY);
+    auto dataset = iridium::data::OpenCandleDataSet(file, "EUR_USD_M1");
+    auto actual = iridium::data::ReadColumns(*dataset);
+    EXPECT_EQ(actual->times, expected->times);
+    EXPECT_EQ(actual->opens, expected->opens);
+    EXPECT_EQ(actual->closes, expected->closes);
+    EXPECT_EQ(actual->highs, expected->highs);
+    EXPECT_EQ(actual->lows, expected->lows);
+    EXPECT_EQ(actual->volumes, expected->volumes);
+    auto range = iridium::data::ReadColumns(*dataset, {1234, 5000});
+    ASSERT_EQ(range->size(), 5000);
+    EXPECT_EQ(range->times.front(), expected->times[1234]);
+    EXPECT_EQ(range->closes.back(), expected->closes[1234 + 4999]);
+    EXPECT_EQ(iridium::data::ReadColumns(*dataset, {expected->size(), 0})->size(), 0);
+    EXPECT_THROW(iridium::data::ReadColumns(*dataset, {expected->size() - 1, 2}), std::out_of_range);
+  }
+  // on-demand windows go through the chunk cache of the repacked dataset
+  auto instruments = iridium::instrument_list({"EUR_USD"});
+  auto freqs = iridium::data::data_freq_list({"M1"});
+  iridium::data::TradeData trade_data(path.u8string(), *instruments, *freqs);
+  auto window = trade_data.history_window("EUR_USD", expected->times[3000], 100, iridium::data::DataFreq::m1);
+  EXPECT_EQ(window.times()[0], expected->times[2901]);
+  EXPECT_EQ(window.highs()[99], expected->highs[3000]);
+  std::filesystem::remove(path);
+}
+
+TEST(PartitionStoreTest, PrunesYearsAndMerges) {
+  // H4 bars from 2019-11-01 to 2020-02-09 UTC, 366 of them in 2019
+  iridium::data::CandleColumns columns;
+  for (int i = 0; i < 600; ++i) {
+    columns.push_back({1572566400 + i * 14400, 1.1 + i * 1e-5, 1.2, 1.3, 1.0, i});
+  }
+  auto directory = std::filesystem::temp_directory_path() / "iridium_partition_test";
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+  iridium::data::PartitionManifest manifest(directory.u8string());
+  iridium::data::CandleColumns head;
+  for (std::size_t i = 0; i < 500; ++i) head.push_back(columns.candlestick(i));
+  iridium::data::WritePartitions(manifest, "EUR_USD", iridium::data::DataFreq::h4, head);
+  auto partitions = manifest.partitions("EUR_USD", iridium::data::DataFreq::h4);
+  ASSERT_EQ(partitions.size(), 2);
+  EXPECT_EQ(partitions[0].year, 2019);
+  EXPECT_EQ(partitions[0].rows, 366);
+  EXPECT_EQ(partitions[1].first_time, 1577836800);
+  EXPECT_EQ(partitions[1].rows, 134);
+  // rows of 2020 only rewrite the 2020 partition, overlapping rows are replaced
+  auto path_2019 = std::filesystem::path(manifest.path(partitions[0]));
+  auto written_2019 = std::filesystem::last_write_time(path_2019);
+  iridium::data::CandleColumns tail;
+  for (std::size_t i = 450; i < 600; ++i) tail.push_back(columns.candlestick(i));
+  tail.closes[0] = 1.25;
+  columns.closes[450] = 1.25;
+  iridium::data::WritePartitions(manifest, "EUR_USD", iridium::data::DataFreq::h4, tail);
+  EXPECT_EQ(std::filesystem::last_write_time(path_2019), written_2019);
+  partitions = iridium::data::PartitionManifest(directory.u8string())
+      .partitions("EUR_USD", iridium::data::DataFreq::h4);
+  ASSERT_EQ(partitions.size(), 2);
+  EXPECT_EQ(partitions[1].rows, 234);
+  EXPECT_EQ(partitions[1].last_time, columns.times.back());
+
+  auto instruments = iridium::instrument_list({"EUR_USD"});
+  auto freqs = iridium::data::data_freq_list({"H4"});
+  iridium::data::TradeDataOptions options;
+  for (auto load_mode : {iridium::data::LoadMode::kOnDemand, iridium::data::LoadMode::kStreaming}) {
+    options.load_mode = load_mode;
+    EXPECT_THROW(iridium::data::TradeData(directory.u8string(), *instruments, *freqs, options), std::invalid_argument);
+  }
+  options.load_mode = iridium::data::LoadMode::kInMemory;
+  iridium::data::TradeData full(directory.u8string(), *instruments, *freqs, options);
+  auto window = full.history_window("EUR_USD", columns.times.back(), 600, iridium::data::DataFreq::h4);
+  ASSERT_EQ(window.size(), 600);
+  for (std::size_t i = 0; i < window.size(); ++i) {
+    ASSERT_EQ(window.times()[i], columns.times[i]);
+  }
+  EXPECT_EQ(window.closes()[450], 1.25);
+  // a January range warms up from the end of the 2019 partition
+  options.backend = iridium::data::StorageBackend::kPartitioned;
+  options.range = iridium::data::TimeRange{columns.times[380], columns.times[420]};
+  options.warm_up_bars = 20;
+  for (auto lazy_open : {false, true}) {
+    options.lazy_open = lazy_open;
+    iridium::data::TradeData scoped(directory.u8string(), *instruments, *freqs, options);
+    EXPECT_FALSE(scoped.has_bar("EUR_USD", columns.times[359], iridium::data::DataFreq::h4));
+    EXPECT_FALSE(scoped.has_bar("EUR_USD", columns.times[421], iridium::data::DataFreq::h4));
+    auto actual = scoped.history_window("EUR_USD", columns.times[380], 21, iridium::data::DataFreq::h4);
+    ASSERT_EQ(actual.size(), 21);
+    for (std::size_t i = 0; i < actual.size(); ++i) {
+      EXPECT_EQ(actual.times()[i], columns.times[360 + i]);
+      EXPECT_EQ(actual.closes()[i], columns.closes[360 + i]);
+    }
+  }
+  std::filesystem::remove_all(directory);
+}
+
+TEST(TimeIndexTest, GapAwareLookup) {
+  // two runs of M1 bars separated by a weekend gap and one missing bar
+  std::vector<std::time_t> times;
+  for (int i = 0; i < 10; ++i) times.push_back(1599999960 + i * 60);
+  for (int i = 0; i < 10; ++i) {
+    if (i != 4) times.push_back(1600200000 + i * 60);
+  }
+  iridium::data::TimeIndex index(times, iridium::data::DataFreq::m1);
+  EXPECT_EQ(index.run_count(), 3);
+  EXPECT_TRUE(index.has_bitmap());
+  // the bitmap covers every minute across the gap, not only the runs
+  auto minutes = static_cast<std::size_t>((times.back() - times.front()) / 60 + 1);
+  EXPECT_GE(index.memory_usage(),
+            minutes / 64 * sizeof(std::uint64_t) + 3 * (sizeof(std::time_t) + sizeof(std::size_t)));
+  for (std::size_t i = 0; i < times.size(); ++i) {
+    EXPECT_EQ(index.row(times[i]), static_cast<int>(i));
+  }
+  EXPECT_EQ(index.row(1599999960 - 60), iridium::data::kNoBar);
+  EXPECT_EQ(index.row(1599999960 + 30), iridium::data::kNoBar);
+  EXPECT_EQ(index.row(1599999960 + 10 * 60), iridium::data::kNoBar);
+  EXPECT_EQ(index.row(1600200000 + 4 * 60), iridium::data::kNoBar);
+  EXPECT_EQ(index.row(1600200000 + 10 * 60), iridium::data::kNoBar);
+
+  // a time off the grid falls back to searching the runs
+  times.push_back(1600300030);
+  iridium::data::TimeIndex off_grid(times, iridium::data::DataFreq::m1);
+  EXPECT_FALSE(off_grid.has_bitmap());
+  for (std::size_t i = 0; i < times.size(); ++i) {
+    EXPECT_EQ(off_grid.row(times[i]), static_cast<int>(i));
+  }
+  EXPECT_EQ(off_grid.row(1600200000 + 4 * 60), iridium::data::kNoBar);
+}
+
+TEST(TimeIndexTest, AppendMatchesConstruction) {
+  std::vector<std::time_t> times;
+  for (int i = 0; i < 300; ++i) {
+    if (i % 70 != 3) times.push_back(1599999960 + i * 60 + (i >= 150 ? 2 * 86400 : 0));
+  }
+  for (auto split : {std::size_t{0}, std::size_t{1}, std::size_t{64}, std::size_t{150}, times.size()}) {
+    std::vector<std::time_t> head(times.begin(), times.begin() + split), tail(times.begin() + split, times.end());
+    iridium::data::TimeIndex index(head, iridium::data::DataFreq::m1);
+    index.Append(tail);
+    iridium::data::TimeIndex expected(times, iridium::data::DataFreq::m1);
+    EXPECT_EQ(index.run_count(), expected.run_count());
+    EXPECT_EQ(index.has_bitmap(), expected.has_bitmap());
+    for (auto time = times.front() - 60; time <= times.back() + 60; time += 60) {
+      ASSERT_EQ(index.row(time), expected.row(time));
+    }
+  }
+  iridium::data::TimeIndex index(times, iridium::data::DataFreq::m1);
+  EXPECT_THROW(index.Append(std::vector<std::time_t>{times.back()}), std::invalid_argument);
+  index.Append(std::vector<std::time_t>{times.back() + 30});
+  EXPECT_FALSE(index.has_bitmap());
+  EXPECT_EQ(index.row(times.back() + 30), static_cast<int>(times.size()));
+  EXPECT_EQ(index.row(times[100]), 100);
+}
+
+TEST(SwmrTest, RefreshReadsAppendedRows) {
+  std::shared_ptr<iridium::data::CandleColumns> expected;
+  {
+    H5::H5File source(kStorageFilePath.u8string(), H5F_ACC_RDONLY);
+    expected = iridium::data::ReadColumns(source.openDataSet(iridium::data::instrument_dataset_path("EUR_USD_H4")));
+  }
+  auto rows = [&expected](std::size_t first, std::size_t last) {
+    iridium::data::DataList candles;
+    for (auto i = first; i < last; ++i) candles.push_back(expected->candlestick(i));
+    return candles;
+  };
+  auto path = std::filesystem::temp_directory_path() / ("iridium_swmr_test_" + std::to_string(getpid()) + ".h5");
+  auto instruments = iridium::instrument_list({"EUR_USD"});
+  auto freqs = iridium::data::data_freq_list({"H4"});
+  // the writer runs in a child process, each side waits on a pipe for the other
+  int ready[2], resume[2];
+  ASSERT_EQ(pipe(ready), 0);
+  ASSERT_EQ(pipe(resume), 0);
+  auto pid = fork();
+  ASSERT_NE(pid, -1);
+  if (pid == 0) {
+    close(ready[0]);
+    close(resume[1]);
+    int status = 0;
+    char c = 0;
+    try {
+      iridium::data::Hdf5Appender appender(path.u8string(), *instruments, *freqs);
+      status |= appender.Append("EUR_USD", iridium::data::DataFreq::h4, rows(0, 1000)) != 1000;
+      status |= write(ready[1], &c, 1) != 1 || read(resume[0], &c, 1) != 1;
+      // rows 900 ... 999 are already stored
+      status |= appender.Append("EUR_USD", iridium::data::DataFreq::h4, rows(900, 1500)) != 500;
+      status |= appender.last_time("EUR_USD", iridium::data::DataFreq::h4) != expected->times[1499];
+      status |= write(ready[1], &c, 1) != 1 || read(resume[0], &c, 1) != 1;
+    } catch (...) {
+      status = 2;
+    }
+    _exit(status);
+  }
+  close(ready[1]);
+  close(resume[0]);
+  char c = 0;
+  ASSERT_EQ(read(ready[0], &c, 1), 1);
+  {
+    iridium::data::TradeDataOptions options;
+    options.swmr_read = true;
+    iridium::data::TradeData trade_data(path.u8string(), *instruments, *freqs, options);
+    EXPECT_TRUE(trade_data.has_bar("EUR_USD", expected->times[999], iridium::data::DataFreq::h4));
+    EXPECT_FALSE(trade_data.has_bar("EUR_USD", expected->times[1000], iridium::data::DataFreq::h4));
+    auto before = trade_data.history_window("EUR_USD", expected->times[999], 100, iridium::data::DataFreq::h4);
+    EXPECT_EQ(trade_data.highest_high("EUR_USD", expected->times[0], expected->times[1499], iridium::data::DataFreq::h4),
+              *std::max_element(expected->highs.begin(), expected->highs.begin() + 1000));
+    EXPECT_EQ(trade_data.Refresh(), 0);
+
+    ASSERT_EQ(write(resume[1], &c, 1), 1);
+    ASSERT_EQ(read(ready[0], &c, 1), 1);
+    EXPECT_EQ(trade_data.Refresh(), 500);
+    EXPECT_TRUE(trade_data.has_bar("EUR_USD", expected->times[1499], iridium::data::DataFreq::h4));
+    auto after = trade_data.history_window("EUR_USD", expected->times[1499], 1500, iridium::data::DataFreq::h4);
+    for (std::size_t i = 0; i < after.size(); ++i) {
+      ASSERT_EQ(after.times()[i], expected->times[i]);
+      ASSERT_EQ(after.closes()[i], expected->closes[i]);
+    }
+    for (std::size_t i = 0; i < before.size(); ++i) {
+      ASSERT_EQ(before.highs()[i], expected->highs[900 + i]);
+    }
+    EXPECT_EQ(trade_data.highest_high("EUR_USD", expected->times[0], expected->times[1499], iridium::data::DataFreq::h4),
+              *std::max_element(expected->highs.begin(), expected->highs.begin() + 1500));
+  }
+  ASSERT_EQ(write(resume[1], &c, 1), 1);
+  int status = -1;
+  waitpid(pid, &status, 0);
+  EXPECT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(WEXITSTATUS(status), 0);
+  close(ready[0]);
+  close(resume[1]);
+
+  // datasets stored by ascending time also read on demand and within a range
+  iridium::data::TradeDataOptions scoped;
+  scoped.range = iridium::data::TimeRange{expected->times[1200], expected->times[1300]};
+  scoped.warm_up_bars = 10;
+  for (const auto &options : {iridium::data::TradeDataOptions(), scoped}) {
+    iridium::data::TradeData trade_data(path.u8string(), *instruments, *freqs, options);
+    auto window = trade_data.history_window("EUR_USD", expected->times[1300], 111, iridium::data::DataFreq::h4);
+    for (std::size_t i = 0; i < window.size(); ++i) {
+      ASSERT_EQ(window.times()[i], expected->times[1190 + i]);
+      ASSERT_EQ(window.lows()[i], expected->lows[1190 + i]);
+    }
+  }
+
+  // datasets written by other tools are stored by descending time and cannot be appended to
+  {
+    H5::H5File file(path.u8string(), H5F_ACC_TRUNC);
+    iridium::data::WriteCandles(file, "EUR_USD_H4", *expected, iridium::data::ChunkLayout());
+  }
+  EXPECT_ANY_THROW(iridium::data::Hdf5Appender(path.u8string(), *instruments, *freqs));
+  std::filesystem::remove(path);
+}
+
+TEST(ChunkCacheTest, EvictsWithinBudget) {
+  auto chunk = std::make_shared<const iridium::data::CandleColumns>(SampleColumns(100));
+  auto chunk_bytes = 100 * (sizeof(std::time_t) + 4 * sizeof(double) + sizeof(int));
+  iridium::data::ChunkCache cache(3 * chunk_bytes);
+  int loads = 0;
+  auto load = [&] {
+    ++loads;
+    return chunk;
+  };
+  auto id = iridium::data::ChunkCache::NextSeriesId();
+  for (std::size_t i = 0; i < 5; ++i) {
+    EXPECT_EQ(cache.Get(id, i, load), chunk);
+  }
+  EXPECT_EQ(loads, 5);
+  EXPECT_LE(cache.cached_bytes(), cache.budget_bytes());
+  // chunk 4 is the most recently used, chunk 0 was evicted
+  cache.Get(id, 4, load);
+  EXPECT_EQ(loads, 5);
+  cache.Get(id, 0, load);
+  EXPECT_EQ(loads, 6);
+  EXPECT_EQ(cache.hits(), 1);
+  EXPECT_EQ(cache.misses(), 6);
+}
+
+TEST(LazySeriesTest, OpensOnFirstAccess) {
+  auto columns = std::make_shared<const iridium::data::CandleColumns>(SampleColumns(10));
+  int opens = 0;
+  iridium::data::LazySeries series([&]() -> std::shared_ptr<iridium::data::CandleSeries> {
+    ++opens;
+    return std::make_shared<iridium::data::ColumnSeries>(columns, iridium::data::DataFreq::m1);
+  });
+  EXPECT_FALSE(series.opened());
+  EXPECT_EQ(opens, 0);
+  EXPECT_EQ(series.row_index(columns->times[3]), 3);
+  EXPECT_EQ(series.window(2, 4)[0].time, columns->times[2]);
+  EXPECT_EQ(series.size(), 10);
+  EXPECT_TRUE(series.opened());
+  EXPECT_EQ(opens, 1);
+}
+
+TEST(LazySeriesTest, TradeDataLazyOpenWithChunkCache) {
+  auto instruments = iridium::instrument_list({"EUR_USD", "USD_JPY"});
+  auto freqs = iridium::data::data_freq_list({"M1", "D"});
+  iridium::data::TradeDataOptions lazy_options, in_memory_options;
+  lazy_options.lazy_open = true;
+  lazy_options.cache_bytes = 1 << 20;
+  in_memory_options.load_mode = iridium::data::LoadMode::kInMemory;
+  // USD_JPY_D is not stored, the missing dataset only throws once it is read
+  iridium::data::TradeData lazy(kStorageFilePath.u8string(), *instruments, *freqs, lazy_options);
+  EXPECT_ANY_THROW(lazy.history_window("USD_JPY", 0, 1, iridium::data::DataFreq::d));
+  auto m1 = iridium::data::data_freq_list({"M1"});
+  iridium::data::TradeData in_memory(kStorageFilePath.u8string(), *instruments, *m1, in_memory_options);
+  H5::H5File file(kStorageFilePath.u8string(), H5F_ACC_RDONLY);
+  auto columns = iridium::data::ReadColumns(
+      file.openDataSet(iridium::data::instrument_dataset_path("EUR_USD_M1")));
+  // windows within one chunk and spanning several chunks
+  for (auto row : {std::size_t(5000), std::size_t(9000), columns->size() - 1}) {
+    for (int count : {100, 5000}) {
+      auto end = columns->times[row];
+      auto expected = in_memory.history_window("EUR_USD", end, count, iridium::data::DataFreq::m1);
+      auto actual = lazy.history_window("EUR_USD", end, count, iridium::data::DataFreq::m1);
+      ASSERT_EQ(expected.size(), actual.size());
+      for (std::size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(expected[i].time, actual[i].time);
+        EXPECT_EQ(expected[i].close, actual[i].close);
+      }
+    }
+  }
+}
+
+TEST(CandleRecorderTest, AppendsAndWarmStarts) {
+  auto directory = kStorageDir / "recorder";
+  std::filesystem::remove_all(directory);
+  auto columns = SampleColumns(static_cast<int>(iridium::data::kCandleFileMinCapacity) + 500);
+  auto candlesticks = columns.view();
+  iridium::data::DataList first, second;
+  for (std::size_t i = 0; i < 1000; ++i) first.push_back(columns.candlestick(i));
+  // overlaps the first batch and grows past the initial capacity
+  for (std::size_t i = 900; i < columns.size(); ++i) second.push_back(columns.candlestick(i));
+  {
+    iridium::data::CandleRecorder recorder(directory.u8string(), iridium::data::DataFreq::m1);
+    EXPECT_FALSE(recorder.last_time("EUR_USD").has_value());
+    EXPECT_EQ(recorder.Record("EUR_USD", first), 1000);
+    EXPECT_EQ(recorder.Record("EUR_USD", first), 0);
+    EXPECT_EQ(recorder.Record("EUR_USD", second), columns.size() - 1000);
+  }
+  // a restarted recorder picks up where the last one stopped
+  iridium::data::CandleRecorder recorder(directory.u8string(), iridium::data::DataFreq::m1);
+  EXPECT_EQ(recorder.last_time("EUR_USD"), candlesticks.times[columns.size() - 1]);
+  auto tail = recorder.tail("EUR_USD", 90);
+  ASSERT_EQ(tail->size(), 90);
+  EXPECT_EQ(tail->front().time, candlesticks.times[columns.size() - 90]);
+  EXPECT_EQ(tail->back().volume, columns.volumes.back());
+
+  auto instruments = iridium::instrument_list({"EUR_USD"});
+  auto freqs = iridium::data::data_freq_list({"M1"});
+  iridium::data::TradeData trade_data(directory.u8string(), *instruments, *freqs);
+  auto window = trade_data.history_window("EUR_USD", columns.times.back(), 600, iridium::data::DataFreq::m1);
+  ASSERT_EQ(window.size(), 600);
+  for (std::size_t i = 0; i < window.size(); ++i) {
+    EXPECT_EQ(window[i].time, columns.times[columns.size() - 600 + i]);
+  }
+}
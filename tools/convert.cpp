@@ -0,0 +1,62 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <iridium/data.hpp>
+#include <iridium/storage.hpp>
+#include <iridium/hdf5_store.hpp>
+#include <iridium/logging.hpp>
+
+/*
+ * Convert /instruments/<instrument>_<freq> datasets of an HDF5 history file
+ * into native <instrument>_<freq>.candles files
+ *
+ * usage: iridium-convert <history.h5> <output directory> [<instrument>_<freq> ...]
+ */
+int main(int argc, char *argv[]) {
+  auto logger = iridium::logger();
+  if (argc < 3) {
+    logger->error("usage: iridium-convert <history.h5> <output directory> [<instrument>_<freq> ...]");
+    return 1;
+  }
+  auto output_dir = boost::filesystem::path(argv[2]);
+  boost::filesystem::create_directories(output_dir);
+  try {
+    H5::H5File file(argv[1], H5F_ACC_RDONLY);
+    std::vector<std::string> dataset_names(argv + 3, argv + argc);
+    if (dataset_names.empty()) {
+      dataset_names = iridium::data::ListCandleDataSets(file);
+    }
+    for (const auto &name : dataset_names) {
+      auto split = iridium::data::SplitDataSetName(name);
+      if (!split) {
+        logger->error("skip dataset {}, expected <instrument>_<freq>", name);
+        continue;
+      }
+      const auto &[instrument_name, freq] = *split;
+      auto dataset = file.openDataSet(iridium::data::instrument_dataset_path(name));
+      auto columns = iridium::data::ReadColumns(dataset);
+      auto path = output_dir / iridium::data::candle_file_name(instrument_name, freq);
+      iridium::data::WriteCandleFile(path.string(), instrument_name, freq, *columns);
+      logger->info("converted {} - rows: {}, file: {}", name, columns->size(), path.string());
+    }
+  } catch (const H5::Exception &err) {
+    logger->error(err.getDetailMsg());
+    return 1;
+  } catch (const std::exception &err) {
+    logger->error(err.what());
+    return 1;
+  }
+  return 0;
+}
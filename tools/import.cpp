@@ -0,0 +1,153 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <iridium/data.hpp>
+#include <iridium/csv_import.hpp>
+#include <iridium/storage.hpp>
+#include <iridium/hdf5_store.hpp>
+#include <iridium/logging.hpp>
+
+/*
+ * Import candle CSV dumps into an HDF5 history file, or into native candle files if the output
+ * is not a .h5 file. Each file is parsed on every core, several files of one dataset are
+ * concatenated in order. Rows must ascend strictly unless --sort is given, which sorts them and
+ * keeps the last row of a time. Gaps are reported, not rejected.
+ *
+ * usage: iridium-import [--sort] [--threads=<n>] [--delimiter=<c>] [--columns=<time,open,high,low,close,volume>]
+ *                       <history.h5 | output directory> <instrument>_<freq>=<file.csv>[,<file.csv> ...] ...
+ * --columns gives the 0-based column of each field, e.g., 0,1,3,4,2,5 for time,open,close,high,low,volume
+ * dumps and 0,1,2,3,4,- for dumps without volumes
+ */
+int main(int argc, char *argv[]) {
+  using iridium::data::StringToDataFreq;
+  auto logger = iridium::logger();
+  const std::string usage = "usage: iridium-import [--sort] [--threads=<n>] [--delimiter=<c>] "
+                            "[--columns=<time,open,high,low,close,volume>] "
+                            "<history.h5 | output directory> <instrument>_<freq>=<file.csv>[,<file.csv> ...] ...";
+  bool sort = false;
+  std::size_t threads = 0;
+  iridium::data::CsvFormat format;
+  std::vector<std::string> args;
+  try {
+    for (int i = 1; i < argc; ++i) {
+      std::string arg(argv[i]);
+      if (arg == "--sort") {
+        sort = true;
+      } else if (boost::starts_with(arg, "--threads=")) {
+        threads = std::stoul(arg.substr(10));
+      } else if (boost::starts_with(arg, "--delimiter=") && arg.size() == 13) {
+        format.delimiter = arg[12] == 't' ? '\t' : arg[12];
+      } else if (boost::starts_with(arg, "--columns=")) {
+        std::vector<std::string> columns;
+        boost::split(columns, arg.substr(10), boost::is_any_of(","));
+        if (columns.size() != 6) throw std::invalid_argument("expected 6 columns: " + arg);
+        auto column = [](const std::string &value) {
+          return value == "-" ? iridium::data::kNoCsvColumn : std::stoul(value);
+        };
+        format.time_column = column(columns[0]);
+        format.open_column = column(columns[1]);
+        format.high_column = column(columns[2]);
+        format.low_column = column(columns[3]);
+        format.close_column = column(columns[4]);
+        format.volume_column = column(columns[5]);
+      } else if (boost::starts_with(arg, "--")) {
+        throw std::invalid_argument("unknown option " + arg);
+      } else {
+        args.push_back(arg);
+      }
+    }
+  } catch (const std::exception &err) {
+    logger->error(err.what());
+    logger->error(usage);
+    return 1;
+  }
+  if (args.size() < 2) {
+    logger->error(usage);
+    return 1;
+  }
+  auto output = boost::filesystem::path(args[0]);
+  auto native = output.extension() != ".h5";
+  try {
+    std::unique_ptr<H5::H5File> file;
+    if (native) {
+      boost::filesystem::create_directories(output);
+    } else {
+      file = std::make_unique<H5::H5File>(
+          output.string(), boost::filesystem::exists(output) ? H5F_ACC_RDWR : H5F_ACC_TRUNC);
+    }
+    for (auto arg = args.begin() + 1; arg != args.end(); ++arg) {
+      auto start = std::chrono::steady_clock::now();
+      auto eq = arg->find('=');
+      auto name = arg->substr(0, eq);
+      auto sep = name.rfind('_');
+      if (eq == std::string::npos || sep == std::string::npos) {
+        logger->error("skip {}, expected <instrument>_<freq>=<file.csv>", *arg);
+        continue;
+      }
+      auto instrument_name = name.substr(0, sep);
+      auto freq = StringToDataFreq(name.substr(sep + 1));
+      std::vector<std::string> paths;
+      boost::split(paths, arg->substr(eq + 1), boost::is_any_of(","));
+      iridium::data::CandleColumns columns;
+      for (const auto &path : paths) {
+        auto part = iridium::data::ReadCandleCsv(path, format, threads);
+        if (columns.size() == 0) {
+          columns = std::move(*part);
+          continue;
+        }
+        columns.reserve(columns.size() + part->size());
+        for (std::size_t i = 0; i < part->size(); ++i) {
+          columns.push_back(part->candlestick(i));
+        }
+      }
+      auto validation = iridium::data::ValidateCandles(columns, freq);
+      if (!validation.ordered()) {
+        if (!sort) {
+          logger->error("{} - {} rows out of order, {} duplicate times, rerun with --sort",
+                        name, validation.out_of_order, validation.duplicates);
+          return 1;
+        }
+        auto rows = columns.size();
+        iridium::data::SortCandles(columns);
+        logger->warn("{} - sorted {} rows out of order, dropped {} rows of duplicate times",
+                     name, validation.out_of_order, rows - columns.size());
+        validation = iridium::data::ValidateCandles(columns, freq);
+      }
+      if (validation.off_grid > 0) {
+        logger->warn("{} - {} rows off the {} grid", name, validation.off_grid, name.substr(sep + 1));
+      }
+      if (native) {
+        auto path = output / iridium::data::candle_file_name(instrument_name, freq);
+        iridium::data::WriteCandleFile(path.string(), instrument_name, freq, columns);
+      } else {
+        iridium::data::WriteCandles(*file, name, columns);
+      }
+      auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      logger->info("imported {} - rows: {}, gaps: {}, longer than 4 days: {}, longest: {}s, {:.1f}s",
+                   name, columns.size(), validation.gaps, validation.long_gaps, validation.longest_gap, seconds);
+    }
+  } catch (const H5::Exception &err) {
+    logger->error(err.getDetailMsg());
+    return 1;
+  } catch (const std::exception &err) {
+    logger->error(err.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,89 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <iridium/data.hpp>
+#include <iridium/hdf5_store.hpp>
+#include <iridium/logging.hpp>
+#include <iridium/partition_store.hpp>
+
+/*
+ * Split /instruments/<instrument>_<freq> datasets of an HDF5 history file into one file per UTC year
+ * under a partitioned history directory and update its manifest.csv. Years that already have a partition
+ * are merged, so appending a new export rewrites only the partitions of the years it covers.
+ *
+ * usage: iridium-partition [--chunk-rows=<n>] [--deflate=<0-9>] <history.h5> <directory> [<instrument>_<freq> ...]
+ */
+int main(int argc, char *argv[]) {
+  auto logger = iridium::logger();
+  const std::string usage = "usage: iridium-partition [--chunk-rows=<n>] [--deflate=<0-9>] "
+                            "<history.h5> <directory> [<instrument>_<freq> ...]";
+  iridium::data::ChunkLayout layout;
+  std::vector<std::string> args;
+  try {
+    for (int i = 1; i < argc; ++i) {
+      std::string arg(argv[i]);
+      if (boost::starts_with(arg, "--chunk-rows=")) {
+        layout.chunk_rows = std::stoul(arg.substr(13));
+      } else if (boost::starts_with(arg, "--deflate=")) {
+        layout.deflate_level = std::stoi(arg.substr(10));
+      } else if (boost::starts_with(arg, "--")) {
+        throw std::invalid_argument("unknown option " + arg);
+      } else {
+        args.push_back(arg);
+      }
+    }
+  } catch (const std::exception &err) {
+    logger->error(err.what());
+    logger->error(usage);
+    return 1;
+  }
+  if (args.size() < 2) {
+    logger->error(usage);
+    return 1;
+  }
+  try {
+    boost::filesystem::create_directories(args[1]);
+    iridium::data::PartitionManifest manifest(args[1]);
+    H5::H5File file(args[0], H5F_ACC_RDONLY);
+    std::vector<std::string> dataset_names(args.begin() + 2, args.end());
+    if (dataset_names.empty()) {
+      dataset_names = iridium::data::ListCandleDataSets(file);
+    }
+    for (const auto &name : dataset_names) {
+      auto split = iridium::data::SplitDataSetName(name);
+      if (!split) {
+        logger->error("skip dataset {}, expected <instrument>_<freq>", name);
+        continue;
+      }
+      auto start = std::chrono::steady_clock::now();
+      const auto &[instrument_name, freq] = *split;
+      auto columns = iridium::data::ReadColumns(file.openDataSet(iridium::data::instrument_dataset_path(name)));
+      iridium::data::WritePartitions(manifest, instrument_name, freq, *columns, layout);
+      auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      logger->info("partitioned {} - rows: {}, partitions: {}, {:.1f}s",
+                   name, columns->size(), manifest.partitions(instrument_name, freq).size(), seconds);
+    }
+  } catch (const H5::Exception &err) {
+    logger->error(err.getDetailMsg());
+    return 1;
+  } catch (const std::exception &err) {
+    logger->error(err.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,81 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <boost/algorithm/string.hpp>
+#include <iridium/data.hpp>
+#include <iridium/hdf5_store.hpp>
+#include <iridium/logging.hpp>
+
+/*
+ * Rewrite every /instruments and /quotes dataset of an HDF5 history file into a new file with
+ * chunks of --chunk-rows rows, kChunkRows by default, shuffled and deflated at --deflate, 4 by default.
+ * Candlestick datasets of the new file are read chunk by chunk without HDF5 type conversion.
+ *
+ * usage: iridium-repack [--chunk-rows=<n>] [--deflate=<0-9>] [--no-shuffle] <history.h5> <repacked.h5>
+ */
+int main(int argc, char *argv[]) {
+  auto logger = iridium::logger();
+  const std::string usage = "usage: iridium-repack [--chunk-rows=<n>] [--deflate=<0-9>] [--no-shuffle] "
+                            "<history.h5> <repacked.h5>";
+  iridium::data::ChunkLayout layout;
+  std::vector<std::string> args;
+  try {
+    for (int i = 1; i < argc; ++i) {
+      std::string arg(argv[i]);
+      if (boost::starts_with(arg, "--chunk-rows=")) {
+        layout.chunk_rows = std::stoul(arg.substr(13));
+      } else if (boost::starts_with(arg, "--deflate=")) {
+        layout.deflate_level = std::stoi(arg.substr(10));
+      } else if (arg == "--no-shuffle") {
+        layout.shuffle = false;
+      } else if (boost::starts_with(arg, "--")) {
+        throw std::invalid_argument("unknown option " + arg);
+      } else {
+        args.push_back(arg);
+      }
+    }
+  } catch (const std::exception &err) {
+    logger->error(err.what());
+    logger->error(usage);
+    return 1;
+  }
+  if (args.size() != 2 || args[0] == args[1]) {
+    logger->error(usage);
+    return 1;
+  }
+  try {
+    H5::H5File source(args[0], H5F_ACC_RDONLY);
+    H5::H5File target(args[1], H5F_ACC_TRUNC);
+    for (const auto &name : iridium::data::ListCandleDataSets(source)) {
+      auto start = std::chrono::steady_clock::now();
+      auto columns = iridium::data::ReadColumns(source.openDataSet(iridium::data::instrument_dataset_path(name)));
+      iridium::data::WriteCandles(target, name, *columns, layout);
+      auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      logger->info("repacked {} - rows: {}, {:.1f}s", name, columns->size(), seconds);
+    }
+    for (const auto &name : iridium::data::ListQuoteDataSets(source)) {
+      auto quotes = iridium::data::ReadQuotes(source.openDataSet(iridium::data::quote_dataset_path(name)));
+      iridium::data::WriteQuotes(target, name, quotes.first, quotes.second, layout);
+      logger->info("repacked quotes {} - rows: {}", name, quotes.first.size());
+    }
+  } catch (const H5::Exception &err) {
+    logger->error(err.getDetailMsg());
+    return 1;
+  } catch (const std::exception &err) {
+    logger->error(err.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,72 @@
+/* Copyright 2020 Iridium. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <csignal>
+#include <string>
+#include <vector>
+#include <iridium/data.hpp>
+#include <iridium/hdf5_store.hpp>
+#include <iridium/shm_store.hpp>
+#include <iridium/logging.hpp>
+
+/*
+ * Publish /instruments/<instrument>_<freq> datasets of an HDF5 history file into POSIX shared
+ * memory and keep them there until interrupted. Backtests attach to them with
+ * StorageBackend::kSharedMemory and the same prefix.
+ *
+ * usage: iridium-shm-server <history.h5> <prefix> [<instrument>_<freq> ...]
+ */
+int main(int argc, char *argv[]) {
+  auto logger = iridium::logger();
+  if (argc < 3) {
+    logger->error("usage: iridium-shm-server <history.h5> <prefix> [<instrument>_<freq> ...]");
+    return 1;
+  }
+  // block the stop signals before any thread starts, they are waited for below
+  sigset_t stop_signals;
+  sigemptyset(&stop_signals);
+  sigaddset(&stop_signals, SIGINT);
+  sigaddset(&stop_signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
+
+  iridium::data::ShmPublisher publisher(argv[2]);
+  try {
+    H5::H5File file(argv[1], H5F_ACC_RDONLY);
+    std::vector<std::string> dataset_names(argv + 3, argv + argc);
+    if (dataset_names.empty()) {
+      dataset_names = iridium::data::ListCandleDataSets(file);
+    }
+    for (const auto &name : dataset_names) {
+      auto split = iridium::data::SplitDataSetName(name);
+      if (!split) {
+        logger->error("skip dataset {}, expected <instrument>_<freq>", name);
+        continue;
+      }
+      const auto &[instrument_name, freq] = *split;
+      auto columns = iridium::data::ReadColumns(file.openDataSet(iridium::data::instrument_dataset_path(name)));
+      publisher.Publish(instrument_name, freq, *columns);
+      logger->info("published {} - rows: {}, segment: {}",
+                   name, columns->size(), iridium::data::shm_segment_name(argv[2], instrument_name, freq));
+    }
+  } catch (const H5::Exception &err) {
+    logger->error(err.getDetailMsg());
+    return 1;
+  } catch (const std::exception &err) {
+    logger->error(err.what());
+    return 1;
+  }
+  logger->info("serving {} segments, interrupt to unpublish", publisher.segments().size());
+  int signal = 0;
+  sigwait(&stop_signals, &signal);
+  logger->info("unpublishing {} segments", publisher.segments().size());
+  return 0;
+}